@@ -0,0 +1,219 @@
+#pragma once
+
+#include <cstdio>
+#include <cstdint>
+#include <cstdlib>
+
+#include <chrono>
+#include <utility>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+/**
+ * Minimal benchmark harness: runs a function until a minimum time has
+ * passed and reports the time per iteration and per processed item.
+ *
+ * On Linux, hardware counters (cycles, instructions, L1 data and last level
+ * cache misses, branch misses) are read with `perf_event_open' over the
+ * same runs and reported per item. Counters the kernel or the machine does
+ * not provide are left out; set CMDLINE_BENCH_NO_COUNTERS to skip them.
+ */
+namespace bench {
+
+template<typename T>
+inline void do_not_optimize(const T &value) {
+  asm volatile("" : : "r,m"(value) : "memory");
+}
+
+/**
+ * Per-process hardware counters, each opened on its own so an unsupported
+ * one does not disable the others. Counts are scaled if the kernel had to
+ * multiplex the counters.
+ */
+class Counters {
+public:
+  enum Event {
+    cycles,
+    instructions,
+    l1d_misses,
+    llc_misses,
+    branch_misses,
+    event_count
+  };
+
+  static constexpr const char *NAMES[event_count] = {
+    "cycles", "instr", "L1d-miss", "LLC-miss", "br-miss"
+  };
+
+  Counters() {
+#ifdef __linux__
+    if (std::getenv("CMDLINE_BENCH_NO_COUNTERS") != nullptr) {
+      return;
+    }
+    constexpr std::uint64_t L1D_READ_MISS = PERF_COUNT_HW_CACHE_L1D
+      | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+    const std::uint32_t types[event_count] = {
+      PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HW_CACHE, PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE
+    };
+    const std::uint64_t configs[event_count] = {
+      PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS, L1D_READ_MISS,
+      PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES
+    };
+    for (int e = 0; e < event_count; ++e) {
+      perf_event_attr attr {};
+      attr.size = sizeof(attr);
+      attr.type = types[e];
+      attr.config = configs[e];
+      attr.disabled = 1;
+      attr.exclude_kernel = 1;
+      attr.exclude_hv = 1;
+      attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+      m_fds[e] = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+    }
+#endif
+  }
+
+  ~Counters() {
+#ifdef __linux__
+    for (int fd : m_fds) {
+      if (fd >= 0) {
+        close(fd);
+      }
+    }
+#endif
+  }
+
+  Counters(const Counters &) = delete;
+  Counters & operator=(const Counters &) = delete;
+
+  bool available(int e) const { return m_fds[e] >= 0; }
+
+  /**
+   * @brief True the first time it is called, for notes printed only once.
+   */
+  bool first_note() {
+    return !std::exchange(m_noted, true);
+  }
+
+  bool any_available() const {
+    for (int e = 0; e < event_count; ++e) {
+      if (this->available(e)) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  void start() {
+#ifdef __linux__
+    for (int fd : m_fds) {
+      if (fd >= 0) {
+        ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+        ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+      }
+    }
+#endif
+  }
+
+  void stop() {
+#ifdef __linux__
+    for (int fd : m_fds) {
+      if (fd >= 0) {
+        ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+      }
+    }
+#endif
+  }
+
+  /**
+   * @brief The count since `start', or -1 if the counter is not available
+   * or never got scheduled.
+   */
+  double value(int e) const {
+#ifdef __linux__
+    std::uint64_t data[3];  // value, time enabled, time running
+    if (m_fds[e] < 0 or ::read(m_fds[e], data, sizeof(data)) != sizeof(data) or data[2] == 0) {
+      return -1.0;
+    }
+    return static_cast<double>(data[0]) * static_cast<double>(data[1]) / static_cast<double>(data[2]);
+#else
+    (void)e;
+    return -1.0;
+#endif
+  }
+
+private:
+  int m_fds[event_count] = { -1, -1, -1, -1, -1 };
+  bool m_noted = false;
+};
+
+inline Counters & counters() {
+  static Counters c;
+  return c;
+}
+
+struct Result {
+  std::uint64_t iterations;
+  double ns_per_iteration;
+  double ns_per_item;
+  double counters_per_item[Counters::event_count]; //< -1 if not available
+};
+
+constexpr std::chrono::milliseconds MIN_TIME { 200 };
+
+template<typename F>
+Result run(const char *name, std::size_t items_per_iteration, F &&f) {
+  using Clock = std::chrono::steady_clock;
+  Counters &counters = bench::counters();
+  f();  // warm up
+  std::uint64_t iterations = 0;
+  std::uint64_t batch = 1;
+  counters.start();
+  const auto start = Clock::now();
+  Clock::duration elapsed;
+  do {
+    for (std::uint64_t i = 0; i < batch; ++i) {
+      f();
+    }
+    iterations += batch;
+    batch *= 2;
+    elapsed = Clock::now() - start;
+  } while (elapsed < MIN_TIME);
+  counters.stop();
+
+  Result r;
+  r.iterations = iterations;
+  r.ns_per_iteration = std::chrono::duration<double, std::nano>(elapsed).count() / iterations;
+  const double items = static_cast<double>(iterations) * (items_per_iteration ? items_per_iteration : 1);
+  r.ns_per_item = r.ns_per_iteration / (items_per_iteration ? items_per_iteration : 1);
+  std::printf("%-44s %14.1f ns/iter %10.2f ns/item %14.0f items/s\n",
+    name, r.ns_per_iteration, r.ns_per_item, 1e9 / r.ns_per_item);
+
+  bool any = false;
+  for (int e = 0; e < Counters::event_count; ++e) {
+    const double count = counters.value(e);
+    r.counters_per_item[e] = count < 0 ? -1.0 : count / items;
+    if (count < 0) {
+      continue;
+    }
+    std::printf("%s %s %.2f", any ? "" : "    per item:", Counters::NAMES[e], r.counters_per_item[e]);
+    any = true;
+  }
+  if (r.counters_per_item[Counters::cycles] > 0 and r.counters_per_item[Counters::instructions] >= 0) {
+    std::printf(" IPC %.2f", r.counters_per_item[Counters::instructions] / r.counters_per_item[Counters::cycles]);
+  }
+  if (any) {
+    std::printf("\n");
+  }
+  else if (counters.first_note()) {
+    std::printf("    hardware counters unavailable\n");
+  }
+  return r;
+}
+
+}
@@ -0,0 +1,105 @@
+#include "benchmark.h"
+#include "cmdline.h"
+
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace {
+
+// What parsing does per token without the classification pass
+std::size_t scalar_scan(const std::vector<const char *> &argv) {
+  std::size_t sum = 0;
+  for (const char *s : argv) {
+    const std::size_t length = std::strlen(s);
+    const void *eq = std::memchr(s, '=', length);
+    sum += length + (eq != nullptr) + (s[0] == '-') + (s[0] == '-' and s[1] == '-');
+  }
+  return sum;
+}
+
+}
+
+int main() {
+  constexpr std::size_t N_TOKENS = 1'000'000;
+  std::vector<std::string> tokens;
+  tokens.reserve(N_TOKENS);
+  while (tokens.size() < N_TOKENS) {
+    const std::string i = std::to_string(tokens.size());
+    tokens.push_back("--number=" + i);
+    tokens.push_back("-s");
+    tokens.push_back("/srv/data/input/archive-" + i + ".tar.gz");
+    tokens.push_back("--output-directory=/var/cache/build/output/" + i);
+    tokens.push_back("-v");
+    tokens.push_back("file" + i);
+  }
+  std::vector<const char *> argv { "program_name" };
+  for (const std::string &t : tokens) {
+    argv.push_back(t.c_str());
+  }
+
+  std::vector<cmdline::TokenClass> classes(argv.size());
+  bench::run("classify_tokens, 1M tokens", argv.size(), [&] {
+    cmdline::classify_tokens(argv.data(), argv.size(), classes.data());
+    bench::do_not_optimize(classes.data());
+  });
+  bench::run("strlen + memchr, 1M tokens", argv.size(), [&] {
+    bench::do_not_optimize(scalar_scan(argv));
+  });
+
+  cmdline::ArgumentParser p;
+  p.error_messages = false;
+  std::vector<int> numbers;
+  std::vector<std::string_view> names;
+  std::vector<std::string_view> outputs;
+  bool verbose = false;
+  std::vector<const char *> files;
+  p.add_option(numbers, "", 'n', "number");
+  p.add_option(names, "", 's', "name");
+  p.add_option(outputs, "", 0, "output-directory");
+  p.add_option(verbose, "", 'v', "verbose");
+  p.add_argument(files, "files");
+  auto parse = [&] {
+    numbers.clear();
+    names.clear();
+    outputs.clear();
+    files.clear();
+    p.string_arena().clear();
+    bench::do_not_optimize(p.parse_args(static_cast<int>(argv.size()), argv.data(), false));
+  };
+
+  p.classify_min_tokens = cmdline::Limits::unlimited;
+  bench::run("parse_args, 1M tokens", argv.size(), parse);
+  p.classify_min_tokens = 0;
+  bench::run("parse_args, 1M tokens, classified", argv.size(), parse);
+
+  // Without conversions, leaving mostly the per-token scanning
+  std::vector<std::string> flag_tokens;
+  flag_tokens.reserve(N_TOKENS);
+  while (flag_tokens.size() < N_TOKENS) {
+    const std::string i = std::to_string(flag_tokens.size());
+    flag_tokens.push_back("--output-directory=/var/cache/build/output/" + i);
+    flag_tokens.push_back("-v");
+    flag_tokens.push_back("/srv/data/input/archive-" + i + ".tar.gz");
+  }
+  std::vector<const char *> flag_argv { "program_name" };
+  for (const std::string &t : flag_tokens) {
+    flag_argv.push_back(t.c_str());
+  }
+  cmdline::ArgumentParser q;
+  q.error_messages = false;
+  std::string_view output;
+  std::vector<const char *> inputs;
+  q.add_option(output, "", 0, "output-directory");
+  q.add_option(verbose, "", 'v', "verbose");
+  q.add_argument(inputs, "inputs");
+  auto parse_flags = [&] {
+    inputs.clear();
+    bench::do_not_optimize(q.parse_args(static_cast<int>(flag_argv.size()), flag_argv.data(), false));
+  };
+  q.classify_min_tokens = cmdline::Limits::unlimited;
+  bench::run("parse_args, 1M tokens, no conversions", flag_argv.size(), parse_flags);
+  q.classify_min_tokens = 0;
+  bench::run("parse_args, 1M tokens, no conversions, classified", flag_argv.size(), parse_flags);
+}
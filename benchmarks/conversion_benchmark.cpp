@@ -0,0 +1,96 @@
+#include "benchmark.h"
+#include "cmdline.h"
+
+#include <string>
+#include <sstream>
+#include <vector>
+
+namespace {
+
+const char *const SIZES[] = { "4GiB", "512", "1.5MiB", "64k", "10MB", "3TiB", "128KiB", "7G" };
+constexpr std::size_t N_SIZES = sizeof(SIZES) / sizeof(*SIZES);
+
+// What tools did before: read the option as a string and pick it apart with
+// a stringstream.
+bool parse_size_stringstream(const std::string &str, std::uint64_t &out) {
+  std::istringstream ss(str);
+  double number;
+  std::string suffix;
+  if (!(ss >> number)) {
+    return false;
+  }
+  ss >> suffix;
+  double mult = 1;
+  if (suffix.empty() or suffix == "B") mult = 1;
+  else if (suffix == "k" or suffix == "kB" or suffix == "K") mult = 1e3;
+  else if (suffix == "M" or suffix == "MB") mult = 1e6;
+  else if (suffix == "G" or suffix == "GB") mult = 1e9;
+  else if (suffix == "T" or suffix == "TB") mult = 1e12;
+  else if (suffix == "KiB") mult = 1024.0;
+  else if (suffix == "MiB") mult = 1024.0 * 1024;
+  else if (suffix == "GiB") mult = 1024.0 * 1024 * 1024;
+  else if (suffix == "TiB") mult = 1024.0 * 1024 * 1024 * 1024;
+  else return false;
+  out = static_cast<std::uint64_t>(number * mult);
+  return true;
+}
+
+}
+
+int main() {
+  bench::run("parse_value(Bytes)", N_SIZES, [] {
+    for (const char *s : SIZES) {
+      cmdline::Bytes b;
+      bench::do_not_optimize(cmdline::parse_value(s, b));
+      bench::do_not_optimize(b);
+    }
+  });
+
+  bench::run("stringstream size parser", N_SIZES, [] {
+    for (const char *s : SIZES) {
+      std::uint64_t b;
+      bench::do_not_optimize(parse_size_stringstream(s, b));
+      bench::do_not_optimize(b);
+    }
+  });
+
+  bench::run("parse_value(milliseconds)", N_SIZES, [] {
+    static const char *const durations[] = { "250ms", "1.5s", "2h", "10us", "3d", "1000ns", "5m", "42" };
+    for (const char *s : durations) {
+      std::chrono::milliseconds d;
+      bench::do_not_optimize(cmdline::parse_value(s, d));
+      bench::do_not_optimize(d);
+    }
+  });
+
+  // Whole parser, 1000 occurrences of --size
+  constexpr std::size_t N_ARGS = 1000;
+  std::vector<const char *> argv { "bench" };
+  for (std::size_t i = 0; i < N_ARGS; ++i) {
+    argv.push_back("--size");
+    argv.push_back(SIZES[i % N_SIZES]);
+  }
+  const int argc = static_cast<int>(argv.size());
+
+  bench::run("parse_args vector<Bytes>", N_ARGS, [&] {
+    cmdline::ArgumentParser p;
+    std::vector<cmdline::Bytes> sizes;
+    sizes.reserve(N_ARGS);
+    p.add_option(sizes, "", 's', "size");
+    bench::do_not_optimize(p.parse_args(argc, argv.data(), false));
+    bench::do_not_optimize(sizes.data());
+  });
+
+  bench::run("parse_args vector<string> + stringstream", N_ARGS, [&] {
+    cmdline::ArgumentParser p;
+    std::vector<std::string> strings;
+    strings.reserve(N_ARGS);
+    p.add_option(strings, "", 's', "size");
+    bench::do_not_optimize(p.parse_args(argc, argv.data(), false));
+    std::vector<std::uint64_t> sizes(strings.size());
+    for (std::size_t i = 0; i < strings.size(); ++i) {
+      parse_size_stringstream(strings[i], sizes[i]);
+    }
+    bench::do_not_optimize(sizes.data());
+  });
+}
@@ -0,0 +1,76 @@
+#include "benchmark.h"
+#include "cmdline.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+int main() {
+  constexpr std::size_t N_EACH = 25;
+  cmdline::ArgumentParser p;
+  std::vector<int> numbers(N_EACH);
+  std::vector<double> ratios(N_EACH);
+  std::vector<std::string> names(N_EACH);
+  std::vector<std::vector<int>> lists(N_EACH);
+  std::vector<std::string> long_names;
+  for (std::size_t i = 0; i < N_EACH; ++i) {
+    for (const char *kind : { "number", "ratio", "name", "list" }) {
+      long_names.push_back(std::string(kind) + "-" + std::to_string(i));
+    }
+  }
+  std::vector<std::string> tokens;
+  for (std::size_t i = 0; i < N_EACH; ++i) {
+    p.add_option(numbers[i], "", 0, long_names[4 * i].c_str());
+    p.add_option(ratios[i], "", 0, long_names[4 * i + 1].c_str());
+    p.add_option(names[i], "", 0, long_names[4 * i + 2].c_str());
+    p.add_option(lists[i], "", 0, long_names[4 * i + 3].c_str());
+    tokens.push_back("--" + long_names[4 * i] + "=" + std::to_string(i * 1000));
+    tokens.push_back("--" + long_names[4 * i + 1] + "=0." + std::to_string(i));
+    tokens.push_back("--" + long_names[4 * i + 2] + "=/var/lib/service/" + std::to_string(i));
+    for (int k = 0; k < 4; ++k) {
+      tokens.push_back("--" + long_names[4 * i + 3] + "=" + std::to_string(k));
+    }
+  }
+  std::vector<const char *> argv { "bench" };
+  for (const std::string &t : tokens) {
+    argv.push_back(t.c_str());
+  }
+  p.parse_args(static_cast<int>(argv.size()), argv.data(), false);
+
+  std::vector<char> buffer(1 << 16);
+  std::printf("JSON: %zu bytes, binary: %zu bytes\n",
+    p.dump_config(buffer.data(), buffer.size(), cmdline::DumpFormat::json),
+    p.dump_config(buffer.data(), buffer.size(), cmdline::DumpFormat::binary));
+
+  bench::run("dump_config JSON, 100 options", 1, [&] {
+    bench::do_not_optimize(p.dump_config(buffer.data(), buffer.size(), cmdline::DumpFormat::json));
+  });
+  bench::run("dump_config binary, 100 options", 1, [&] {
+    bench::do_not_optimize(p.dump_config(buffer.data(), buffer.size(), cmdline::DumpFormat::binary));
+  });
+
+  const int null = ::open("/dev/null", O_WRONLY | O_CLOEXEC);
+  bench::run("write_config JSON to /dev/null, 100 options", 1, [&] {
+    bench::do_not_optimize(p.write_config(null, cmdline::DumpFormat::json));
+  });
+  ::close(null);
+
+  // What tools did before: print each variable by hand
+  bench::run("hand-written ostringstream, 100 options", 1, [&] {
+    std::ostringstream ss;
+    for (std::size_t i = 0; i < N_EACH; ++i) {
+      ss << long_names[4 * i] << '=' << numbers[i] << '\n';
+      ss << long_names[4 * i + 1] << '=' << ratios[i] << '\n';
+      ss << long_names[4 * i + 2] << '=' << names[i] << '\n';
+      ss << long_names[4 * i + 3] << '=';
+      for (int v : lists[i]) {
+        ss << v << ',';
+      }
+      ss << '\n';
+    }
+    bench::do_not_optimize(ss.str().size());
+  });
+}
@@ -0,0 +1,111 @@
+#include "benchmark.h"
+#include "getopt_compat.h"
+
+#include <getopt.h>
+
+#include <string>
+#include <vector>
+
+namespace {
+
+int g_brief = 0;
+
+const struct option LONG_OPTIONS[] = {
+  { "verbose", no_argument, nullptr, 'v' },
+  { "output", required_argument, nullptr, 'o' },
+  { "color", optional_argument, nullptr, 'c' },
+  { "jobs", required_argument, nullptr, 'j' },
+  { "directory", required_argument, nullptr, 'C' },
+  { "keep-going", no_argument, nullptr, 'k' },
+  { "brief", no_argument, &g_brief, 1 },
+  { "level", required_argument, nullptr, 1000 },
+  { "define", required_argument, nullptr, 'D' },
+  { "include", required_argument, nullptr, 'I' },
+  { nullptr, 0, nullptr, 0 },
+};
+const char OPTSTRING[] = "vo:c::j:C:kD:I:";
+
+// What a tool's option loop does with each option
+std::size_t consume(int c, const char *arg) {
+  return static_cast<std::size_t>(c) + (arg ? static_cast<std::size_t>(arg[0]) : 0);
+}
+
+std::size_t run_glibc(std::vector<char *> &argv, const std::vector<char *> &original) {
+  argv = original;
+  optind = 0;
+  opterr = 0;
+  std::size_t sum = 0;
+  int c;
+  while ((c = getopt_long(static_cast<int>(argv.size()), argv.data(), OPTSTRING, LONG_OPTIONS, nullptr)) != -1) {
+    sum += consume(c, optarg);
+  }
+  return sum + static_cast<std::size_t>(optind);
+}
+
+std::size_t run_cmdline(cmdline::Getopt &g, std::vector<char *> &argv, const std::vector<char *> &original) {
+  argv = original;
+  std::size_t sum = static_cast<std::size_t>(g.parse(static_cast<int>(argv.size()), argv.data()));
+  int c;
+  while ((c = g.next()) != -1) {
+    sum += consume(c, g.optarg());
+  }
+  return sum;
+}
+
+void compare(const char *name, const std::vector<std::string> &tokens) {
+  std::vector<char *> original { const_cast<char *>("program_name") };
+  for (const std::string &t : tokens) {
+    original.push_back(const_cast<char *>(t.c_str()));
+  }
+  std::vector<char *> argv;
+  cmdline::Getopt g(OPTSTRING, LONG_OPTIONS);
+  g.parser().error_messages = false;
+  if (run_glibc(argv, original) != run_cmdline(g, argv, original)) {
+    std::printf("%s: results differ\n", name);
+    std::exit(1);
+  }
+  const std::string prefix(name);
+  bench::run((prefix + ", getopt_long").c_str(), tokens.size(), [&] {
+    bench::do_not_optimize(run_glibc(argv, original));
+  });
+  bench::run((prefix + ", Getopt").c_str(), tokens.size(), [&] {
+    bench::do_not_optimize(run_cmdline(g, argv, original));
+  });
+  bench::run((prefix + ", Getopt with setup").c_str(), tokens.size(), [&] {
+    cmdline::Getopt fresh(OPTSTRING, LONG_OPTIONS);
+    fresh.parser().error_messages = false;
+    bench::do_not_optimize(run_cmdline(fresh, argv, original));
+  });
+}
+
+}
+
+int main() {
+  // A typical invocation
+  compare("12 tokens", {
+    "-v", "--jobs=8", "-C", "/src/project", "--keep-going", "-DNDEBUG", "-I", "include",
+    "--color=always", "-o", "out.bin", "main.c",
+  });
+
+  // Only options, mostly long ones
+  std::vector<std::string> options;
+  for (int i = 0; options.size() < 1000; ++i) {
+    options.push_back("--define=NAME" + std::to_string(i));
+    options.push_back("--include");
+    options.push_back("/usr/include/dir" + std::to_string(i));
+    options.push_back("--brief");
+    options.push_back("-vk");
+  }
+  compare("1000 options", options);
+
+  // Options and operands interleaved, so both have to permute
+  std::vector<std::string> mixed;
+  for (int i = 0; mixed.size() < 1000; ++i) {
+    mixed.push_back("file" + std::to_string(i) + ".c");
+    mixed.push_back("-I/usr/include/dir" + std::to_string(i));
+    mixed.push_back("--level=" + std::to_string(i));
+    mixed.push_back("object" + std::to_string(i) + ".o");
+    mixed.push_back("-v");
+  }
+  compare("1000 interleaved", mixed);
+}
@@ -0,0 +1,99 @@
+#include "benchmark.h"
+#include "cmdline.h"
+
+#include <malloc.h>
+
+#include <array>
+#include <optional>
+#include <string>
+#include <vector>
+
+// Bytes allocated by malloc and not freed
+std::size_t heap() {
+  const struct mallinfo2 info = mallinfo2();
+  return info.uordblks + info.hblkhd;
+}
+
+int main() {
+  constexpr std::size_t N_OPTIONS = 10'000;
+  const char *subjects[] = { "connections", "retries", "worker threads", "cached entries", "open files" };
+  const char *actions[] = { "Sets the maximum number of", "Limits the", "Overrides the default count of" };
+  std::vector<std::string> names, help;
+  for (std::size_t i = 0; i < N_OPTIONS; ++i) {
+    names.push_back("option-" + std::to_string(i));
+    help.push_back(std::string(actions[i % 3]) + ' ' + subjects[i % 5] + " used by subsystem "
+                   + std::to_string(i / 16) + ", 0 for no limit");
+  }
+  std::vector<int> values(N_OPTIONS);
+
+  // Help text and argument names on their own, as the options kept them
+  // before and as they are kept now
+  std::size_t before = heap();
+  {
+    std::vector<std::array<std::string, 2>> strings(N_OPTIONS);
+    for (std::size_t i = 0; i < N_OPTIONS; ++i) {
+      strings[i] = { help[i], cmdline::detail::get_argument_name(0, names[i].c_str()) };
+    }
+    std::printf("%-44s %10zu bytes\n", "help as std::string per option", heap() - before);
+  }
+  for (int mode = 0; mode < 3; ++mode) {
+    const char *label[] = { "help in HelpStore", "help in HelpStore, compressed", "static help, names in HelpStore" };
+    before = heap();
+    cmdline::detail::HelpStore store;
+    std::vector<std::array<cmdline::detail::HelpText, 2>> texts(N_OPTIONS);
+    for (std::size_t i = 0; i < N_OPTIONS; ++i) {
+      texts[i] = {
+        mode == 2 ? cmdline::detail::HelpText { help[i].c_str(), 0, static_cast<std::uint32_t>(help[i].size()) }
+                  : store.add(help[i], mode == 1),
+        store.add(cmdline::detail::get_argument_name(0, names[i].c_str()), mode == 1),
+      };
+    }
+    std::printf("%-44s %10zu bytes\n", label[mode], heap() - before);
+  }
+
+  for (int mode = 0; mode < 3; ++mode) {
+    const char *label[] = { "parser", "parser, compress_help", "parser, static_help" };
+    before = heap();
+    {
+      cmdline::ArgumentParser p;
+      p.compress_help = mode == 1;
+      p.static_help = mode == 2;
+      for (std::size_t i = 0; i < N_OPTIONS; ++i) {
+        p.add_option(values[i], help[i].c_str(), 0, names[i].c_str());
+      }
+      std::printf("%-44s %10zu bytes\n", label[mode], heap() - before);
+    }
+  }
+  // A typical small program, where the store should not cost a full block
+  before = heap();
+  {
+    cmdline::ArgumentParser p;
+    for (std::size_t i = 0; i < 3; ++i) {
+      p.add_option(values[i], help[i].c_str(), 0, names[i].c_str());
+    }
+    std::printf("%-44s %10zu bytes\n", "parser, 3 options", heap() - before);
+  }
+
+  for (int mode = 0; mode < 3; ++mode) {
+    const char *label[][2] = {
+      { "add_option, 10k options", "usage, 10k options" },
+      { "add_option, 10k options, compress_help", "usage, 10k options, compress_help" },
+      { "add_option, 10k options, static_help", "usage, 10k options, static_help" },
+    };
+    // Includes destroying the previous parser
+    std::optional<cmdline::ArgumentParser> p;
+    bench::run(label[mode][0], N_OPTIONS, [&] {
+      p.emplace();
+      p->compress_help = mode == 1;
+      p->static_help = mode == 2;
+      for (std::size_t i = 0; i < N_OPTIONS; ++i) {
+        p->add_option(values[i], help[i].c_str(), 0, names[i].c_str());
+      }
+    });
+    FILE *null = std::fopen("/dev/null", "w");
+    bench::run(label[mode][1], N_OPTIONS, [&] {
+      p->usage(null, "program_name");
+    });
+    std::fclose(null);
+  }
+}
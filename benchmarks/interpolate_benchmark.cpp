@@ -0,0 +1,41 @@
+#include "benchmark.h"
+#include "cmdline.h"
+
+#include <cstdlib>
+
+#include <string>
+#include <vector>
+
+int main() {
+  constexpr std::size_t N_VALUES = 2000;
+  ::setenv("CMDLINE_BENCH_SCRATCH", "/scratch/user", 1);
+  std::vector<std::string> plain, variables;
+  for (std::size_t i = 0; i < N_VALUES; ++i) {
+    plain.push_back("--path=/data/run" + std::to_string(i) + "/output");
+    variables.push_back("--path=${CMDLINE_BENCH_SCRATCH}/run" + std::to_string(i) + "/output");
+  }
+  auto make_argv = [](const std::vector<std::string> &tokens) {
+    std::vector<const char *> argv { "bench" };
+    for (const std::string &t : tokens) {
+      argv.push_back(t.c_str());
+    }
+    return argv;
+  };
+  std::vector<const char *> plain_argv = make_argv(plain);
+  std::vector<const char *> variables_argv = make_argv(variables);
+
+  auto run = [&](const char *name, bool interpolate, std::vector<const char *> &argv) {
+    bench::run(name, N_VALUES, [&] {
+      cmdline::ArgumentParser p;
+      p.interpolate_values = interpolate;
+      std::vector<const char *> paths;
+      paths.reserve(N_VALUES);
+      p.add_option(paths, "", 'p', "path");
+      bench::do_not_optimize(p.parse_args(static_cast<int>(argv.size()), argv.data(), false));
+      bench::do_not_optimize(paths.data());
+    });
+  };
+  run("2000 values, interpolation off", false, plain_argv);
+  run("2000 values without variables, interpolation on", true, plain_argv);
+  run("2000 values with ${VAR}, interpolation on", true, variables_argv);
+}
@@ -0,0 +1,63 @@
+#include "benchmark.h"
+#include "cmdline.h"
+
+#include <string>
+#include <vector>
+
+int main() {
+  constexpr std::size_t N_ARGS = 1000;
+  std::vector<std::string> tokens;
+  for (std::size_t i = 0; i < N_ARGS; ++i) {
+    tokens.push_back("--ratio=" + std::to_string(i) + ".125");
+    tokens.push_back("--size=" + std::to_string(i) + "KiB");
+  }
+  std::vector<const char *> argv { "bench" };
+  for (const std::string &t : tokens) {
+    argv.push_back(t.c_str());
+  }
+  const int argc = static_cast<int>(argv.size());
+
+  bench::run("eager double + Bytes, 2000 values", 2 * N_ARGS, [&] {
+    cmdline::ArgumentParser p;
+    std::vector<double> ratios;
+    std::vector<cmdline::Bytes> sizes;
+    ratios.reserve(N_ARGS);
+    sizes.reserve(N_ARGS);
+    p.add_option(ratios, "", 'r', "ratio");
+    p.add_option(sizes, "", 's', "size");
+    bench::do_not_optimize(p.parse_args(argc, argv.data(), false));
+    bench::do_not_optimize(ratios.data());
+  });
+
+  for (const std::size_t read : { std::size_t(0), std::size_t(10), N_ARGS }) {
+    char name[64];
+    std::snprintf(name, sizeof(name), "Lazy double + Bytes, 2000 values, %zu read", 2 * read);
+    bench::run(name, 2 * N_ARGS, [&] {
+      cmdline::ArgumentParser p;
+      std::vector<cmdline::Lazy<double>> ratios;
+      std::vector<cmdline::Lazy<cmdline::Bytes>> sizes;
+      ratios.reserve(N_ARGS);
+      sizes.reserve(N_ARGS);
+      p.add_option(ratios, "", 'r', "ratio");
+      p.add_option(sizes, "", 's', "size");
+      bench::do_not_optimize(p.parse_args(argc, argv.data(), false));
+      for (std::size_t i = 0; i < read; ++i) {
+        bench::do_not_optimize(*ratios[i]);
+        bench::do_not_optimize(*sizes[i]);
+      }
+    });
+  }
+
+  bench::run("Lazy, convert_lazy_values, 2000 values", 2 * N_ARGS, [&] {
+    cmdline::ArgumentParser p;
+    p.convert_lazy_values = true;
+    std::vector<cmdline::Lazy<double>> ratios;
+    std::vector<cmdline::Lazy<cmdline::Bytes>> sizes;
+    ratios.reserve(N_ARGS);
+    sizes.reserve(N_ARGS);
+    p.add_option(ratios, "", 'r', "ratio");
+    p.add_option(sizes, "", 's', "size");
+    bench::do_not_optimize(p.parse_args(argc, argv.data(), false));
+    bench::do_not_optimize(ratios.data());
+  });
+}
@@ -0,0 +1,75 @@
+#include "benchmark.h"
+#include "cmdline.h"
+
+#include <unistd.h>
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+int main() {
+  constexpr std::size_t N_FILES = 200;
+  constexpr std::size_t CONFIG_SIZE = 64 * 1024;
+  const fs::path dir = fs::temp_directory_path() / ("cmdline_parse_cache_benchmark_" + std::to_string(::getpid()));
+  fs::create_directories(dir);
+  const std::string config = (dir / "config").string();
+  std::ofstream(config) << std::string(CONFIG_SIZE, 'x');
+
+  std::vector<std::string> tokens;
+  for (std::size_t i = 0; i < N_FILES; ++i) {
+    tokens.push_back("-f");
+    tokens.push_back((dir / ("input" + std::to_string(i))).string());
+    std::ofstream(tokens.back()) << i;
+    tokens.push_back("--number=" + std::to_string(i));
+    tokens.push_back("-s" + std::to_string(i) + "KiB");
+  }
+  tokens.push_back("--name=benchmark");
+  std::vector<const char *> argv { "program_name" };
+  for (const std::string &t : tokens) {
+    argv.push_back(t.c_str());
+  }
+  const int argc = static_cast<int>(argv.size());
+
+  cmdline::ArgumentParser p;
+  p.error_messages = false;
+  std::vector<int> numbers;
+  std::vector<cmdline::Bytes> sizes;
+  std::string name;
+  std::vector<std::string> files;
+  p.add_option(numbers, "", 'n', "number");
+  p.add_option(sizes, "", 's', "size");
+  p.add_option(name, "", 0, "name");
+  p.add_option(files, "", 'f', "file");
+  p.add_validator('f', cmdline::validators::exists());
+  p.add_validator('f', cmdline::validators::readable());
+  auto clear = [&] {
+    numbers.clear();
+    sizes.clear();
+    files.clear();
+  };
+
+  bench::run("parse_args, 200 files", 1, [&] {
+    clear();
+    bench::do_not_optimize(p.parse_args(argc, argv.data(), false));
+  });
+
+  cmdline::ParseCache cache((dir / "cache").string());
+  cache.add_environment("HOME");
+  cache.add_environment("LANG");
+  cache.add_file(config.c_str());
+  bench::run("ParseCache miss, 200 files, 64KiB config", 1, [&] {
+    clear();
+    fs::remove_all(dir / "cache");
+    bench::do_not_optimize(cache.parse_args(p, argc, argv.data(), false));
+  });
+  bench::run("ParseCache hit, 200 files, 64KiB config", 1, [&] {
+    clear();
+    bench::do_not_optimize(cache.parse_args(p, argc, argv.data(), false));
+  });
+  std::printf("last run was a %s\n", cache.hit() ? "hit" : "miss");
+
+  fs::remove_all(dir);
+}
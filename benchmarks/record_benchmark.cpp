@@ -0,0 +1,93 @@
+#include "benchmark.h"
+#include "cmdline.h"
+
+#include <string>
+#include <vector>
+
+namespace {
+
+struct Job {
+  bool verbose = false;
+  int threads = 1;
+  double ratio = 0.0;
+  cmdline::Bytes memory;
+  std::string name;
+  std::vector<std::string> tags;
+  std::string input;
+};
+
+}
+
+int main() {
+  constexpr std::size_t N_RECORDS = 10'000;
+  std::vector<std::string> tokens;
+  std::vector<std::size_t> starts;
+  for (std::size_t i = 0; i < N_RECORDS; ++i) {
+    const std::string n = std::to_string(i);
+    starts.push_back(tokens.size());
+    tokens.push_back("-j" + std::to_string(i % 64));
+    tokens.push_back("--ratio=0." + n);
+    tokens.push_back("--memory=" + n + "MiB");
+    tokens.push_back("--name=job" + n);
+    tokens.push_back("-t");
+    tokens.push_back("batch");
+    if (i % 2) {
+      tokens.push_back("-v");
+    }
+    tokens.push_back("input" + n);
+  }
+  starts.push_back(tokens.size());
+  std::vector<std::vector<const char *>> lines(N_RECORDS);
+  for (std::size_t i = 0; i < N_RECORDS; ++i) {
+    lines[i].push_back("program_name");
+    for (std::size_t k = starts[i]; k < starts[i + 1]; ++k) {
+      lines[i].push_back(tokens[k].c_str());
+    }
+  }
+
+  bench::run("parser per record, 10k records", N_RECORDS, [&] {
+    std::vector<Job> jobs(N_RECORDS);
+    for (std::size_t i = 0; i < N_RECORDS; ++i) {
+      Job &job = jobs[i];
+      cmdline::ArgumentParser p;
+      p.error_messages = false;
+      p.add_option(job.verbose, "", 'v', "verbose");
+      p.add_option(job.threads, "", 'j', "threads");
+      p.add_option(job.ratio, "", 0, "ratio");
+      p.add_option(job.memory, "", 0, "memory");
+      p.add_option(job.name, "", 0, "name");
+      p.add_option(job.tags, "", 't', "tag");
+      p.add_argument(job.input, "", "input");
+      bench::do_not_optimize(p.parse_args(static_cast<int>(lines[i].size()), lines[i].data(), false));
+    }
+    bench::do_not_optimize(jobs.data());
+  });
+
+  cmdline::RecordParser<Job> p;
+  p.error_messages = false;
+  p.add_option(&Job::verbose, "", 'v', "verbose");
+  p.add_option(&Job::threads, "", 'j', "threads");
+  p.add_option(&Job::ratio, "", 0, "ratio");
+  p.add_option(&Job::memory, "", 0, "memory");
+  p.add_option(&Job::name, "", 0, "name");
+  p.add_option(&Job::tags, "", 't', "tag");
+  p.add_argument(&Job::input, "", "input");
+  bench::run("RecordParser::parse_batch, 10k records", N_RECORDS, [&] {
+    std::vector<Job> jobs;
+    jobs.reserve(N_RECORDS);
+    bench::do_not_optimize(p.parse_batch(lines, jobs));
+    bench::do_not_optimize(jobs.data());
+  });
+
+  // Saving and dumping resolve each field of the selected record
+  Job job;
+  p.parse_args(job, static_cast<int>(lines[1].size()), lines[1].data(), false);
+  std::vector<char> blob;
+  bench::run("RecordParser::save_result, 7 fields", 1, [&] {
+    bench::do_not_optimize(p.save_result(blob));
+  });
+  std::vector<char> dump(4096);
+  bench::run("RecordParser::dump_config JSON, 7 fields", 1, [&] {
+    bench::do_not_optimize(p.dump_config(dump.data(), dump.size(), cmdline::DumpFormat::json));
+  });
+}
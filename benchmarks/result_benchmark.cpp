@@ -0,0 +1,62 @@
+#include "benchmark.h"
+#include "cmdline.h"
+
+#include <string>
+#include <vector>
+
+int main() {
+  constexpr std::size_t N_TOKENS = 600;
+  cmdline::ArgumentParser p;
+  p.error_messages = false;
+  std::vector<int> numbers;
+  std::vector<double> ratios;
+  std::vector<cmdline::Bytes> sizes;
+  bool verbose = false;
+  std::vector<const char *> files;
+  p.add_option(numbers, "", 'n', "number");
+  p.add_option(ratios, "", 'r', "ratio");
+  p.add_option(sizes, "", 's', "size");
+  p.add_option(verbose, "", 'v', "verbose");
+  p.add_argument(files, "files");
+
+  std::vector<std::string> tokens;
+  while (tokens.size() < N_TOKENS) {
+    const std::string i = std::to_string(tokens.size());
+    tokens.push_back("--number=" + i);
+    tokens.push_back("--ratio=0." + i);
+    tokens.push_back("-s" + i + "KiB");
+    tokens.push_back("-v");
+    tokens.push_back("file" + i);
+  }
+  std::vector<const char *> argv { "program_name" };
+  for (const std::string &t : tokens) {
+    argv.push_back(t.c_str());
+  }
+  auto clear = [&] {
+    numbers.clear();
+    ratios.clear();
+    sizes.clear();
+    files.clear();
+  };
+
+  bench::run("parse_args, 600 tokens", 1, [&] {
+    clear();
+    bench::do_not_optimize(p.parse_args(static_cast<int>(argv.size()), argv.data(), false));
+  });
+
+  std::vector<char> blob;
+  bench::run("save_result, 600 tokens", 1, [&] {
+    bench::do_not_optimize(p.save_result(blob));
+  });
+  std::printf("result size: %zu bytes\n", blob.size());
+
+  bench::run("load_result, 600 tokens", 1, [&] {
+    clear();
+    bench::do_not_optimize(p.load_result(blob.data(), blob.size()));
+  });
+
+  std::vector<std::string> canonical;
+  bench::run("canonical_args, 600 tokens", 1, [&] {
+    bench::do_not_optimize(p.canonical_args(canonical));
+  });
+}
@@ -0,0 +1,70 @@
+#include "benchmark.h"
+#include "cmdline.h"
+
+#include <string>
+#include <vector>
+
+int main() {
+  constexpr std::size_t N_TOKENS = 600;
+  cmdline::ArgumentParser p;
+  p.error_messages = false;
+  std::vector<int> numbers;
+  std::vector<std::string> names;
+  std::vector<double> ratios;
+  bool verbose = false;
+  std::vector<const char *> files;
+  p.add_option(numbers, "", 'n', "number");
+  p.add_option(names, "", 's', "name");
+  p.add_option(ratios, "", 'r', "ratio");
+  p.add_option(verbose, "", 'v', "verbose");
+  p.add_argument(files, "files");
+
+  std::vector<std::string> tokens;
+  while (tokens.size() < N_TOKENS) {
+    const std::string i = std::to_string(tokens.size());
+    tokens.push_back("--number=" + i);
+    tokens.push_back("-s");
+    tokens.push_back("name" + i);
+    tokens.push_back("--ratio=0." + i);
+    tokens.push_back("-v");
+    tokens.push_back("file" + i);
+  }
+  std::vector<const char *> argv { "program_name" };
+  for (const std::string &t : tokens) {
+    argv.push_back(t.c_str());
+  }
+
+  bench::run("parse_args, 600 tokens", 1, [&] {
+    numbers.clear();
+    names.clear();
+    ratios.clear();
+    files.clear();
+    bench::do_not_optimize(p.parse_args(static_cast<int>(argv.size()), argv.data(), false));
+  });
+
+  cmdline::ParseSession session(p, "program_name");
+  bench::run("ParseSession::assign, 600 tokens", 1, [&] {
+    session.assign(argv.size() - 1, argv.data() + 1);
+    bench::do_not_optimize(session.valid());
+  });
+
+  // A keystroke in the middle of the line, alternating between a valid and
+  // an invalid value so every edit changes the result
+  session.assign(argv.size() - 1, argv.data() + 1);
+  const std::size_t middle = N_TOKENS / 2;
+  const char *const edits[] = { "--number=12", "--number=12x" };
+  std::size_t n = 0;
+  bench::run("ParseSession::edit, 1 of 600 tokens", 1, [&] {
+    session.edit(middle, 1, &edits[n++ % 2], 1);
+    bench::do_not_optimize(session.valid());
+  });
+  std::printf("tokens parsed again per edit: %zu\n", session.reparsed());
+
+  // Inserting a positional argument shifts the ones after it, but they all
+  // go to the catch-all argument so the parse still catches up
+  bench::run("ParseSession::edit, insert and remove", 2, [&] {
+    session.edit(middle, 0, { "inserted" });
+    session.edit(middle, 1, {});
+    bench::do_not_optimize(session.valid());
+  });
+}
@@ -0,0 +1,51 @@
+#include "benchmark.h"
+#include "cmdline.h"
+
+#include <unistd.h>
+
+#include <deque>
+#include <string>
+#include <vector>
+
+int main() {
+  constexpr std::size_t N_OPTIONS = 20000;
+  std::vector<cmdline::SpecSchemaOption> schema;
+  std::deque<std::string> names;
+  for (std::size_t i = 0; i < N_OPTIONS; ++i) {
+    cmdline::SpecSchemaOption &opt = schema.emplace_back();
+    opt.long_name = "option-" + std::to_string(i);
+    opt.argument_name = "VALUE";
+    opt.help = "Help text of option " + std::to_string(i);
+    opt.nargs = 1;
+    names.push_back(opt.long_name);
+  }
+  std::vector<char> image;
+  cmdline::build_spec_image(schema, image);
+  const std::string path = "/tmp/cmdline_spec_benchmark." + std::to_string(getpid());
+  std::FILE *file = std::fopen(path.c_str(), "wb");
+  std::fwrite(image.data(), 1, image.size(), file);
+  std::fclose(file);
+  std::printf("image size: %zu bytes\n", image.size());
+
+  const char *argv[] = { "program_name", "--option-17=1", "--option-19999", "2" };
+  std::vector<int> values(N_OPTIONS);
+
+  bench::run("add_option, 20000 options", N_OPTIONS, [&] {
+    cmdline::ArgumentParser p;
+    for (std::size_t i = 0; i < N_OPTIONS; ++i) {
+      p.add_option(values[i], "Help text", 0, names[i].c_str());
+    }
+    bench::do_not_optimize(p.parse_args(4, argv, false));
+  });
+
+  bench::run("SpecImage::map, 20000 options", N_OPTIONS, [&] {
+    cmdline::SpecImage spec;
+    spec.map(path.c_str());
+    cmdline::ArgumentParser p;
+    p.use_spec(&spec);
+    p.bind("option-17", values[17]);
+    bench::do_not_optimize(p.parse_args(4, argv, false));
+  });
+
+  std::remove(path.c_str());
+}
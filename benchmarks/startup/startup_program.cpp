@@ -0,0 +1,39 @@
+/*
+ * Program timed by startup_benchmark: declares a large option set, parses
+ * its arguments and exits. It is built against the shared library, the
+ * static library and in header-only mode; built with STARTUP_NO_PARSER it
+ * only exits, for the cost of starting a process.
+ */
+#ifndef STARTUP_NO_PARSER
+#include "cmdline.h"
+
+#include <array>
+#include <string>
+#include <vector>
+
+constexpr std::size_t N_OPTIONS = 500;
+#endif
+
+int main(int argc, const char **argv) {
+#ifdef STARTUP_NO_PARSER
+  (void)argc;
+  (void)argv;
+  return 0;
+#else
+  cmdline::ArgumentParser p;
+  std::vector<std::string> names;
+  names.reserve(N_OPTIONS);
+  for (std::size_t i = 0; i < N_OPTIONS; ++i) {
+    names.push_back("option-number-" + std::to_string(i));
+  }
+  std::array<int, N_OPTIONS> values {};
+  bool verbose = false;
+  std::vector<const char *> files;
+  p.add_option(verbose, "Print more", 'v', "verbose");
+  for (std::size_t i = 0; i < N_OPTIONS; ++i) {
+    p.add_option(values[i], "An option of the large spec", 0, names[i].c_str());
+  }
+  p.add_argument(files, "files");
+  return p.parse_args(argc, argv, false) ? 0 : 1;
+#endif
+}
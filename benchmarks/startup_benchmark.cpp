@@ -0,0 +1,44 @@
+#include "benchmark.h"
+
+#include <spawn.h>
+#include <sys/wait.h>
+
+extern char **environ;
+
+namespace {
+
+bool run_program(const char *path) {
+  char *argv[] = {
+    const_cast<char *>(path), const_cast<char *>("-v"), const_cast<char *>("--option-number-17=5"),
+    const_cast<char *>("--option-number-499"), const_cast<char *>("12"), const_cast<char *>("input.txt"), nullptr
+  };
+  pid_t pid;
+  if (posix_spawn(&pid, path, nullptr, nullptr, argv, environ) != 0) {
+    return false;
+  }
+  int status;
+  return waitpid(pid, &status, 0) == pid and WIFEXITED(status) and WEXITSTATUS(status) == 0;
+}
+
+}
+
+int main() {
+  const struct {
+    const char *name;
+    const char *path;
+  } programs[] = {
+    { "exec to exit, no parser", STARTUP_BASELINE },
+    { "exec to parsed, shared library", STARTUP_SHARED },
+    { "exec to parsed, static library", STARTUP_STATIC },
+    { "exec to parsed, header-only", STARTUP_HEADER_ONLY },
+  };
+  for (const auto &program : programs) {
+    if (!run_program(program.path)) {
+      std::printf("%s: could not run %s\n", program.name, program.path);
+      return 1;
+    }
+    bench::run(program.name, 1, [&] {
+      bench::do_not_optimize(run_program(program.path));
+    });
+  }
+}
@@ -0,0 +1,96 @@
+#include "benchmark.h"
+#include "cmdline.h"
+
+#include <cstdlib>
+#include <new>
+#include <string>
+#include <vector>
+
+namespace {
+
+std::size_t g_allocations = 0;
+std::size_t g_allocated_bytes = 0;
+
+}
+
+void * operator new(std::size_t size) {
+  ++g_allocations;
+  g_allocated_bytes += size;
+  if (void *p = std::malloc(size ? size : 1)) {
+    return p;
+  }
+  throw std::bad_alloc();
+}
+
+void operator delete(void *p) noexcept {
+  std::free(p);
+}
+
+void operator delete(void *p, std::size_t) noexcept {
+  std::free(p);
+}
+
+int main() {
+  constexpr std::size_t N_VALUES = 10000;
+  // Paths long enough not to fit the small string buffer, 500 distinct ones
+  std::vector<std::string> tokens;
+  for (std::size_t i = 0; i < N_VALUES; ++i) {
+    tokens.push_back("--path=/srv/data/shard-" + std::to_string(i % 500) + "/index");
+  }
+  std::vector<const char *> argv { "program_name" };
+  for (const std::string &t : tokens) {
+    argv.push_back(t.c_str());
+  }
+  const int argc = static_cast<int>(argv.size());
+
+  auto report = [](const char *name, std::size_t allocations, std::size_t bytes) {
+    std::printf("%-44s %10zu allocations %10zu bytes\n", name, allocations, bytes);
+  };
+
+  {
+    cmdline::ArgumentParser p;
+    std::vector<std::string> paths;
+    p.add_option(paths, "", 0, "path");
+    paths.reserve(N_VALUES);
+    g_allocations = g_allocated_bytes = 0;
+    p.parse_args(argc, argv.data(), false);
+    report("std::vector<std::string>, one parse", g_allocations, g_allocated_bytes);
+    bench::run("std::vector<std::string>, 10000 values", N_VALUES, [&] {
+      paths.clear();
+      bench::do_not_optimize(p.parse_args(argc, argv.data(), false));
+    });
+  }
+
+  {
+    cmdline::ArgumentParser p;
+    std::vector<std::string_view> paths;
+    p.add_option(paths, "", 0, "path");
+    paths.reserve(N_VALUES);
+    g_allocations = g_allocated_bytes = 0;
+    p.parse_args(argc, argv.data(), false);
+    report("std::vector<std::string_view>, one parse", g_allocations, g_allocated_bytes);
+    bench::run("std::vector<std::string_view>, 10000 values", N_VALUES, [&] {
+      paths.clear();
+      p.string_arena().clear();
+      bench::do_not_optimize(p.parse_args(argc, argv.data(), false));
+    });
+  }
+
+  {
+    cmdline::ArgumentParser p;
+    p.string_arena().set_interning(true);
+    std::vector<std::string_view> paths;
+    p.add_option(paths, "", 0, "path");
+    paths.reserve(N_VALUES);
+    g_allocations = g_allocated_bytes = 0;
+    p.parse_args(argc, argv.data(), false);
+    report("interned std::string_view, one parse", g_allocations, g_allocated_bytes);
+    std::printf("arena: %zu bytes used, %zu reserved\n",
+      p.string_arena().bytes_used(), p.string_arena().bytes_reserved());
+    bench::run("interned std::string_view, 10000 values", N_VALUES, [&] {
+      paths.clear();
+      p.string_arena().clear();
+      bench::do_not_optimize(p.parse_args(argc, argv.data(), false));
+    });
+  }
+}
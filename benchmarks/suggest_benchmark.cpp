@@ -0,0 +1,51 @@
+#include "benchmark.h"
+#include "cmdline.h"
+
+#include <deque>
+#include <random>
+#include <string>
+
+int main() {
+  constexpr std::size_t N_OPTIONS = 10'000;
+  static const char *const words[] = {
+    "cache", "size", "max", "min", "log", "level", "output", "input", "thread",
+    "count", "enable", "disable", "timeout", "retry", "path", "file", "dir",
+    "verbose", "format", "buffer", "queue", "depth", "limit", "rate",
+  };
+  constexpr std::size_t N_WORDS = sizeof(words) / sizeof(*words);
+
+  std::mt19937 rng(1);
+  std::deque<std::string> names;
+  cmdline::ArgumentParser p;
+  bool flag;
+  while (names.size() < N_OPTIONS) {
+    std::string name = words[rng() % N_WORDS];
+    name += '-';
+    name += words[rng() % N_WORDS];
+    name += '-';
+    name += std::to_string(names.size());
+    p.add_option(flag, "", 0, name.c_str());
+    names.push_back(std::move(name));
+  }
+
+  std::vector<std::string> queries;
+  for (std::size_t i = 0; i < 64; ++i) {
+    std::string q = names[rng() % names.size()];
+    const std::size_t pos = rng() % q.size();
+    switch (i % 3) {
+    case 0: q.erase(pos, 1); break;
+    case 1: q.insert(pos, 1, 'x'); break;
+    case 2: std::swap(q[pos], q[(pos + 1) % q.size()]); break;
+    }
+    queries.push_back(q);
+  }
+
+  p.suggest("warm-up");
+  std::size_t qi = 0;
+  bench::run("suggest, 10k long options", 1, [&] {
+    bench::do_not_optimize(p.suggest(queries[qi++ % queries.size()]));
+  });
+  bench::run("suggest, 10k long options, no match", 1, [&] {
+    bench::do_not_optimize(p.suggest("zzzzzzzzzzzzzzzz"));
+  });
+}
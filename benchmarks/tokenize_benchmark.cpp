@@ -0,0 +1,126 @@
+#include "benchmark.h"
+#include "cmdline.h"
+
+#include <cstdlib>
+#include <new>
+#include <string>
+#include <vector>
+
+namespace {
+
+std::size_t g_allocations = 0;
+
+// What the command server did before: one std::string per word.
+std::vector<std::string> split_strings(const std::string &command) {
+  std::vector<std::string> words;
+  std::string word;
+  bool in_word = false;
+  char quote = 0;
+  for (std::size_t i = 0; i < command.size(); ++i) {
+    const char ch = command[i];
+    if (quote) {
+      if (ch == quote) {
+        quote = 0;
+      }
+      else if (ch == '\\' and quote == '"' and i + 1 < command.size()) {
+        word += command[++i];
+      }
+      else {
+        word += ch;
+      }
+    }
+    else if (ch == ' ' or ch == '\t' or ch == '\n') {
+      if (in_word) {
+        words.push_back(std::move(word));
+        word.clear();
+        in_word = false;
+      }
+    }
+    else {
+      in_word = true;
+      if (ch == '\'' or ch == '"') {
+        quote = ch;
+      }
+      else if (ch == '\\' and i + 1 < command.size()) {
+        word += command[++i];
+      }
+      else {
+        word += ch;
+      }
+    }
+  }
+  if (in_word) {
+    words.push_back(std::move(word));
+  }
+  return words;
+}
+
+}
+
+void * operator new(std::size_t size) {
+  ++g_allocations;
+  if (void *p = std::malloc(size ? size : 1)) {
+    return p;
+  }
+  throw std::bad_alloc();
+}
+
+void operator delete(void *p) noexcept {
+  std::free(p);
+}
+
+void operator delete(void *p, std::size_t) noexcept {
+  std::free(p);
+}
+
+int main() {
+  static const char *const words[] = {
+    "--output=/var/log/server.log", "-v", "'a quoted argument'", "plain",
+    "\"double \\\"quoted\\\" $HOME\"", "escaped\\ space", "--name='it'\\''s'", "--threads=16",
+  };
+  constexpr std::size_t N_WORDS = 4096;
+  std::string command;
+  for (std::size_t i = 0; i < N_WORDS; ++i) {
+    command += words[i % (sizeof(words) / sizeof(*words))];
+    command += ' ';
+  }
+
+  std::vector<char> buffer(command.size() + 1);
+  std::vector<const char *> tokens(N_WORDS + 1);
+  auto tokenize = [&] {
+    std::memcpy(buffer.data(), command.c_str(), command.size() + 1);
+    return cmdline::tokenize(buffer.data(), tokens.data(), tokens.size());
+  };
+
+  const std::size_t before = g_allocations;
+  const cmdline::TokenizeResult r = tokenize();
+  std::printf("tokenize: %zu words, %zu allocations\n", r.count, g_allocations - before);
+  if (!r or r.count != N_WORDS) {
+    return 1;
+  }
+
+  bench::run("tokenize, 4096 words", N_WORDS, [&] {
+    bench::do_not_optimize(tokenize());
+  });
+  bench::run("std::string per word, 4096 words", N_WORDS, [&] {
+    bench::do_not_optimize(split_strings(command));
+  });
+
+  cmdline::ArgumentParser p;
+  p.error_messages = false;
+  bool verbose = false;
+  std::string output, name;
+  unsigned threads = 0;
+  std::vector<const char *> rest;
+  p.add_option(verbose, "", 'v', "");
+  p.add_option(output, "", 0, "output");
+  p.add_option(name, "", 0, "name");
+  p.add_option(threads, "", 0, "threads");
+  p.add_argument(rest, "rest");
+  std::vector<const char *> arena(N_WORDS + 2);
+  bench::run("parse_command_line, 4096 words", N_WORDS, [&] {
+    rest.clear();
+    std::memcpy(buffer.data(), command.c_str(), command.size() + 1);
+    bench::do_not_optimize(p.parse_command_line("server", buffer.data(), arena.data(), arena.size(), false));
+  });
+}
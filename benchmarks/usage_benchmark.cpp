@@ -0,0 +1,56 @@
+#include "benchmark.h"
+#include "cmdline.h"
+
+#include <unistd.h>
+
+#include <filesystem>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+int main() {
+  constexpr std::size_t N_OPTIONS = 64;
+  const fs::path dir = fs::temp_directory_path() / ("cmdline_usage_benchmark_" + std::to_string(::getpid()));
+
+  cmdline::ArgumentParser p;
+  p.error_messages = false;
+  std::vector<std::string> long_names;
+  std::vector<int> values(N_OPTIONS);
+  for (std::size_t i = 0; i < N_OPTIONS; ++i) {
+    long_names.push_back("option-" + std::to_string(i));
+  }
+  for (std::size_t i = 0; i < N_OPTIONS; ++i) {
+    p.add_option(values[i], "", 0, long_names[i].c_str());
+  }
+  std::vector<std::string> tokens;
+  for (std::size_t i = 0; i < N_OPTIONS; i += 2) {
+    tokens.push_back("--" + long_names[i] + "=" + std::to_string(i));
+  }
+  std::vector<const char *> argv { "program_name" };
+  for (const std::string &t : tokens) {
+    argv.push_back(t.c_str());
+  }
+  const int argc = static_cast<int>(argv.size());
+
+  bench::run("parse_args, 32 of 64 options", 1, [&] {
+    bench::do_not_optimize(p.parse_args(argc, argv.data(), false));
+  });
+
+  cmdline::UsageCounters counters;
+  if (!counters.open(dir.c_str(), p)) {
+    std::fprintf(stderr, "cannot open usage counters in `%s'\n", dir.c_str());
+    return 1;
+  }
+  p.set_usage_counters(&counters);
+  bench::run("parse_args, 32 of 64 options, counting usage", 1, [&] {
+    bench::do_not_optimize(p.parse_args(argc, argv.data(), false));
+  });
+
+  cmdline::UsageReport report;
+  bench::run("read_usage, 64 options", 1, [&] {
+    bench::do_not_optimize(cmdline::read_usage(counters.path().c_str(), report));
+  });
+
+  fs::remove_all(dir);
+}
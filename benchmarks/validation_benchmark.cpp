@@ -0,0 +1,67 @@
+#include "benchmark.h"
+#include "cmdline.h"
+
+#include <unistd.h>
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+int main() {
+  constexpr std::size_t N_PATHS = 50'000;
+  constexpr std::size_t N_FILES = 1'000;
+  const fs::path dir = fs::temp_directory_path() / ("cmdline_validation_benchmark_" + std::to_string(::getpid()));
+  fs::create_directories(dir);
+  std::vector<std::string> paths;
+  paths.reserve(N_PATHS);
+  for (std::size_t i = 0; i < N_PATHS; ++i) {
+    paths.push_back((dir / std::to_string(i % N_FILES)).string());
+    if (i < N_FILES) {
+      std::ofstream(paths.back()) << i;
+    }
+  }
+  std::vector<const char *> argv { "bench" };
+  for (const std::string &s : paths) {
+    argv.push_back("-f");
+    argv.push_back(s.c_str());
+  }
+  const int argc = static_cast<int>(argv.size());
+
+  for (unsigned threads : { 1u, 2u, 4u, 0u }) {
+    char name[64];
+    std::snprintf(name, sizeof(name), "50k paths, exists+readable, threads=%u", threads);
+    bench::run(name, N_PATHS, [&] {
+      cmdline::ArgumentParser p;
+      p.validation_threads = threads;
+      std::vector<std::string> files;
+      files.reserve(N_PATHS);
+      p.add_option(files, "", 'f', "file");
+      p.add_validator('f', cmdline::validators::exists());
+      p.add_validator('f', cmdline::validators::readable());
+      bench::do_not_optimize(p.parse_args(argc, argv.data(), false));
+    });
+  }
+
+  // The smallest command line that is spread across threads, parsed again
+  // and again by one parser as a server would, so starting and joining the
+  // threads is most of the difference
+  std::vector<const char *> small_argv(argv.begin(), argv.begin() + 1 + 2 * 64);
+  for (unsigned threads : { 1u, 4u }) {
+    cmdline::ArgumentParser p;
+    p.validation_threads = threads;
+    std::vector<std::string> files;
+    p.add_option(files, "", 'f', "file");
+    p.add_validator('f', cmdline::validators::exists());
+    char name[64];
+    std::snprintf(name, sizeof(name), "64 paths, reused parser, threads=%u", threads);
+    bench::run(name, 1, [&] {
+      files.clear();
+      bench::do_not_optimize(p.parse_args(static_cast<int>(small_argv.size()), small_argv.data(), false));
+    });
+  }
+
+  fs::remove_all(dir);
+}
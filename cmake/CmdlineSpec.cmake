@@ -0,0 +1,34 @@
+# cmdline_add_spec_image(<target> SCHEMA <schema> OUTPUT <image>)
+#
+# Adds a target compiling an option schema into a spec image with the
+# cmdline_spec tool, to be mapped at run time with `cmdline::SpecImage::map'.
+# A relative OUTPUT is in the current binary directory.
+#
+# The tool is the `cmdline::cmdline_spec' target, which is defined by the
+# cmdline build tree or imported from the installed CmdlineSpecTargets.cmake.
+if(NOT TARGET cmdline::cmdline_spec AND EXISTS ${CMAKE_CURRENT_LIST_DIR}/CmdlineSpecTargets.cmake)
+  include(${CMAKE_CURRENT_LIST_DIR}/CmdlineSpecTargets.cmake)
+endif()
+
+function(cmdline_add_spec_image target)
+  cmake_parse_arguments(ARG "" "SCHEMA;OUTPUT" "" ${ARGN})
+  if(NOT ARG_SCHEMA OR NOT ARG_OUTPUT)
+    message(FATAL_ERROR "cmdline_add_spec_image: SCHEMA and OUTPUT are required")
+  endif()
+  if(NOT TARGET cmdline::cmdline_spec)
+    message(FATAL_ERROR "cmdline_add_spec_image: the cmdline_spec tool is not available")
+  endif()
+  get_filename_component(schema ${ARG_SCHEMA} ABSOLUTE)
+  get_filename_component(output ${ARG_OUTPUT} ABSOLUTE BASE_DIR ${CMAKE_CURRENT_BINARY_DIR})
+  add_custom_command(
+    OUTPUT ${output}
+    COMMAND $<TARGET_FILE:cmdline::cmdline_spec> ${schema} ${output}
+    DEPENDS ${schema} $<TARGET_FILE:cmdline::cmdline_spec>
+    COMMENT "Building spec image ${ARG_OUTPUT}"
+  )
+  add_custom_target(${target} ALL DEPENDS ${output})
+  get_target_property(tool cmdline::cmdline_spec ALIASED_TARGET)
+  if(tool)
+    add_dependencies(${target} ${tool})
+  endif()
+endfunction()
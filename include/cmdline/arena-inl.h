@@ -0,0 +1,122 @@
+/*
+Copyright (c) 2020 Jakob Mohrbacher
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#pragma once
+
+#include "config.h"
+#include "arena.h"
+
+#include <cstring>
+
+#include <algorithm>
+#include <functional>
+
+namespace cmdline {
+
+CMDLINE_INLINE char * StringArena::allocate(std::size_t size) {
+  if (!m_blocks.empty() and m_blocks.back().size - m_block_used >= size) {
+    char *p = m_blocks.back().data.get() + m_block_used;
+    m_block_used += size;
+    return p;
+  }
+  const std::size_t previous = m_blocks.empty() ? 0 : m_blocks.back().size;
+  const std::size_t next = std::clamp(previous * 2, MIN_BLOCK_SIZE, MAX_BLOCK_SIZE);
+  if (size > next / 2) {
+    // Large strings get their own block, placed before the current one so
+    // the space left in it is still used
+    Block block { std::make_unique<char[]>(size), size };
+    char *p = block.data.get();
+    m_blocks.insert(m_blocks.empty() ? m_blocks.end() : m_blocks.end() - 1, std::move(block));
+    if (m_blocks.size() == 1) {
+      m_block_used = size;
+    }
+    return p;
+  }
+  m_blocks.push_back({ std::make_unique<char[]>(next), next });
+  m_block_used = size;
+  return m_blocks.back().data.get();
+}
+
+CMDLINE_INLINE std::string_view * StringArena::find_slot(std::string_view str) {
+  const std::size_t mask = m_table.size() - 1;
+  std::size_t slot = std::hash<std::string_view> {}(str) & mask;
+  while (m_table[slot].data() != nullptr and m_table[slot] != str) {
+    slot = (slot + 1) & mask;
+  }
+  return &m_table[slot];
+}
+
+CMDLINE_INLINE void StringArena::grow_table() {
+  std::vector<std::string_view> old(std::max<std::size_t>(m_table.size() * 2, 64));
+  old.swap(m_table);
+  for (const std::string_view str : old) {
+    if (str.data() != nullptr) {
+      *this->find_slot(str) = str;
+    }
+  }
+}
+
+CMDLINE_INLINE std::string_view StringArena::store(std::string_view str) {
+  std::string_view *slot = nullptr;
+  if (m_interning) {
+    if (2 * (m_interned + 1) > m_table.size()) {
+      this->grow_table();
+    }
+    slot = this->find_slot(str);
+    if (slot->data() != nullptr) {
+      return *slot;
+    }
+  }
+  char *p = this->allocate(str.size() + 1);
+  std::memcpy(p, str.data(), str.size());
+  p[str.size()] = '\0';
+  m_bytes_used += str.size() + 1;
+  const std::string_view stored(p, str.size());
+  if (slot != nullptr) {
+    *slot = stored;
+    ++m_interned;
+  }
+  return stored;
+}
+
+CMDLINE_INLINE void StringArena::set_interning(bool interning) {
+  m_interning = interning;
+}
+
+CMDLINE_INLINE void StringArena::clear() {
+  if (m_blocks.size() > 1) {
+    m_blocks.erase(m_blocks.begin() + 1, m_blocks.end());
+  }
+  m_block_used = 0;
+  m_bytes_used = 0;
+  std::fill(m_table.begin(), m_table.end(), std::string_view {});
+  m_interned = 0;
+}
+
+CMDLINE_INLINE std::size_t StringArena::bytes_reserved() const {
+  std::size_t total = 0;
+  for (const Block &block : m_blocks) {
+    total += block.size;
+  }
+  return total;
+}
+
+}
@@ -0,0 +1,87 @@
+/*
+Copyright (c) 2020 Jakob Mohrbacher
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#pragma once
+
+#include <cstddef>
+
+#include <memory>
+#include <string_view>
+#include <vector>
+
+namespace cmdline {
+
+/**
+ * Stores strings contiguously in large blocks, so converting many string
+ * values costs a few allocations instead of one per value. Stored strings
+ * are NUL terminated and keep their address until `clear'.
+ *
+ * With interning enabled, storing a string equal to one already stored
+ * returns the existing copy.
+ */
+class StringArena {
+  struct Block {
+    std::unique_ptr<char[]> data;
+    std::size_t size;
+  };
+
+  std::vector<Block> m_blocks;   //< the last one is filled
+  std::size_t m_block_used { 0 };
+  std::size_t m_bytes_used { 0 };
+  bool m_interning { false };
+  std::vector<std::string_view> m_table; //< open addressing, empty views are free slots
+  std::size_t m_interned { 0 };
+
+  char * allocate(std::size_t size);
+  std::string_view * find_slot(std::string_view str);
+  void grow_table();
+
+public:
+  static constexpr std::size_t MIN_BLOCK_SIZE = 4096;
+  static constexpr std::size_t MAX_BLOCK_SIZE = 1 << 20;
+
+  StringArena() = default;
+  StringArena(const StringArena &) = delete;
+  StringArena & operator=(const StringArena &) = delete;
+
+  /**
+   * @brief Copies `str' into the arena, or returns the stored copy of an
+   * equal string if interning is enabled.
+   */
+  std::string_view store(std::string_view str);
+
+  /**
+   * @brief Enables or disables interning; only strings stored while it is
+   * enabled are shared.
+   */
+  void set_interning(bool interning);
+  bool interning() const { return m_interning; }
+
+  /**
+   * @brief Releases all strings, keeping the first block for reuse.
+   */
+  void clear();
+
+  std::size_t bytes_used() const { return m_bytes_used; } //< by stored strings, including terminators
+  std::size_t bytes_reserved() const;
+};
+
+}
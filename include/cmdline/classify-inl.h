@@ -0,0 +1,105 @@
+/*
+Copyright (c) 2020 Jakob Mohrbacher
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#pragma once
+
+#include "config.h"
+#include "classify.h"
+
+#include <cstring>
+
+// The vector scan reads whole aligned blocks, which address sanitizer
+// reports when they extend past the end of an allocation
+#if defined(__SSE2__) and !defined(__SANITIZE_ADDRESS__)
+#if defined(__has_feature)
+#if !__has_feature(address_sanitizer)
+#define CMDLINE_CLASSIFY_SSE2
+#endif
+#else
+#define CMDLINE_CLASSIFY_SSE2
+#endif
+#endif
+
+#ifdef CMDLINE_CLASSIFY_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace cmdline {
+namespace detail {
+
+#ifdef CMDLINE_CLASSIFY_SSE2
+// Returns the length of `s' and stores the offset of its first `=' in `equals'
+CMDLINE_INLINE std::uint32_t scan_token(const char *s, std::uint32_t &equals) {
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i eq = _mm_set1_epi8('=');
+  const std::uintptr_t misalignment = reinterpret_cast<std::uintptr_t>(s) & 15;
+  const char *block = s - misalignment;
+  // Bits for the bytes before `s' are shifted out of the first block
+  unsigned ignore = ~0u << misalignment;
+  for (;; block += 16, ignore = ~0u) {
+    const __m128i bytes = _mm_load_si128(reinterpret_cast<const __m128i *>(block));
+    const unsigned nul_mask = static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, zero))) & ignore;
+    unsigned eq_mask = static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, eq))) & ignore;
+    if (nul_mask) {
+      // Only `=' before the terminator count
+      eq_mask &= (nul_mask & -nul_mask) - 1;
+    }
+    if (eq_mask and equals == TokenClass::no_equals) {
+      equals = static_cast<std::uint32_t>(block + __builtin_ctz(eq_mask) - s);
+    }
+    if (nul_mask) {
+      return static_cast<std::uint32_t>(block + __builtin_ctz(nul_mask) - s);
+    }
+  }
+}
+#else
+CMDLINE_INLINE std::uint32_t scan_token(const char *s, std::uint32_t &equals) {
+  const std::size_t length = std::strlen(s);
+  if (const void *eq = std::memchr(s, '=', length)) {
+    equals = static_cast<std::uint32_t>(static_cast<const char *>(eq) - s);
+  }
+  return static_cast<std::uint32_t>(length);
+}
+#endif
+
+}
+
+CMDLINE_INLINE void classify_tokens(const char *const *tokens, std::size_t count, TokenClass *classes) {
+  for (std::size_t i = 0; i < count; ++i) {
+    const char *s = tokens[i];
+    TokenClass &c = classes[i];
+    c.equals = TokenClass::no_equals;
+    c.length = detail::scan_token(s, c.equals);
+    // The kind only depends on the first three bytes, which the length
+    // tells are readable
+    if (s[0] != '-') {
+      c.kind = TokenKind::positional;
+    }
+    else if (c.length >= 2 and s[1] == '-') {
+      c.kind = c.length == 2 ? TokenKind::terminator : TokenKind::long_option;
+    }
+    else {
+      c.kind = TokenKind::short_option;
+    }
+  }
+}
+
+}
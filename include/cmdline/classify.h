@@ -0,0 +1,59 @@
+/*
+Copyright (c) 2020 Jakob Mohrbacher
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace cmdline {
+
+enum class TokenKind : std::uint8_t {
+  positional,   //< does not start with `-', including the empty string
+  short_option, //< `-' followed by at least one character, or `-' alone
+  long_option,  //< `--' followed by at least one character
+  terminator,   //< exactly `--'
+};
+
+/**
+ * Summary of one argv element, see `classify_tokens'.
+ */
+struct TokenClass {
+  static constexpr std::uint32_t no_equals = 0xFFFFFFFF;
+
+  std::uint32_t length;
+  std::uint32_t equals; //< offset of the first `=', or `no_equals'
+  TokenKind kind;
+
+  bool starts_with_dash() const { return kind != TokenKind::positional; }
+};
+
+/**
+ * @brief Classifies `count' NUL terminated tokens in one pass.
+ *
+ * Each token is scanned for its terminator and its first `=' sixteen bytes
+ * at a time where SSE2 is available. The loads are aligned and never cross
+ * into the next page, so no token is read past the page holding its NUL.
+ * Tokens longer than 4GiB are not supported.
+ */
+void classify_tokens(const char *const *tokens, std::size_t count, TokenClass *classes);
+
+}
@@ -0,0 +1,1321 @@
+/*
+Copyright (c) 2020 Jakob Mohrbacher
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#pragma once
+
+#include "config.h"
+#include "cmdline.h"
+
+namespace cmdline {
+namespace detail {
+
+CMDLINE_INLINE std::string get_argument_name(char short_name, const char *long_name) {
+  if (long_name != nullptr) {
+    std::string s(long_name);
+    std::for_each(s.begin(), s.end(), [](char &ch) { ch = ch=='-' ? '_' : ::toupper(ch); });
+    return s;
+  }
+  else {
+    return std::string(1, ::toupper(short_name));
+  }
+}
+
+}
+
+CMDLINE_INLINE ArgumentParser::ArgumentParser() {
+  m_short_index.fill(NO_OPTION);
+  this->add_option(m_show_help, "Display this message", 0, "help");
+}
+
+CMDLINE_INLINE bool ArgumentParser::add_option(bool &value, const char *help, char short_name, const char *long_name) {
+  return this->insert_option(short_name, long_name, help, nullptr, 0,
+    [&value](const char **) -> bool {
+      value = true;
+      return true;
+    },
+    nullptr, this->value_access(value));
+}
+
+CMDLINE_INLINE bool ArgumentParser::insert_option(char short_name, const char *long_name, const char *help,
+                                                  const char *argument_name, std::size_t nargs,
+                                                  std::function<bool(const char **)> set_value,
+                                                  std::function<bool(const char **)> check_value,
+                                                  detail::ValueAccess value_access, std::size_t list_value_size) {
+  if (!this->validate_option(short_name, long_name)) {
+    return false;
+  }
+  Option &opt = m_options.emplace_back(
+    short_name,
+    long_name,
+    this->help_text(help),
+    nargs == 0 ? detail::HelpText {} : this->argument_text(short_name, long_name, argument_name),
+    nargs != 0,
+    nargs,
+    std::move(set_value),
+    std::vector<Validator> {},
+    list_value_size
+  );
+  opt.check_value = std::move(check_value);
+  opt.value_access = std::move(value_access);
+  return true;
+}
+
+CMDLINE_INLINE bool ArgumentParser::insert_argument(const char *name, const char *help, bool required, std::size_t nargs,
+                                                    std::function<bool(const char **)> set_value,
+                                                    std::function<bool(const char **)> check_value,
+                                                    detail::ValueAccess value_access) {
+  if (m_arguments.size() > 0 and required and !m_arguments.back().required) {
+    this->report(nullptr, { ErrorCode::required_after_optional, 0, -1,
+      static_cast<std::uint32_t>(m_arguments.size() - 1), 0 });
+    return false;
+  }
+  Argument &arg = m_arguments.emplace_back(
+    name,
+    this->help_text(help),
+    required,
+    nargs,
+    std::move(set_value)
+  );
+  arg.check_value = std::move(check_value);
+  arg.value_access = std::move(value_access);
+  return true;
+}
+
+CMDLINE_INLINE detail::HelpText ArgumentParser::help_text(const char *help) {
+  if (static_help) {
+    return detail::HelpText { help, 0, static_cast<std::uint32_t>(std::strlen(help)) };
+  }
+  return m_help.add(help, compress_help);
+}
+
+CMDLINE_INLINE detail::HelpText ArgumentParser::argument_text(char short_name, const char *long_name, const char *argument_name) {
+  if (argument_name != nullptr) {
+    return m_help.add(argument_name, compress_help);
+  }
+  return m_help.add(detail::get_argument_name(short_name, long_name), compress_help);
+}
+
+CMDLINE_INLINE void ArgumentParser::add_argument(std::vector<const char *> &value, const char *name) {
+  if (m_unhandled == nullptr) {
+    m_unhandled = &value;
+    m_unhandled_name = name;
+  }
+}
+
+CMDLINE_INLINE bool ArgumentParser::add_validator(char short_name, Validator validator) {
+  const std::size_t index = this->option_index(short_name);
+  if (index == npos) {
+    return false;
+  }
+  m_options[index].validators.push_back(std::move(validator));
+  return true;
+}
+
+CMDLINE_INLINE bool ArgumentParser::add_validator(const char *name, Validator validator) {
+  if (name[0] == '\0') {
+    return false;
+  }
+  const std::size_t index = this->option_index(std::string_view(name));
+  if (index != npos) {
+    m_options[index].validators.push_back(std::move(validator));
+    return true;
+  }
+  for (Argument &arg : m_arguments) {
+    if (arg.name == name) {
+      arg.validators.push_back(std::move(validator));
+      return true;
+    }
+  }
+  return false;
+}
+
+CMDLINE_INLINE bool ArgumentParser::validate_option(char short_name, const char *long_name) {
+  bool cs = short_name != 0;
+  bool cl = long_name[0] != '\0';
+  // Compared as a view so most names are told apart by their length
+  const std::string_view long_view(long_name);
+  // Check if either of the names already exists
+  for (std::size_t i = 0; i < m_options.size(); ++i) {
+    const Option &o = m_options[i];
+    if (cs and o.short_name == short_name) {
+      this->report(nullptr, { ErrorCode::duplicate_option,
+        static_cast<std::uint16_t>(static_cast<unsigned char>(short_name)), -1,
+        static_cast<std::uint32_t>(i), 0 });
+      return false;
+    }
+    if (cl and o.long_name == long_view) {
+      this->report(nullptr, { ErrorCode::duplicate_option, 0, -1, static_cast<std::uint32_t>(i), 0 });
+      return false;
+    }
+  }
+  return true;
+}
+
+CMDLINE_INLINE bool ArgumentParser::parse_args(int argc, const char **argv, bool exit_on_failure) {
+  std::size_t argind = 0;
+  bool terminate_options = false;
+
+  auto print_usage_and_exit = [&](int code) {
+    if (code == 0 or error_messages) {
+      this->usage(stderr, argv[0]);
+    }
+    if (exit_on_failure) {
+      std::exit(code);
+    }
+  };
+
+  this->begin_parse();
+  if (m_usage != nullptr) {
+    m_usage->count_parse();
+  }
+  CMDLINE_TIME_PHASE(m_stats, Phase::tokenization);
+
+  if (static_cast<std::size_t>(argc - 1) > limits.max_tokens) {
+    this->report(argv, { ErrorCode::limit_exceeded, static_cast<std::uint16_t>(LimitKind::tokens),
+      static_cast<std::int32_t>(limits.max_tokens + 1), 0, 0 });
+    print_usage_and_exit(1);
+    return false;
+  }
+  if (limits.max_total_bytes != Limits::unlimited and !this->check_total_bytes(argc, argv)) {
+    print_usage_and_exit(1);
+    return false;
+  }
+
+  // Batches are small enough that their elements are still in the cache
+  // when they are parsed
+  constexpr std::size_t CLASSIFY_BATCH = 256;
+  const bool classify = static_cast<std::size_t>(argc - 1) >= classify_min_tokens;
+  if (classify) {
+    m_classes.resize(CLASSIFY_BATCH);
+  }
+  for (int i = 1; i < argc; ++i) {
+    if (classify and static_cast<std::size_t>(i) >= m_classes_begin + m_classes_count) {
+      m_classes_begin = i;
+      m_classes_count = std::min(CLASSIFY_BATCH, static_cast<std::size_t>(argc - i));
+      classify_tokens(argv + i, m_classes_count, m_classes.data());
+    }
+    if (!this->parse_item(argc, argv, i, argind, terminate_options)) {
+      m_classes_count = 0;
+      print_usage_and_exit(1);
+      return false;
+    }
+  }
+  m_classes_count = 0;
+  m_argument_count = argind;
+
+  if (!m_constraints.empty() and !m_show_help and !this->check_constraints(argv)) {
+    print_usage_and_exit(1);
+    return false;
+  }
+
+  if (!m_pending_validation.empty() and !this->run_validators(argv)) {
+    print_usage_and_exit(1);
+    return false;
+  }
+
+  // Check if all required arguments where handled
+  if (!this->check_required_arguments(argv, argind)) {
+    print_usage_and_exit(1);
+    return false;
+  }
+
+  if (m_show_help) {
+    print_usage_and_exit(0);
+    return false;
+  }
+
+  if (!m_groups.empty()) {
+    this->dispatch_groups();
+  }
+  return true;
+}
+
+CMDLINE_INLINE void ArgumentParser::begin_parse() {
+  m_pending_validation.clear();
+  m_diagnostics_count = 0;
+  for (Option &opt : m_options) {
+    opt.occurrences = 0;
+  }
+  m_unhandled_count = 0;
+  m_arena_bytes = 0;
+  m_argument_count = 0;
+  m_classes_begin = 0;
+  m_classes_count = 0;
+  m_show_help = false;
+  if (m_spec != nullptr) {
+    m_spec_hits.clear();
+    m_spec_values.clear();
+    m_spec_occurrences.clear();
+  }
+#ifdef CMDLINE_INSTRUMENTATION
+  m_stats.reset(m_options.size(), m_arguments.size());
+#endif
+}
+
+CMDLINE_INLINE bool ArgumentParser::parse_item(int argc, const char **argv, int &i, std::size_t &argind, bool &terminate_options) {
+  if (const TokenClass *c = this->token_class(i)) {
+    if (terminate_options or c->kind == TokenKind::positional) {
+      return this->parse_argument(argc, argv, i, argind);
+    }
+    if (c->kind == TokenKind::terminator) {
+      terminate_options = true;
+      return true;
+    }
+    if (c->kind == TokenKind::long_option
+        or (abbreviations and (c->length > 2 or this->find_option(argv[i][1]) == npos))) {
+      return this->parse_long_option(argc, argv, i);
+    }
+    return this->parse_short_option(argc, argv, i);
+  }
+  if (!terminate_options and argv[i][0] == '-') {
+    if (argv[i][1] == '-'
+        or (abbreviations and (argv[i][2] or this->find_option(argv[i][1]) == npos))) {
+      if (!strcmp(argv[i], "--")) {
+        terminate_options = true;
+        return true;
+      }
+      return this->parse_long_option(argc, argv, i);
+    }
+    return this->parse_short_option(argc, argv, i);
+  }
+  return this->parse_argument(argc, argv, i, argind);
+}
+
+CMDLINE_INLINE bool ArgumentParser::check_required_arguments(const char **argv, std::size_t argind) {
+  if (argind == m_arguments.size() or !m_arguments[argind].required) {
+    return true;
+  }
+  for (std::size_t i = argind; i < m_arguments.size() and m_arguments[i].required; ++i) {
+    this->report(argv, { ErrorCode::argument_required, 0, 0, static_cast<std::uint32_t>(i), 0 });
+  }
+  return false;
+}
+
+CMDLINE_INLINE bool ArgumentParser::parse_command_line(const char *program_name, char *command, const char **arena,
+                                       std::size_t capacity, bool exit_on_failure) {
+  if (capacity == 0) {
+    return false;
+  }
+  arena[0] = program_name;
+  const TokenizeResult words = tokenize(command, arena + 1, capacity - 1);
+  if (!words) {
+    m_diagnostics_count = 0;
+    this->report(arena, { ErrorCode::invalid_command_line, static_cast<std::uint16_t>(words.status), -1, 0,
+      static_cast<std::uint32_t>(words.offset) });
+    if (error_messages) {
+      this->usage(stderr, program_name);
+    }
+    if (exit_on_failure) {
+      std::exit(1);
+    }
+    return false;
+  }
+  return this->parse_args(static_cast<int>(words.count + 1), arena, exit_on_failure);
+}
+
+CMDLINE_INLINE std::size_t ArgumentParser::option_index(char short_name) {
+  CMDLINE_TIME_PHASE(m_stats, Phase::lookup);
+  // Options are only ever appended, so only the new ones need to be indexed
+  for (; m_short_index_options < m_options.size(); ++m_short_index_options) {
+    const char ch = m_options[m_short_index_options].short_name;
+    if (ch != 0) {
+      m_short_index[static_cast<unsigned char>(ch)] = static_cast<std::uint32_t>(m_short_index_options);
+    }
+  }
+  if (short_name == 0) {
+    return npos;
+  }
+  const std::uint32_t index = m_short_index[static_cast<unsigned char>(short_name)];
+  return index == NO_OPTION ? npos : index;
+}
+
+CMDLINE_INLINE std::size_t ArgumentParser::find_option(char short_name) {
+  const std::size_t index = this->option_index(short_name);
+  if (index != npos or m_spec == nullptr) {
+    return index;
+  }
+  const std::size_t spec = m_spec->find(short_name);
+  return spec == SpecImage::npos ? npos : spec | SPEC_OPTION;
+}
+
+CMDLINE_INLINE std::size_t ArgumentParser::option_nargs(std::size_t id) const {
+  return id & SPEC_OPTION ? m_spec->option(id & ~SPEC_OPTION).nargs : m_options[id].nargs;
+}
+
+CMDLINE_INLINE std::stringstream & ArgumentParser::string_stream() {
+  if (m_ss == nullptr) {
+    m_ss = std::make_unique<std::stringstream>();
+  }
+  return *m_ss;
+}
+
+CMDLINE_INLINE bool ArgumentParser::takes_optional_value(std::size_t id) const {
+  return !(id & SPEC_OPTION) and m_options[id].optional_value;
+}
+
+CMDLINE_INLINE std::size_t ArgumentParser::option_index(const std::string_view long_name) {
+  CMDLINE_TIME_PHASE(m_stats, Phase::lookup);
+  for (std::size_t i = 0; i< m_options.size(); ++i) {
+      if (m_options[i].long_name == long_name) {
+        return i;
+      }
+    }
+  return npos;
+}
+
+CMDLINE_INLINE std::vector<std::string_view> ArgumentParser::suggest(std::string_view name, std::size_t max_results) const {
+  // Options are only ever appended, so the count tells if the index is stale
+  if (m_suggestion_index_options != m_options.size()) {
+    m_suggestion_index.clear();
+    for (std::size_t i = 0; i < m_options.size(); ++i) {
+      if (not m_options[i].long_name.empty()) {
+        m_suggestion_index.add(m_options[i].long_name, static_cast<std::uint32_t>(i));
+      }
+    }
+    m_suggestion_index.finalize();
+    m_suggestion_index_options = m_options.size();
+  }
+  const std::size_t max_distance = std::clamp<std::size_t>((name.length() + 2) / 3, 1, 3);
+  std::vector<std::string_view> names;
+  for (const detail::SuggestionIndex::Match &m : m_suggestion_index.find(name, max_results, max_distance)) {
+    names.push_back(m_options[m.id].long_name);
+  }
+  return names;
+}
+
+CMDLINE_INLINE void ArgumentParser::set_diagnostic_buffer(Diagnostic *buffer, std::size_t capacity) {
+  m_diagnostics = buffer;
+  m_diagnostics_capacity = buffer ? capacity : 0;
+  m_diagnostics_count = 0;
+}
+
+CMDLINE_INLINE void ArgumentParser::report(const char *const *argv, const Diagnostic &d) {
+  if (m_session != nullptr) {
+    m_session->record(d);
+    return;
+  }
+  if (m_diagnostics_count < m_diagnostics_capacity) {
+    m_diagnostics[m_diagnostics_count] = d;
+  }
+  ++m_diagnostics_count;
+  if (error_messages) {
+    // Format first and write once so messages from parsers on different
+    // threads do not interleave.
+    char buffer[512];
+    std::size_t length = this->format_diagnostic(d, argv, buffer, sizeof(buffer) - 1);
+    length = std::min(length, sizeof(buffer) - 2);
+    buffer[length] = '\n';
+    std::fwrite(buffer, 1, length + 1, stderr);
+  }
+}
+
+namespace detail {
+
+/**
+ * Appends formatted text to a fixed size buffer, keeping track of the length
+ * the text would have without truncation.
+ */
+class Formatter {
+  char *m_buffer;
+  std::size_t m_size;
+  std::size_t m_length = 0;
+
+public:
+  Formatter(char *buffer, std::size_t size)
+    : m_buffer(buffer), m_size(size) {
+    if (size) {
+      buffer[0] = '\0';
+    }
+  }
+
+  template<typename... Args>
+  void operator()(const char *fmt, const Args&... args) {
+    const std::size_t at = std::min(m_length, m_size ? m_size - 1 : 0);
+    const int n = std::snprintf(m_buffer + at, m_size - at, fmt, args...);
+    if (n > 0) {
+      m_length += static_cast<std::size_t>(n);
+    }
+  }
+
+  std::size_t length() const { return m_length; }
+};
+
+}
+
+CMDLINE_INLINE std::size_t ArgumentParser::format_diagnostic(const Diagnostic &d, const char *const *argv, char *buffer, std::size_t size) const {
+  detail::Formatter print(size ? buffer : nullptr, size);
+  const bool have_argv = argv != nullptr and d.argv_index >= 0;
+  const char *token = have_argv ? argv[d.argv_index] : "";
+  const char *at = have_argv ? token + d.offset : "";
+
+  auto short_name = [&](std::uint32_t id) {
+    return id & SPEC_OPTION ? m_spec->option(id & ~SPEC_OPTION).short_name : m_options[id].short_name;
+  };
+  auto option_name = [&](std::uint32_t id) {
+    const std::string_view long_name = id & SPEC_OPTION
+      ? m_spec->option(id & ~SPEC_OPTION).long_name
+      : std::string_view(m_options[id].long_name);
+    if (long_name.empty()) {
+      print("-%c", short_name(id));
+    }
+    else {
+      print("--%.*s", static_cast<int>(long_name.length()), long_name.data());
+    }
+  };
+  // The name as given by the user, up to the `='
+  auto given_name = [&]() {
+    const char *eq = std::strchr(token, '=');
+    return std::string_view(at, eq ? static_cast<std::size_t>(eq - at) : std::strlen(at));
+  };
+  auto requires_arguments = [&](std::size_t nargs) {
+    if (nargs == 1) {
+      print("requires an argument");
+    }
+    else {
+      print("requires %zu arguments", nargs);
+    }
+  };
+
+  if (argv != nullptr and d.code != ErrorCode::duplicate_option
+      and d.code != ErrorCode::required_after_optional and d.code != ErrorCode::duplicate_group) {
+    print("%s: ", argv[0]);
+  }
+
+  switch (d.code) {
+  case ErrorCode::duplicate_option:
+    if (d.detail) {
+      print("duplicate option -- %c", static_cast<char>(d.detail));
+    }
+    else {
+      print("duplicate option `%s'", m_options[d.id].long_name.c_str());
+    }
+    break;
+  case ErrorCode::duplicate_group:
+    print("duplicate option group `%s'", m_groups[d.id].name.c_str());
+    break;
+  case ErrorCode::required_after_optional:
+    print("required argument cannot follow optional argument `%s'", m_arguments[d.id].name.c_str());
+    break;
+  case ErrorCode::ambiguous_option:
+    print("option `%s' is ambiguous", token);
+    break;
+  case ErrorCode::unrecognized_option: {
+    const std::string_view name = given_name();
+    print("unrecognized option `--%.*s'", static_cast<int>(name.length()), name.data());
+    if (!have_argv) {
+      break;
+    }
+    const std::vector<std::string_view> suggestions = this->suggest(name);
+    for (std::size_t n = 0; n < suggestions.size(); ++n) {
+      print("%s`--%.*s'",
+        n == 0 ? "; did you mean " : n + 1 == suggestions.size() ? " or " : ", ",
+        static_cast<int>(suggestions[n].length()), suggestions[n].data());
+    }
+    if (!suggestions.empty()) {
+      print("?");
+    }
+    break;
+  }
+  case ErrorCode::invalid_option:
+    print("invalid option -- %c", *at);
+    break;
+  case ErrorCode::option_missing_argument:
+    if (d.detail) {
+      const std::string_view name = given_name();
+      print("option `--%.*s' ", static_cast<int>(name.length()), name.data());
+      requires_arguments(this->option_nargs(d.id));
+    }
+    else {
+      print("option ");
+      requires_arguments(this->option_nargs(d.id));
+      print(" -- %c", short_name(d.id));
+    }
+    break;
+  case ErrorCode::option_unexpected_argument:
+    print("option `");
+    option_name(d.id);
+    print("' doesn't allow an argument");
+    break;
+  case ErrorCode::interpolation_failed:
+    print("%s in `%s'", interpolate_status_message(static_cast<InterpolateStatus>(d.detail)), token);
+    break;
+  case ErrorCode::option_invalid_argument:
+    print("invalid argument `%s' for option `", at);
+    option_name(d.id);
+    print("'");
+    break;
+  case ErrorCode::option_validation_failed:
+    print("invalid value `%s' for option `", at);
+    option_name(d.id);
+    print("': %s", m_options[d.id].validators[d.detail].message.c_str());
+    break;
+  case ErrorCode::unrecognized_argument:
+    print("unrecognized argument: `%s'", token);
+    break;
+  case ErrorCode::argument_missing_value:
+    print("argument `%s' ", m_arguments[d.id].name.c_str());
+    requires_arguments(m_arguments[d.id].nargs);
+    break;
+  case ErrorCode::argument_invalid_value:
+    print("invalid value `%s' for argument `%s'", at, m_arguments[d.id].name.c_str());
+    break;
+  case ErrorCode::argument_validation_failed:
+    print("invalid value `%s' for argument `%s': %s", at, m_arguments[d.id].name.c_str(),
+      m_arguments[d.id].validators[d.detail].message.c_str());
+    break;
+  case ErrorCode::argument_required:
+    print("argument `%s' is required", m_arguments[d.id].name.c_str());
+    break;
+  case ErrorCode::limit_exceeded:
+    switch (static_cast<LimitKind>(d.detail)) {
+    case LimitKind::tokens:
+      print("too many arguments (at most %zu)", limits.max_tokens);
+      break;
+    case LimitKind::total_bytes:
+      print("arguments exceed %zu bytes", limits.max_total_bytes);
+      break;
+    case LimitKind::occurrences:
+      print("option `");
+      option_name(d.id);
+      print("' given more than %zu times", limits.max_occurrences);
+      break;
+    case LimitKind::list_values:
+      if (d.id == NO_OPTION) {
+        print("too many positional arguments (at most %zu)", limits.max_list_values);
+      }
+      else {
+        print("too many values for option `");
+        option_name(d.id);
+        print("' (at most %zu)", limits.max_list_values);
+      }
+      break;
+    case LimitKind::arena_bytes:
+      print("values exceed %zu bytes", limits.max_arena_bytes);
+      break;
+    }
+    break;
+  case ErrorCode::constraint_violated: {
+    const detail::Constraint &c = m_constraints[d.id];
+    // `--a', `--b' and `--c'
+    auto group = [&](const char *conjunction) {
+      const std::size_t count = c.group.size();
+      std::size_t n = 0;
+      c.group.for_each([&](std::size_t index) {
+        if (n != 0 and n + 1 == count) {
+          print(" %s ", conjunction);
+        }
+        else if (n != 0) {
+          print(", ");
+        }
+        print("`");
+        option_name(static_cast<std::uint32_t>(index));
+        print("'");
+        ++n;
+      });
+    };
+    switch (static_cast<ConstraintKind>(d.detail)) {
+    case ConstraintKind::required:
+      print(c.group.size() == 1 ? "option " : "options ");
+      group("and");
+      print(c.group.size() == 1 ? " is required" : " are required");
+      break;
+    case ConstraintKind::exclusive:
+      print("only one of ");
+      group("or");
+      print(" may be given");
+      break;
+    case ConstraintKind::at_least_one:
+      print("one of ");
+      group("or");
+      print(" is required");
+      break;
+    case ConstraintKind::dependency:
+      print("option `");
+      option_name(c.option);
+      print("' requires ");
+      group("and");
+      break;
+    }
+    break;
+  }
+  case ErrorCode::invalid_command_line:
+    print("%s at offset %u of the command line",
+      tokenize_status_message(static_cast<TokenizeStatus>(d.detail)), d.offset);
+    break;
+  }
+  return print.length();
+}
+
+CMDLINE_INLINE bool ArgumentParser::check_limit(const char **argv, LimitKind kind, std::size_t value, std::size_t limit,
+                                 int argv_index, std::uint32_t id, std::uint32_t offset) {
+  if (value <= limit) {
+    return true;
+  }
+  this->report(argv, { ErrorCode::limit_exceeded, static_cast<std::uint16_t>(kind), argv_index, id, offset });
+  return false;
+}
+
+CMDLINE_INLINE bool ArgumentParser::fits_arena(const char *str) {
+  if (limits.max_arena_bytes != Limits::unlimited
+      and m_strings.bytes_used() + std::strlen(str) + 1 > limits.max_arena_bytes) {
+    m_arena_full = true;
+    return false;
+  }
+  return true;
+}
+
+CMDLINE_INLINE bool ArgumentParser::check_total_bytes(int argc, const char **argv) {
+  std::size_t remaining = limits.max_total_bytes;
+  for (int i = 1; i < argc; ++i) {
+    // Stop at the budget so an oversized element is not read in full
+    const std::size_t length = strnlen(argv[i], remaining + 1);
+    if (length > remaining) {
+      return this->check_limit(argv, LimitKind::total_bytes, limits.max_total_bytes + 1,
+        limits.max_total_bytes, i, 0, static_cast<std::uint32_t>(remaining));
+    }
+    remaining -= length;
+  }
+  return true;
+}
+
+CMDLINE_INLINE bool ArgumentParser::set_option(const char **argv, std::size_t index, const char **args, int value_index, std::uint32_t value_offset) {
+  if (index & SPEC_OPTION) {
+    return this->set_spec_option(argv, index & ~SPEC_OPTION, args, value_index, value_offset);
+  }
+  Option &opt = m_options[index];
+  if (!this->interpolate_args(argv, args, opt.nargs, value_index, value_offset, static_cast<std::uint32_t>(index))) {
+    return false;
+  }
+  bool ok;
+  m_failed_value = 0;
+  m_arena_full = false;
+  if (m_session != nullptr) {
+    ok = m_session->convert(true, index, args, value_index);
+  }
+  else {
+    const std::size_t occurrences = ++opt.occurrences;
+    if (m_usage != nullptr and occurrences == 1) {
+      m_usage->count_option(index);
+    }
+    if (!this->check_limit(argv, LimitKind::occurrences, occurrences, limits.max_occurrences,
+                           value_index, static_cast<std::uint32_t>(index))) {
+      return false;
+    }
+    if (opt.list_value_size != 0) {
+      if (!this->check_limit(argv, LimitKind::list_values, occurrences, limits.max_list_values,
+                             value_index, static_cast<std::uint32_t>(index))) {
+        return false;
+      }
+      // Values are only measured when there is a budget to measure them by
+      if (limits.max_arena_bytes != Limits::unlimited) {
+        m_arena_bytes += opt.list_value_size + std::strlen(args[0]);
+        if (!this->check_limit(argv, LimitKind::arena_bytes, m_arena_bytes + m_strings.bytes_used(), limits.max_arena_bytes,
+                               value_index, static_cast<std::uint32_t>(index))) {
+          return false;
+        }
+      }
+    }
+    for (std::size_t v = 0; v < opt.validators.size(); ++v) {
+      for (std::size_t n = 0; n < opt.nargs; ++n) {
+        m_pending_validation.push_back({ &opt.validators[v], args[n], value_index + static_cast<int>(n),
+          n == 0 ? value_offset : 0, index, v, true });
+      }
+    }
+    CMDLINE_COUNT(m_stats.option_hits, index);
+    CMDLINE_TIME_PHASE(m_stats, Phase::conversion);
+    ok = opt.set_value(args);
+  }
+  if (!ok) {
+    CMDLINE_COUNT(m_stats.option_conversion_failures, index);
+    // Only the first value can be attached to the option name
+    const int failed_index = value_index + static_cast<int>(m_failed_value);
+    const std::uint32_t failed_offset = m_failed_value == 0 ? value_offset : 0;
+    if (m_arena_full) {
+      this->report(argv, { ErrorCode::limit_exceeded, static_cast<std::uint16_t>(LimitKind::arena_bytes),
+        failed_index, static_cast<std::uint32_t>(index), failed_offset });
+    }
+    else {
+      this->report(argv, { ErrorCode::option_invalid_argument, 0, failed_index, static_cast<std::uint32_t>(index),
+        failed_offset });
+    }
+    return false;
+  }
+  return true;
+}
+
+CMDLINE_INLINE bool ArgumentParser::set_spec_option(const char **argv, std::size_t index, const char **args, int value_index, std::uint32_t value_offset) {
+  if (m_session != nullptr) {
+    return true;
+  }
+  const std::uint32_t id = static_cast<std::uint32_t>(index) | SPEC_OPTION;
+  if (!this->interpolate_args(argv, args, m_spec->option(index).nargs, value_index, value_offset, id)) {
+    return false;
+  }
+  if (limits.max_occurrences != Limits::unlimited
+      and !this->check_limit(argv, LimitKind::occurrences, ++m_spec_occurrences[static_cast<std::uint32_t>(index)],
+                             limits.max_occurrences, value_index, id)) {
+    return false;
+  }
+  m_spec_hits.push_back({ static_cast<std::uint32_t>(index), static_cast<std::uint32_t>(m_spec_values.size()) });
+  if (args != nullptr) {
+    m_spec_values.insert(m_spec_values.end(), args, args + m_spec->option(index).nargs);
+  }
+  const auto binding = m_spec_bindings.find(static_cast<std::uint32_t>(index));
+  if (binding != m_spec_bindings.end() and !binding->second(args)) {
+    this->report(argv, { ErrorCode::option_invalid_argument, 0, value_index, id, value_offset });
+    return false;
+  }
+  return true;
+}
+
+CMDLINE_INLINE void ArgumentParser::use_spec(const SpecImage *image) {
+  m_spec = image;
+  m_spec_bindings.clear();
+  m_spec_hits.clear();
+  m_spec_values.clear();
+}
+
+CMDLINE_INLINE std::size_t ArgumentParser::spec_values(std::string_view long_name, std::vector<const char *> &values) const {
+  const std::size_t index = m_spec ? m_spec->find(long_name) : SpecImage::npos;
+  if (index == SpecImage::npos) {
+    return 0;
+  }
+  const std::size_t nargs = m_spec->option(index).nargs;
+  std::size_t occurrences = 0;
+  for (const detail::SpecHit &hit : m_spec_hits) {
+    if (hit.option == index) {
+      values.insert(values.end(), m_spec_values.begin() + hit.first_value,
+        m_spec_values.begin() + hit.first_value + nargs);
+      ++occurrences;
+    }
+  }
+  return occurrences;
+}
+
+CMDLINE_INLINE bool ArgumentParser::set_argument(const char **argv, std::size_t index, const char **args, int argv_index) {
+  Argument &arg = m_arguments[index];
+  if (!this->interpolate_args(argv, args, arg.nargs, argv_index, 0, static_cast<std::uint32_t>(index))) {
+    return false;
+  }
+  bool ok;
+  m_failed_value = 0;
+  m_arena_full = false;
+  if (m_session != nullptr) {
+    ok = m_session->convert(false, index, args, argv_index);
+  }
+  else {
+    for (std::size_t v = 0; v < arg.validators.size(); ++v) {
+      for (std::size_t n = 0; n < arg.nargs; ++n) {
+        m_pending_validation.push_back({ &arg.validators[v], args[n], argv_index + static_cast<int>(n),
+          0, index, v, false });
+      }
+    }
+    CMDLINE_COUNT(m_stats.argument_hits, index);
+    CMDLINE_TIME_PHASE(m_stats, Phase::conversion);
+    ok = arg.set_value(args);
+  }
+  if (!ok) {
+    CMDLINE_COUNT(m_stats.argument_conversion_failures, index);
+    if (m_arena_full) {
+      this->report(argv, { ErrorCode::limit_exceeded, static_cast<std::uint16_t>(LimitKind::arena_bytes),
+        argv_index + static_cast<int>(m_failed_value), NO_OPTION, 0 });
+    }
+    else {
+      this->report(argv, { ErrorCode::argument_invalid_value, 0, argv_index + static_cast<int>(m_failed_value),
+        static_cast<std::uint32_t>(index), 0 });
+    }
+    return false;
+  }
+  return true;
+}
+
+CMDLINE_INLINE bool ArgumentParser::interpolate_args(const char **argv, const char **&args, std::size_t nargs,
+                                                   int argv_index, std::uint32_t value_offset, std::uint32_t id) {
+  if (!interpolate_values or args == nullptr) {
+    return true;
+  }
+  bool expanded = false;
+  for (std::size_t n = 0; n < nargs; ++n) {
+    const InterpolateResult result = interpolate(args[n], m_interpolation_buffer, max_interpolation_depth,
+                                                 max_interpolated_length);
+    if (!result) {
+      this->report(argv, { ErrorCode::interpolation_failed, static_cast<std::uint16_t>(result.status),
+        argv_index + static_cast<int>(n), id,
+        (n == 0 ? value_offset : 0) + static_cast<std::uint32_t>(result.offset) });
+      return false;
+    }
+    if (result.value != args[n]) {
+      if (!this->fits_arena(m_interpolation_buffer.c_str())) {
+        this->report(argv, { ErrorCode::limit_exceeded, static_cast<std::uint16_t>(LimitKind::arena_bytes),
+          argv_index + static_cast<int>(n), NO_OPTION, n == 0 ? value_offset : 0 });
+        return false;
+      }
+      if (!expanded) {
+        m_interpolated.assign(args, args + nargs);
+        expanded = true;
+      }
+      m_interpolated[n] = m_strings.store(m_interpolation_buffer).data();
+    }
+  }
+  if (expanded) {
+    args = m_interpolated.data();
+  }
+  return true;
+}
+
+CMDLINE_INLINE bool ArgumentParser::run_validators(const char **argv) {
+  CMDLINE_TIME_PHASE(m_stats, Phase::validation);
+  std::vector<char> ok;
+  detail::run_validations(m_pending_validation, ok, validation_threads);
+  bool all_ok = true;
+  for (std::size_t i = 0; i < m_pending_validation.size(); ++i) {
+    if (ok[i]) {
+      continue;
+    }
+    all_ok = false;
+    const detail::PendingValidation &p = m_pending_validation[i];
+    this->report(argv, {
+      p.is_option ? ErrorCode::option_validation_failed : ErrorCode::argument_validation_failed,
+      static_cast<std::uint16_t>(p.validator_index), p.argv_index,
+      static_cast<std::uint32_t>(p.owner), p.offset });
+  }
+  return all_ok;
+}
+
+CMDLINE_INLINE bool ArgumentParser::parse_long_option(int argc, const char **argv, int &optind) {
+  std::size_t eq_pos;
+  std::string_view tok;
+  if (const TokenClass *c = this->token_class(optind)) {
+    tok = std::string_view(argv[optind], c->length);
+    eq_pos = c->equals == TokenClass::no_equals ? std::string_view::npos : c->equals;
+  }
+  else {
+    tok = argv[optind];
+    eq_pos = tok.find('=');
+  }
+  const int off = 1 + static_cast<int>(argv[optind][1] == '-');
+  const std::string_view name = tok.substr(off, eq_pos - off);
+  std::size_t index_found = npos;
+  std::size_t i;
+  bool exact = false;
+  bool ambiguous = false;
+
+  if (!abbreviations) {
+    index_found = this->option_index(name);
+    exact = index_found != npos;
+  }
+  else {
+    CMDLINE_TIME_PHASE(m_stats, Phase::lookup);
+    for (i = 0; i < m_options.size(); ++i) {
+      if (!strncmp(name.data(), m_options[i].long_name.c_str(), name.length())) {
+        if (m_options[i].long_name.length() == name.length()) {
+          // exact match found
+          index_found = i;
+          exact = true;
+          ambiguous = false;
+          break;
+        }
+        else if (index_found == npos) {
+          // first non-exact match
+          index_found = i;
+        }
+        else {
+          ambiguous = true;
+        }
+      }
+    }
+  }
+
+  if (!exact and m_spec != nullptr) {
+    // An exact match in the image wins over abbreviated ones
+    bool spec_ambiguous = false;
+    const std::size_t spec = abbreviations ? m_spec->find_prefix(name, spec_ambiguous) : m_spec->find(name);
+    if (spec != SpecImage::npos and m_spec->option(spec).long_name.length() == name.length()) {
+      index_found = spec | SPEC_OPTION;
+      ambiguous = false;
+    }
+    else if (spec != SpecImage::npos or spec_ambiguous) {
+      ambiguous = ambiguous or spec_ambiguous or index_found != npos;
+      index_found = spec | SPEC_OPTION;
+    }
+  }
+  if (ambiguous) {
+    this->report(argv, { ErrorCode::ambiguous_option, 0, optind, 0, 0 });
+    return false;
+  }
+
+  if (index_found == npos) {
+    if (ignore_unknown) {
+      return true;
+    }
+    this->report(argv, { ErrorCode::unrecognized_option, 0, optind, 0, static_cast<std::uint32_t>(off) });
+    return false;
+  }
+
+  const std::size_t nargs = this->option_nargs(index_found);
+  const Diagnostic missing_argument { ErrorCode::option_missing_argument, 1, optind,
+    static_cast<std::uint32_t>(index_found), static_cast<std::uint32_t>(off) };
+
+  if (nargs > 0) {
+    if (eq_pos == std::string::npos) {
+      // Check if there are enough argv elements left
+      if ((optind + nargs) >= static_cast<std::size_t>(argc)) {
+        this->report(argv, missing_argument);
+        return false;
+      }
+      // Check if there are enough arguments
+      for (std::size_t n = 0; n < nargs and !m_getopt_syntax; ++n) {
+        if (this->starts_with_dash(argv, optind + n + 1)) {
+          this->report(argv, missing_argument);
+          return false;
+        }
+      }
+      // All good
+      const bool ok = this->set_option(argv, index_found, &argv[optind + 1], optind + 1, 0);
+      optind += nargs;
+      return ok;
+    }
+    else {
+      const char *arg = argv[optind] + eq_pos + 1;
+      if (nargs > 1 or *arg == '\0') {
+        this->report(argv, missing_argument);
+        return false;
+      }
+      return this->set_option(argv, index_found, &arg, optind, static_cast<std::uint32_t>(eq_pos + 1));
+    }
+  }
+  else if (eq_pos != std::string::npos and this->takes_optional_value(index_found)) {
+    const char *arg = argv[optind] + eq_pos + 1;
+    return this->set_option(argv, index_found, &arg, optind, static_cast<std::uint32_t>(eq_pos + 1));
+  }
+  else if (eq_pos != std::string::npos and m_getopt_syntax) {
+    this->report(argv, { ErrorCode::option_unexpected_argument, 1, optind, static_cast<std::uint32_t>(index_found),
+      static_cast<std::uint32_t>(eq_pos + 1) });
+    return false;
+  }
+  else {
+    return this->set_option(argv, index_found, nullptr, optind, 0);
+  }
+}
+
+CMDLINE_INLINE bool ArgumentParser::parse_short_option(int argc, const char **argv, int &optind) {
+  std::size_t index = this->find_option(argv[optind][1]);
+
+  if (index == npos) {
+    if (ignore_unknown) {
+      // The rest of the element may be its value
+      return true;
+    }
+    this->report(argv, { ErrorCode::invalid_option, 0, optind, 0, 1 });
+    return false;
+  }
+
+  const std::size_t nargs = this->option_nargs(index);
+  const Diagnostic missing_argument { ErrorCode::option_missing_argument, 0, optind,
+    static_cast<std::uint32_t>(index), 1 };
+
+  if (nargs > 0) {
+    if (argv[optind][2]) {
+      // There's something else in the argv element, assume it's the argument
+      if (nargs > 1) {
+        this->report(argv, missing_argument);
+        return false;
+      }
+      const char *arg = argv[optind] + 2;
+      return this->set_option(argv, index, &arg, optind, 2);
+    }
+    else {
+      // Check if there are enough argv elements left
+      if ((optind + nargs) >= static_cast<std::size_t>(argc)) {
+        this->report(argv, missing_argument);
+        return false;
+      }
+      // Check if there are enough arguments
+      for (std::size_t n = 0; n < nargs and !m_getopt_syntax; ++n) {
+        if (this->starts_with_dash(argv, optind + n + 1)) {
+          this->report(argv, missing_argument);
+          return false;
+        }
+      }
+      // All good
+      const bool ok = this->set_option(argv, index, &argv[optind + 1], optind + 1, 0);
+      optind += nargs;
+      return ok;
+    }
+  }
+  else if (argv[optind][2] and this->takes_optional_value(index)) {
+    const char *arg = argv[optind] + 2;
+    return this->set_option(argv, index, &arg, optind, 2);
+  }
+  else {
+    if (!this->set_option(argv, index, nullptr, optind, 0)) {
+      return false;
+    }
+    // Grouped flags, each character costs one table lookup
+    for (const char *p = argv[optind] + 2; *p; ++p) {
+      const std::uint32_t offset = static_cast<std::uint32_t>(p - argv[optind]);
+      index = this->find_option(*p);
+      if (index == npos) {
+        if (ignore_unknown) {
+          continue;
+        }
+        this->report(argv, { ErrorCode::invalid_option, 0, optind, 0, offset });
+        return false;
+      }
+      if (p[1] and this->takes_optional_value(index)) {
+        // The rest of the element is its value
+        const char *arg = p + 1;
+        return this->set_option(argv, index, &arg, optind, offset + 1);
+      }
+      const std::size_t group_nargs = this->option_nargs(index);
+      if (group_nargs > 0) {
+        // Options taking an argument can not be grouped, except as the last
+        // one of the group with getopt syntax, taking the rest of the
+        // element or the next elements
+        if (!m_getopt_syntax or (p[1] ? group_nargs > 1 : (optind + group_nargs) >= static_cast<std::size_t>(argc))) {
+          this->report(argv, { ErrorCode::option_missing_argument, 0, optind,
+            static_cast<std::uint32_t>(index), offset });
+          return false;
+        }
+        if (p[1]) {
+          const char *arg = p + 1;
+          return this->set_option(argv, index, &arg, optind, offset + 1);
+        }
+        const bool ok = this->set_option(argv, index, &argv[optind + 1], optind + 1, 0);
+        optind += group_nargs;
+        return ok;
+      }
+      if (!this->set_option(argv, index, nullptr, optind, 0)) {
+        return false;
+      }
+    }
+  }
+
+  return true;
+}
+
+CMDLINE_INLINE bool ArgumentParser::parse_argument(int argc, const char **argv, int &optind, std::size_t &argind) {
+  if (argind >= m_arguments.size()) {
+    if (m_unhandled != nullptr) {
+      if (m_session != nullptr) {
+        return true;
+      }
+      if (!this->check_limit(argv, LimitKind::list_values, ++m_unhandled_count, limits.max_list_values,
+                             optind, NO_OPTION)) {
+        return false;
+      }
+      if (limits.max_arena_bytes != Limits::unlimited) {
+        m_arena_bytes += sizeof(const char *) + std::strlen(argv[optind]);
+        if (!this->check_limit(argv, LimitKind::arena_bytes, m_arena_bytes + m_strings.bytes_used(), limits.max_arena_bytes,
+                               optind, NO_OPTION)) {
+          return false;
+        }
+      }
+      const char **value = argv + optind;
+      if (!this->interpolate_args(argv, value, 1, optind, 0, NO_OPTION)) {
+        return false;
+      }
+      m_unhandled->push_back(*value);
+      return true;
+    }
+    else if (ignore_unknown) {
+      return true;
+    }
+    else {
+      this->report(argv, { ErrorCode::unrecognized_argument, 0, optind, 0, 0 });
+      return false;
+    }
+  }
+
+  Argument &arg = m_arguments[argind];
+  const Diagnostic missing_value { ErrorCode::argument_missing_value, 0, optind,
+    static_cast<std::uint32_t>(argind), 0 };
+
+  // Check if there are enough argv elements left
+  if ((optind + arg.nargs - 1) >= static_cast<std::size_t>(argc)) {
+    this->report(argv, missing_value);
+    return false;
+  }
+  // Check if there are enough arguments
+  for (std::size_t n = 0; n < arg.nargs; ++n) {
+    if (this->starts_with_dash(argv, optind + n)) {
+      this->report(argv, missing_value);
+      return false;
+    }
+  }
+  // All good
+  const bool ok = this->set_argument(argv, argind, &argv[optind], optind);
+  optind += arg.nargs - 1;
+  ++argind;
+  return ok;
+}
+
+namespace detail {
+CMDLINE_INLINE void print(FILE *f, char ch) {
+  std::fputc(ch, f);
+}
+CMDLINE_INLINE void print(FILE *f, const char *str) {
+  std::fputs(str, f);
+}
+template<typename... Args>
+CMDLINE_INLINE void print(FILE *f, const char *fmt, const Args&... args) {
+  std::fprintf(f, fmt, args...);
+}
+}
+
+CMDLINE_INLINE void ArgumentParser::usage(FILE *file, const char *program_name) {
+  CMDLINE_TIME_PHASE(m_stats, Phase::usage);
+  auto print = [&file]<typename... Args>(const Args&... args) {
+    detail::print(file, args...);
+  };
+  auto print_opt_name = [&](const Option &o) {
+    if (o.short_name) {
+      print("-%c", o.short_name);
+    }
+    else {
+      print("--%s", o.long_name.c_str());
+    }
+  };
+
+  // Width of the option and argument names column
+  constexpr int NAMES_WIDTH = 24;
+
+  const std::string decoded = m_help.decode();
+
+  print("Usage: %s", program_name);
+
+  for (std::size_t i = 0; i < m_options.size(); ++i) {
+    const Option &opt = m_options[i];
+    const bool required = std::any_of(m_constraints.begin(), m_constraints.end(), [i](const detail::Constraint &c) {
+      return c.kind == ConstraintKind::required and c.group.contains(i);
+    });
+    print(required ? " " : " [");
+    print_opt_name(opt);
+    if (opt.nargs > 0) {
+      for (std::size_t n = 0; n < opt.nargs; ++n) {
+        print(" %s", opt.argument_name.c_str(decoded));
+      }
+    }
+    if (not required) {
+      print(']');
+    }
+  }
+
+  if (m_spec != nullptr and m_spec->option_count() != 0) {
+    print(" [OPTION]...");
+  }
+
+  for (Argument &arg : m_arguments) {
+    print(' ');
+    if (not arg.required) {
+      print('[');
+    }
+    print(arg.name.c_str());
+    for (std::size_t n = 1; n < arg.nargs; ++n) {
+      print(" %s", arg.name.c_str());
+    }
+    if (not arg.required) {
+      print(']');
+    }
+  }
+  if (m_unhandled) {
+    print(' ');
+    if (not m_unhandled_name.empty()) {
+      print(m_unhandled_name.c_str());
+    }
+    print("...");
+  }
+  print('\n');
+
+  print("\nOptions:\n");
+  int written;
+  auto print_option = [&](const Option &opt) {
+    written = 2;
+    print("  ");
+    if (opt.short_name != 0) {
+      print("-%c", opt.short_name);
+      written += 2;
+      if (not opt.long_name.empty()) {
+        print(", ");
+        written += 2;
+      }
+    }
+    if (not opt.long_name.empty()) {
+      print("--%s", opt.long_name.c_str());
+      written += 2 + opt.long_name.length();
+    }
+
+    if (opt.nargs > 0) {
+      print(" ");
+      for (std::size_t n = 0; n < opt.nargs; ++n) {
+        print(" %s", opt.argument_name.c_str(decoded));
+      }
+      written += 1 + (1 + opt.argument_name.length) * opt.nargs;
+    }
+
+    if (written >= NAMES_WIDTH) {
+      print('\n');
+      written = 0;
+    }
+
+    for (int i = written; i < NAMES_WIDTH; ++i) {
+      print(' ');
+    }
+    print(opt.help.c_str(decoded));
+    print('\n');
+  };
+  for (const Option &opt : m_options) {
+    if (opt.group == NO_GROUP) {
+      print_option(opt);
+    }
+  }
+  for (std::uint32_t g = 0; g < m_groups.size(); ++g) {
+    print("\n%s options:", m_groups[g].name.c_str());
+    if (not m_groups[g].help.empty()) {
+      print(" %s", m_groups[g].help.c_str());
+    }
+    print('\n');
+    for (const Option &opt : m_options) {
+      if (opt.group == g) {
+        print_option(opt);
+      }
+    }
+  }
+  if (m_spec != nullptr) {
+    const std::string_view lines = m_spec->usage();
+    print("%.*s", static_cast<int>(lines.length()), lines.data());
+  }
+
+  print("\nArguments:\n");
+  for (Argument &arg : m_arguments) {
+    print("  %s", arg.name.c_str());
+    if (not arg.help.empty()) {
+      for (int i = 2+arg.name.length(); i < NAMES_WIDTH; ++i) {
+        print(' ');
+      }
+      print(arg.help.c_str(decoded));
+    }
+    print('\n');
+  }
+}
+
+}
+
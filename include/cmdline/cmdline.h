@@ -28,12 +28,36 @@ SOFTWARE.
 #include <string_view>
 #include <vector>
 #include <array>
+#include <charconv>
 #include <sstream>
 
 #include <algorithm>
 #include <functional>
+#include <initializer_list>
+#include <memory>
+#include <unordered_map>
 
 #include <iostream>
+#include <limits>
+
+#include "arena.h"
+#include "classify.h"
+#include "config.h"
+#include "constraint.h"
+#include "diagnostic.h"
+#include "dump.h"
+#include "group.h"
+#include "help_text.h"
+#include "interpolate.h"
+#include "lazy.h"
+#include "quantity.h"
+#include "result.h"
+#include "spec_image.h"
+#include "stats.h"
+#include "suggest.h"
+#include "tokenize.h"
+#include "usage.h"
+#include "validator.h"
 
 namespace cmdline {
 namespace detail {
@@ -45,37 +69,124 @@ std::string get_argument_name(char, const char *);
 struct Option {
   char short_name;
   std::string long_name;
-  std::string help;
-  std::string argument_name;
+  detail::HelpText help;
+  detail::HelpText argument_name;
 
   bool takes_argument;
   size_t nargs;
   std::function<bool(const char **)> set_value;
+  std::vector<Validator> validators;
+  std::size_t list_value_size = 0; //< element size if values accumulate, 0 otherwise
+  std::size_t occurrences = 0;     //< in the current parse
+  std::function<bool(const char **)> check_value; //< converts without storing, empty for flags
+  detail::ValueAccess value_access;
+  std::uint32_t group = static_cast<std::uint32_t>(-1); //< index of the `OptionGroup', if any
+  bool optional_value = false; //< a flag that also takes an attached value, as in `--name=value' or `-nvalue'
 };
 
 
 struct Argument {
   std::string name;
-  std::string help;
+  detail::HelpText help;
   bool required;
 
   size_t nargs;
   std::function<bool(const char **)> set_value;
+  std::vector<Validator> validators;
+  std::function<bool(const char **)> check_value; //< converts without storing
+  detail::ValueAccess value_access;
+};
+
+
+class ParseSession;
+
+enum class LimitKind : std::uint8_t {
+  tokens,
+  total_bytes,
+  occurrences,
+  list_values,
+  arena_bytes,
+};
+
+/**
+ * Bounds for parsing untrusted input, each is unlimited by default.
+ * Exceeding one fails the parse with `ErrorCode::limit_exceeded'.
+ */
+struct Limits {
+  static constexpr std::size_t unlimited = std::numeric_limits<std::size_t>::max();
+
+  std::size_t max_tokens = unlimited;      //< argv elements after the program name
+  std::size_t max_total_bytes = unlimited; //< summed length of those elements
+  std::size_t max_occurrences = unlimited; //< times one option may be given
+  std::size_t max_list_values = unlimited; //< values in one vector option or the catch-all argument
+  /**
+   * Memory kept by vector options and the catch-all argument, estimated as
+   * the element size plus the length of the value, together with the
+   * string arena. The arena keeps its strings across parses, so a parser
+   * that handles many command lines clears `ArgumentParser::string_arena'
+   * once it no longer needs the values.
+   */
+  std::size_t max_arena_bytes = unlimited;
 };
 
 
 class ArgumentParser {
+  friend class ParseSession;
+  friend class OptionGroup;
+  friend class Getopt;
+  friend class ParseCache;
+  friend class UsageCounters;
+
 protected:
   std::vector<Option> m_options;
   std::vector<Argument> m_arguments;
   bool m_show_help { false }; //< output for the help option
-  std::stringstream m_ss; //< used for converting arguments
+  std::unique_ptr<std::stringstream> m_ss; //< used for converting arguments, created on first use
   std::vector<const char *> *m_unhandled { nullptr };
   std::string m_unhandled_name;
+  std::vector<detail::PendingValidation> m_pending_validation;
+  std::array<std::uint32_t, 256> m_short_index; //< option index by short name
+  std::size_t m_short_index_options { 0 };
+  mutable detail::SuggestionIndex m_suggestion_index; //< built on first use
+  mutable std::size_t m_suggestion_index_options { 0 };
+  ParseStats m_stats;
+  Diagnostic *m_diagnostics { nullptr };
+  std::size_t m_diagnostics_capacity { 0 };
+  std::size_t m_diagnostics_count { 0 };
+  std::size_t m_unhandled_count { 0 }; //< catch-all values in the current parse
+  std::size_t m_arena_bytes { 0 };
+  std::size_t m_argument_count { 0 }; //< positional arguments assigned in the current parse
+  std::vector<detail::Constraint> m_constraints;
+  detail::OptionSet m_present; //< options given in the last parse
+  ParseSession *m_session { nullptr }; //< receives conversions and errors instead, see `ParseSession'
+  std::vector<detail::Group> m_groups;
+  StringArena m_strings; //< values of `std::string_view' and `const char *' variables
+  const SpecImage *m_spec { nullptr };
+  std::unordered_map<std::uint32_t, std::function<bool(const char **)>> m_spec_bindings; //< by image index
+  std::vector<detail::SpecHit> m_spec_hits; //< in the current parse
+  std::vector<const char *> m_spec_values;
+  std::unordered_map<std::uint32_t, std::size_t> m_spec_occurrences; //< only counted with `max_occurrences' set
+  UsageCounters *m_usage { nullptr };
+  detail::HelpStore m_help; //< help text and argument names, only read by `usage'
+  std::vector<char> m_dump_buffer; //< for `write_config'
+  std::string m_dump_text; //< values of types without a dump of their own
+  std::vector<const char *> m_interpolated; //< expanded values of the option or argument being set
+  std::size_t m_failed_value { 0 }; //< value of the option or argument being set that failed to convert
+  bool m_arena_full { false }; //< it failed as the string arena reached `max_arena_bytes'
+  std::string m_interpolation_buffer;
+  std::vector<TokenClass> m_classes; //< a window of the argv elements `parse_args' is working on
+  std::size_t m_classes_begin { 0 }; //< argv index of the first element of the window
+  std::size_t m_classes_count { 0 };
+  /**
+   * Follow getopt where it differs: option values may start with `-', the
+   * last option of a group like `-xzf' may take a value, and flags given a
+   * value as in `--name=value' are an error.
+   */
+  bool m_getopt_syntax { false };
 
 public:
   /**
-   * Whether to show error messages.
+   * Whether to print error messages to stderr as they occur.
    */
   bool error_messages = true;
 
@@ -87,6 +198,67 @@ public:
    */
   bool abbreviations = false;
 
+  /**
+   * Whether to skip unknown options and surplus positional arguments
+   * instead of failing, for parsers that only know some of the options.
+   * A value of an unknown option is only skipped with it if attached, as in
+   * `--name=value' or `-xvalue'; otherwise it is taken as a positional
+   * argument.
+   */
+  bool ignore_unknown = false;
+
+  /**
+   * Maximum number of threads used to run I/O bound validators, 0 means one
+   * per hardware thread. The threads are started by each parse that has
+   * enough such checks to spread and joined before it returns, which costs
+   * about 10 microseconds per thread and parse; set this to 1 for a parser
+   * that handles many short command lines.
+   */
+  unsigned validation_threads = 0;
+
+  /**
+   * Resource limits enforced by `parse_args'.
+   */
+  Limits limits;
+
+  /**
+   * Number of argv elements from which `parse_args' classifies them in
+   * batches (see `classify_tokens') ahead of parsing, instead of inspecting
+   * each element as it goes. Off by default: the parser reads little of each
+   * element, so the extra pass over whole elements costs more than it saves
+   * in classify_benchmark.
+   */
+  std::size_t classify_min_tokens = Limits::unlimited;
+
+  /**
+   * Whether `Lazy' values are converted while parsing anyway, so invalid
+   * values fail the parse as for other types.
+   */
+  bool convert_lazy_values = false;
+
+  /**
+   * Whether to expand `${NAME}' and a leading `~' in the values of options
+   * and arguments, see `interpolate'. Expanded values are stored in the
+   * string arena, other values are used as they are.
+   * Variables read this way are not known to `ParseCache'.
+   */
+  bool interpolate_values = false;
+  std::size_t max_interpolation_depth = 8;         //< nesting of variables in the values of variables
+  std::size_t max_interpolated_length = 64 * 1024; //< length of one expanded value
+
+  /**
+   * Whether help strings outlive the parser, as string literals do, so they
+   * are kept by pointer instead of being copied. Argument names are always
+   * copied.
+   */
+  bool static_help = false;
+
+  /**
+   * Whether copied help text is compressed as it accumulates; it is only
+   * decoded by `usage'. Takes effect for options added after setting it.
+   */
+  bool compress_help = false;
+
   ArgumentParser();
 
   /**
@@ -127,10 +299,194 @@ public:
   void add_argument(std::vector<const char *> &value, const char *name = "");
 
 
+  /**
+   * @brief Adds a validator to the option with the given short name.
+   * Validators run after all arguments have been parsed.
+   */
+  bool add_validator(char short_name, Validator validator);
+  /**
+   * @brief Adds a validator to the option with the given long name, or the
+   * argument with the given name.
+   */
+  bool add_validator(const char *name, Validator validator);
+
+  /**
+   * @brief Constraints between options, checked after parsing unless help
+   * was requested.
+   * Options are named by their long name, optionally with the leading `--',
+   * or as `-x' by their short name. Returns false if a name is unknown.
+   */
+  bool require_options(std::initializer_list<const char *> names) {
+    return this->add_constraint(ConstraintKind::required, nullptr, names);
+  }
+  bool add_exclusive_group(std::initializer_list<const char *> names) {
+    return this->add_constraint(ConstraintKind::exclusive, nullptr, names);
+  }
+  bool add_at_least_one_group(std::initializer_list<const char *> names) {
+    return this->add_constraint(ConstraintKind::at_least_one, nullptr, names);
+  }
+  /**
+   * @brief If `option' is given, all of `required' must be given as well.
+   */
+  bool add_dependency(const char *option, std::initializer_list<const char *> required) {
+    return this->add_constraint(ConstraintKind::dependency, option, required);
+  }
+
+  /**
+   * @brief The arena holding the values converted into `std::string_view'
+   * and `const char *' variables, so they stay valid independent of argv.
+   * Values are kept for the lifetime of the parser, across parses, unless
+   * the arena is cleared; `Limits::max_arena_bytes' bounds its size.
+   * Enable interning on it to share the storage of repeated values.
+   */
+  StringArena & string_arena() { return m_strings; }
+
+  /**
+   * @brief Adds a named group of options, see `OptionGroup'.
+   * Returns a handle that is not valid if the name is empty, contains `.'
+   * or `=', starts with `-', or is already taken.
+   */
+  OptionGroup add_group(const char *name, const char *help = "");
+
+  /**
+   * @brief Looks up options that were not added with `add_option' in a
+   * prebuilt spec image, which has to outlive the parser.
+   * Values of image options are collected without conversion, see
+   * `spec_values', unless the option is bound to a variable with `bind'.
+   * Constraints, validators, sessions and `save_result' only cover the
+   * options added with `add_option'.
+   */
+  void use_spec(const SpecImage *image);
+
+  /**
+   * @brief Converts the values of an option from the spec image into
+   * `value', like `add_option' does.
+   * Returns false if there is no such option or its number of arguments
+   * does not fit the variable.
+   */
+  template<typename T>
+  bool bind(std::string_view long_name, T &value);
+  template<typename T>
+  bool bind(std::string_view long_name, std::vector<T> &value);
+  template<typename T, std::size_t N>
+  bool bind(std::string_view long_name, std::array<T, N> &value);
+
+  /**
+   * @brief Appends the values given for an option of the spec image in the
+   * last parse, `nargs' per occurrence, and returns the number of
+   * occurrences.
+   */
+  std::size_t spec_values(std::string_view long_name, std::vector<const char *> &values) const;
+
   /**
    * @brief Parses arguments.
    */
   bool parse_args(int argc, const char **argv, bool exit_on_failure = true);
+  /**
+   * @brief Splits `command' with `tokenize' and parses the words.
+   * `arena' receives the argv array, with `program_name' as the first
+   * element, and needs room for two more than the number of words. The words
+   * point into `command', which is modified and must outlive any stored
+   * `const char *' values.
+   */
+  bool parse_command_line(const char *program_name, char *command, const char **arena,
+                          std::size_t capacity, bool exit_on_failure = true);
+
+  /**
+   * @brief Finds the long option names closest to `name', best match first.
+   * Names that need more edits than a third of the length of `name' (rounded
+   * up), or more than three edits, are not considered similar.
+   */
+  std::vector<std::string_view> suggest(std::string_view name, std::size_t max_results = 3) const;
+
+  /**
+   * @brief Sets a buffer receiving a record of every error.
+   * The count is reset by each call to `parse_args'; errors beyond the
+   * capacity are counted but not stored.
+   */
+  void set_diagnostic_buffer(Diagnostic *buffer, std::size_t capacity);
+  /**
+   * @brief Number of errors since the last call to `parse_args', including
+   * those that did not fit into the buffer.
+   */
+  std::size_t diagnostic_count() const { return m_diagnostics_count; }
+  /**
+   * @brief Formats an error message like `snprintf'.
+   * `argv' must be the array the error was found in, or nullptr if it is no
+   * longer available.
+   * @return The length of the full message.
+   */
+  std::size_t format_diagnostic(const Diagnostic &d, const char *const *argv, char *buffer, std::size_t size) const;
+
+  /**
+   * @brief Statistics of the last call to `parse_args', only collected if
+   * the library is built with CMDLINE_INSTRUMENTATION.
+   */
+  ParseStats & stats() { return m_stats; }
+  const ParseStats & stats() const { return m_stats; }
+  /**
+   * @brief Writes the statistics as JSON or in the Chrome trace event format.
+   */
+  bool write_stats(FILE *file, StatsFormat format) const;
+
+  /**
+   * @brief Serializes the result of the last successful parse: which
+   * options were given and the values of all given options and arguments.
+   * The blob holds no pointers, so it can be written to a file or shared
+   * memory and loaded at any address by `load_result' of a parser set up
+   * the same way, in the same program.
+   * Values of trivially copyable types are stored as their bytes and
+   * strings in an arena; other types are stored as text and converted
+   * again when loading.
+   * Returns false if a value cannot be formatted.
+   */
+  bool save_result(std::vector<char> &blob);
+
+  /**
+   * @brief Loads a result written by `save_result', setting the bound
+   * variables as if the original command line was parsed.
+   * `const char *' and `std::string_view' values and the catch-all argument
+   * point into the blob, which has to outlive them; values of trivially
+   * copyable types and strings do not allocate beyond their own storage.
+   * Returns false if the blob is malformed or was written by a parser with
+   * different options or arguments; nothing is stored then, as the whole blob
+   * is checked first.
+   */
+  bool load_result(const void *data, std::size_t size);
+
+  /**
+   * @brief Writes a command line, without the program name, that parses to
+   * the current values: the given options in declaration order with the
+   * values they hold, followed by the positional arguments.
+   * Returns false if a value cannot be formatted or cannot be given on the
+   * command line (a value of a multi-value option or a positional argument
+   * that starts with `-').
+   */
+  bool canonical_args(std::vector<std::string> &args);
+
+  /**
+   * @brief Writes the name, type, source and current value of every option
+   * and argument, as JSON or in the binary format described by
+   * `DumpHeader'. The source is `argv' for what was given in the last parse
+   * and `default' otherwise; the parser reads no environment variables or
+   * configuration files of its own, so values expanded by
+   * `interpolate_values' and values restored by `load_result' count as
+   * `argv' too.
+   * Writes at most `size' bytes and returns the length of the full dump, so
+   * a buffer that is too small can be grown and the dump repeated.
+   */
+  std::size_t dump_config(char *buffer, std::size_t size, DumpFormat format);
+  /**
+   * @brief Writes the dump to a file descriptor with a single `write' call,
+   * building it in a buffer kept by the parser.
+   */
+  bool write_config(int fd, DumpFormat format);
+
+  /**
+   * @brief Counts the options used by each parse in `counters', which has
+   * to be open and outlive the parser; nullptr stops counting.
+   */
+  void set_usage_counters(UsageCounters *counters) { m_usage = counters; }
 
   /**
    * @brief Prints the usage text.
@@ -139,139 +495,636 @@ public:
 
 protected:
   static constexpr std::size_t npos = static_cast<std::size_t>(-1);
+  static constexpr std::uint32_t NO_OPTION = static_cast<std::uint32_t>(-1);
+  static constexpr std::uint32_t SPEC_OPTION = 0x80000000; //< set in ids of spec image options
+  static constexpr std::uint32_t NO_GROUP = static_cast<std::uint32_t>(-1);
 
   bool validate_option(char short_name, const char *long_name);
+  /**
+   * @brief Adds an option taking `nargs' values, 0 for a flag, stored by
+   * `set_value'; shared by the overloads of `add_option' and `RecordParser'.
+   * `list_value_size' is the element size of options accumulating values.
+   */
+  bool insert_option(char short_name, const char *long_name, const char *help, const char *argument_name,
+                     std::size_t nargs, std::function<bool(const char **)> set_value,
+                     std::function<bool(const char **)> check_value, detail::ValueAccess value_access,
+                     std::size_t list_value_size = 0);
+  bool insert_argument(const char *name, const char *help, bool required, std::size_t nargs,
+                       std::function<bool(const char **)> set_value,
+                       std::function<bool(const char **)> check_value, detail::ValueAccess value_access);
+
+  /**
+   * @brief Converts an argument using `parse_value' if there is an overload
+   * for `T', or the stringstream otherwise. `std::string_view' and
+   * `const char *' values are copied into the string arena.
+   */
+  template<typename T>
+  bool convert(const char *arg, T &value);
+  /**
+   * @brief Makes a function converting `N' values into temporaries, for
+   * checking values without storing them.
+   */
+  template<typename T, std::size_t N>
+  std::function<bool(const char **)> value_checker();
+  /**
+   * @brief Converts the values of an option or argument taking `N' values,
+   * recording the one that failed in `m_failed_value'.
+   */
+  template<typename T, std::size_t N>
+  bool convert_all(const char **args, std::array<T, N> &values);
+  template<typename T>
+  bool convert_append(const char *arg, std::vector<T> &values);
+
+  /**
+   * @brief Appends a value as text that `convert' turns back into the same
+   * value, using `format_value' if there is an overload for `T', or the
+   * stringstream otherwise.
+   * Returns false if the type cannot be written.
+   */
+  template<typename T>
+  bool format(const T &value, std::string &out);
+  template<typename T>
+  bool save_value(detail::BlobWriter &writer, const T &value);
+  template<typename T>
+  bool load_value(detail::BlobReader &reader, T &value);
+  template<typename T>
+  void dump_value(detail::DumpWriter &writer, const T &value);
+  /**
+   * @brief Save, load, format and dump a bound variable, element by element
+   * for vectors and arrays.
+   */
+  template<typename T>
+  bool save_variable(detail::BlobWriter &writer, const T &value);
+  template<typename T>
+  bool save_variable(detail::BlobWriter &writer, const std::vector<T> &values);
+  template<typename T, std::size_t N>
+  bool save_variable(detail::BlobWriter &writer, const std::array<T, N> &values);
+  template<typename T>
+  bool load_variable(detail::BlobReader &reader, T &value);
+  template<typename T>
+  bool load_variable(detail::BlobReader &reader, std::vector<T> &values);
+  template<typename T, std::size_t N>
+  bool load_variable(detail::BlobReader &reader, std::array<T, N> &values);
+  template<typename T>
+  bool format_variable(const T &value, std::vector<std::string> &texts);
+  template<typename T>
+  bool format_variable(const std::vector<T> &values, std::vector<std::string> &texts);
+  template<typename T, std::size_t N>
+  bool format_variable(const std::array<T, N> &values, std::vector<std::string> &texts);
+  template<typename T>
+  void dump_variable(detail::DumpWriter &writer, const T &value);
+  template<typename T>
+  void dump_variable(detail::DumpWriter &writer, const std::vector<T> &values);
+  template<typename T, std::size_t N>
+  void dump_variable(detail::DumpWriter &writer, const std::array<T, N> &values);
+  /**
+   * @brief Makes the functions saving, loading and formatting a bound
+   * variable, see `save_result' and `canonical_args'.
+   */
+  template<typename T>
+  detail::ValueAccess value_access(T &value);
+  std::uint32_t spec_hash() const;
+  /**
+   * @brief Keeps the help text of an option or argument, see `static_help'.
+   */
+  detail::HelpText help_text(const char *help);
+  detail::HelpText argument_text(char short_name, const char *long_name, const char *argument_name);
 
   std::size_t option_index(char short_name);
   std::size_t option_index(const std::string_view long_name);
+  /**
+   * @brief Like `option_index', falling back to the spec image.
+   */
+  std::size_t find_option(char short_name);
+  std::size_t option_nargs(std::size_t id) const;
+  bool takes_optional_value(std::size_t id) const;
+  std::stringstream & string_stream();
+
+  void report(const char *const *argv, const Diagnostic &d);
 
+  bool check_limit(const char **argv, LimitKind kind, std::size_t value, std::size_t limit, int argv_index,
+                   std::uint32_t id = 0, std::uint32_t offset = 0);
+  bool check_total_bytes(int argc, const char **argv);
+  /**
+   * @brief Whether `str' can be stored in the string arena without exceeding
+   * `max_arena_bytes'; sets `m_arena_full' if not.
+   */
+  bool fits_arena(const char *str);
+  bool option_group(std::initializer_list<const char *> names, detail::OptionSet &group);
+  bool add_constraint(ConstraintKind kind, const char *option, std::initializer_list<const char *> names);
+  bool check_constraints(const char **argv);
+  bool check_constraints(const char **argv, const detail::OptionSet &present);
+  bool check_required_arguments(const char **argv, std::size_t argind);
+  bool set_option(const char **argv, std::size_t index, const char **args, int value_index, std::uint32_t value_offset);
+  bool set_spec_option(const char **argv, std::size_t index, const char **args, int value_index, std::uint32_t value_offset);
+  bool set_argument(const char **argv, std::size_t index, const char **args, int argv_index);
+  /**
+   * @brief With `interpolate_values', points `args' at the expanded values.
+   */
+  bool interpolate_args(const char **argv, const char **&args, std::size_t nargs, int argv_index,
+                        std::uint32_t value_offset, std::uint32_t id);
+  bool run_validators(const char **argv);
+  void dispatch_groups();
+
+  /**
+   * @brief Resets the state of the previous parse.
+   */
+  void begin_parse();
+  /**
+   * @brief Parses the option, `--' or positional argument at `argv[i]', leaving
+   * `i' at the last element it consumed.
+   */
+  bool parse_item(int argc, const char **argv, int &i, std::size_t &argind, bool &terminate_options);
   bool parse_long_option(int, const char **, int &);
   bool parse_short_option(int, const char **, int &);
+  const TokenClass * token_class(std::size_t i) const {
+    const std::size_t k = i - m_classes_begin;
+    return k < m_classes_count ? &m_classes[k] : nullptr;
+  }
+  bool starts_with_dash(const char **argv, std::size_t i) const {
+    const TokenClass *c = this->token_class(i);
+    return c != nullptr ? c->starts_with_dash() : argv[i][0] == '-';
+  }
   bool parse_argument(int, const char **, int &, std::size_t &);
 };
 
 ///////////////////////////////////////////////////////////////////////////
 // Implementations of template functions
 
+namespace detail {
+
+/**
+ * @brief Converts using `parse_value' if there is an overload for `T', or
+ * `ss' otherwise.
+ */
 template<typename T>
-bool ArgumentParser::add_option(T &value, const char *help, char short_name, const char *long_name, const char *argument_name) {
-  if (!this->validate_option(short_name, long_name)) {
-    return false;
+bool convert_text(const char *text, T &value, std::stringstream &ss) {
+  if constexpr (requires { parse_value(text, value); }) {
+    return parse_value(text, value);
   }
-  m_options.emplace_back(
-    short_name,
-    long_name,
-    help,
-    argument_name ? argument_name : std::move(detail::get_argument_name(short_name, long_name)),
-    true,
-    1,
-    [&](const char **arg) -> bool {
-      m_ss.clear();
-      m_ss.rdbuf()->str(*arg);
-      m_ss >> value;
-      return m_ss.rdbuf()->in_avail() == 0;
+  else {
+    ss.clear();
+    ss.rdbuf()->str(text);
+    ss >> value;
+    return ss.rdbuf()->in_avail() == 0;
+  }
+}
+
+template<typename T>
+bool convert_text(const char *text, T &value) {
+  if constexpr (requires { parse_value(text, value); }) {
+    return parse_value(text, value);
+  }
+  else {
+    // The parser, and its stream, may be gone by the time a value is read
+    thread_local std::stringstream ss;
+    return convert_text(text, value, ss);
+  }
+}
+
+}
+
+template<typename T>
+bool ArgumentParser::convert(const char *arg, T &value) {
+  if constexpr (detail::is_lazy<T>::value) {
+    value.assign(arg);
+    return !convert_lazy_values or value.valid();
+  }
+  else if constexpr (std::is_same_v<T, std::string_view>) {
+    if (!this->fits_arena(arg)) {
+      return false;
+    }
+    value = m_strings.store(arg);
+    return true;
+  }
+  else if constexpr (std::is_same_v<T, const char *>) {
+    if (!this->fits_arena(arg)) {
+      return false;
+    }
+    value = m_strings.store(arg).data();
+    return true;
+  }
+  else {
+    return detail::convert_text(arg, value, this->string_stream());
+  }
+}
+
+template<typename T, std::size_t N>
+std::function<bool(const char **)> ArgumentParser::value_checker() {
+  if constexpr (std::is_same_v<T, std::string_view> or std::is_same_v<T, const char *>) {
+    // Always converts, and checking should not fill the arena
+    return [](const char **) -> bool { return true; };
+  }
+  else {
+    return [this](const char **args) -> bool {
+      for (std::size_t i = 0; i < N; ++i) {
+        T t {};
+        if (!this->convert(args[i], t)) {
+          m_failed_value = i;
+          return false;
+        }
+      }
+      return true;
+    };
+  }
+}
+
+template<typename T, std::size_t N>
+bool ArgumentParser::convert_all(const char **args, std::array<T, N> &values) {
+  for (std::size_t i = 0; i < N; ++i) {
+    if (!this->convert(args[i], values[i])) {
+      m_failed_value = i;
+      return false;
     }
-  );
+  }
   return true;
 }
 
 template<typename T>
-bool ArgumentParser::add_option(std::vector<T> &value, const char *help, char short_name, const char *long_name, const char *argument_name) {
-  if (!this->validate_option(short_name, long_name)) {
+bool ArgumentParser::convert_append(const char *arg, std::vector<T> &values) {
+  T t;
+  if (!this->convert(arg, t)) {
     return false;
   }
-  m_options.emplace_back(
-    short_name,
-    long_name,
-    help,
-    argument_name ? argument_name : std::move(detail::get_argument_name(short_name, long_name)),
-    true,
-    1,
-    [&](const char **arg) -> bool {
-      T t;
-      m_ss.clear();
-      m_ss.rdbuf()->str(*arg);
-      m_ss >> t;
-      value.push_back(t);
-      return m_ss.rdbuf()->in_avail() == 0;
-    }
-  );
+  values.push_back(std::move(t));
   return true;
 }
 
-template<typename T, std::size_t N>
-bool ArgumentParser::add_option(std::array<T, N> &value, const char *help, char short_name, const char *long_name, const char *argument_name) {
-  if (!this->validate_option(short_name, long_name)) {
+template<typename T>
+bool ArgumentParser::format(const T &value, std::string &out) {
+  if constexpr (detail::is_lazy<T>::value) {
+    if (value.text() != nullptr) {
+      out += value.text();
+      return true;
+    }
+    return this->format(*value, out);
+  }
+  else if constexpr (requires { format_value(value, out); }) {
+    format_value(value, out);
+    return true;
+  }
+  else if constexpr (std::is_same_v<T, std::string> or std::is_same_v<T, std::string_view>) {
+    out += value;
+    return true;
+  }
+  else if constexpr (std::is_same_v<T, const char *>) {
+    out += value ? value : "";
+    return true;
+  }
+  else if constexpr (std::is_arithmetic_v<T> and !std::is_same_v<T, char> and !std::is_same_v<T, bool>) {
+    // Shortest representation that reads back as the same value
+    char buffer[64];
+    const auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+    out.append(buffer, result.ptr);
+    return true;
+  }
+  else if constexpr (requires (std::ostream &os) { os << value; }) {
+    std::stringstream &ss = this->string_stream();
+    ss.clear();
+    ss.str("");
+    ss << value;
+    out += ss.str();
+    return !ss.fail();
+  }
+  else {
     return false;
   }
-  m_options.emplace_back(
-    short_name,
-    long_name,
-    help,
-    argument_name ? argument_name : std::move(detail::get_argument_name(short_name, long_name)),
-    true,
-    N,
-    [&](const char **args) -> bool {
-      for (unsigned int i = 0; i < N; ++i) {
-        m_ss.clear();
-        m_ss.rdbuf()->str(args[i]);
-        m_ss >> value[i];
-        if (m_ss.rdbuf()->in_avail() != 0)
-          return false;
-      }
+}
+
+template<typename T>
+bool ArgumentParser::save_value(detail::BlobWriter &writer, const T &value) {
+  if constexpr (std::is_same_v<T, std::string> or std::is_same_v<T, std::string_view>) {
+    writer.write_string(value);
+    return true;
+  }
+  else if constexpr (std::is_same_v<T, const char *>) {
+    writer.write_string(value ? value : "");
+    return true;
+  }
+  else if constexpr (std::is_trivially_copyable_v<T> and !std::is_pointer_v<T> and !detail::is_lazy<T>::value) {
+    writer.write(value);
+    return true;
+  }
+  else {
+    std::string text;
+    if (!this->format(value, text)) {
+      return false;
+    }
+    writer.write_string(text);
+    return true;
+  }
+}
+
+template<typename T>
+bool ArgumentParser::load_value(detail::BlobReader &reader, T &value) {
+  if constexpr (std::is_trivially_copyable_v<T> and !std::is_pointer_v<T>
+                and !std::is_same_v<T, std::string_view> and !detail::is_lazy<T>::value) {
+    return reader.read(value);
+  }
+  else {
+    const char *str;
+    std::size_t length;
+    if (!reader.read_string(str, length)) {
+      return false;
+    }
+    if constexpr (std::is_same_v<T, std::string> or std::is_same_v<T, std::string_view>) {
+      value = T(str, length);
       return true;
     }
-  );
+    else if constexpr (std::is_same_v<T, const char *>) {
+      value = str;
+      return true;
+    }
+    else {
+      return this->convert(str, value);
+    }
+  }
+}
+
+template<typename T>
+void ArgumentParser::dump_value(detail::DumpWriter &writer, const T &value) {
+  constexpr DumpType type = detail::dump_type<T>();
+  if constexpr (type == DumpType::boolean) {
+    writer.boolean(value);
+  }
+  else if constexpr (type == DumpType::integer) {
+    writer.integer(value);
+  }
+  else if constexpr (type == DumpType::unsigned_integer) {
+    writer.unsigned_integer(value);
+  }
+  else if constexpr (type == DumpType::number) {
+    writer.number(static_cast<double>(value));
+  }
+  else if constexpr (std::is_same_v<T, std::string> or std::is_same_v<T, std::string_view>) {
+    writer.string(value);
+  }
+  else if constexpr (std::is_same_v<T, const char *>) {
+    writer.string(value ? value : "");
+  }
+  else {
+    m_dump_text.clear();
+    this->format(value, m_dump_text);
+    writer.string(m_dump_text);
+  }
+}
+
+template<typename T>
+bool ArgumentParser::save_variable(detail::BlobWriter &writer, const T &value) {
+  return this->save_value(writer, value);
+}
+
+template<typename T>
+bool ArgumentParser::save_variable(detail::BlobWriter &writer, const std::vector<T> &values) {
+  writer.write(static_cast<std::uint32_t>(values.size()));
+  for (const T &value : values) {
+    if (!this->save_value(writer, value)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+template<typename T, std::size_t N>
+bool ArgumentParser::save_variable(detail::BlobWriter &writer, const std::array<T, N> &values) {
+  for (const T &value : values) {
+    if (!this->save_value(writer, value)) {
+      return false;
+    }
+  }
   return true;
 }
 
 template<typename T>
-bool ArgumentParser::add_argument(T &value, const char *help, const char *name, bool required) {
-  if (m_arguments.size() > 0 and required and !m_arguments.back().required) {
-    std::fprintf(stderr, "required argument `%s' cannot follow optional arguments",
-      name);
+bool ArgumentParser::load_variable(detail::BlobReader &reader, T &value) {
+  return this->load_value(reader, value);
+}
+
+template<typename T>
+bool ArgumentParser::load_variable(detail::BlobReader &reader, std::vector<T> &values) {
+  std::uint32_t count;
+  if (!reader.read(count) or count > reader.remaining()) {
     return false;
   }
-  m_arguments.emplace_back(
-    name,
-    help,
-    required,
-    1,
-    [&](const char **arg) -> bool {
-      m_ss.clear();
-      m_ss.rdbuf()->str(*arg);
-      m_ss >> value;
-      return m_ss.rdbuf()->in_avail() == 0;
+  values.clear();
+  values.reserve(count);
+  for (std::uint32_t i = 0; i < count; ++i) {
+    if (!this->load_value(reader, values.emplace_back())) {
+      return false;
     }
-  );
+  }
   return true;
 }
 
 template<typename T, std::size_t N>
-bool ArgumentParser::add_argument(std::array<T, N> &value, const char *help, const char *name, bool required) {
-  if (m_arguments.size() > 0 and required and !m_arguments.back().required) {
-    std::fprintf(stderr, "required argument `%s' cannot follow optional arguments",
-      name);
+bool ArgumentParser::load_variable(detail::BlobReader &reader, std::array<T, N> &values) {
+  for (T &value : values) {
+    if (!this->load_value(reader, value)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+template<typename T>
+bool ArgumentParser::format_variable(const T &value, std::vector<std::string> &texts) {
+  return this->format(value, texts.emplace_back());
+}
+
+template<typename T>
+bool ArgumentParser::format_variable(const std::vector<T> &values, std::vector<std::string> &texts) {
+  for (const T &value : values) {
+    if (!this->format(value, texts.emplace_back())) {
+      return false;
+    }
+  }
+  return true;
+}
+
+template<typename T, std::size_t N>
+bool ArgumentParser::format_variable(const std::array<T, N> &values, std::vector<std::string> &texts) {
+  for (const T &value : values) {
+    if (!this->format(value, texts.emplace_back())) {
+      return false;
+    }
+  }
+  return true;
+}
+
+template<typename T>
+void ArgumentParser::dump_variable(detail::DumpWriter &writer, const T &value) {
+  this->dump_value(writer, value);
+}
+
+template<typename T>
+void ArgumentParser::dump_variable(detail::DumpWriter &writer, const std::vector<T> &values) {
+  writer.begin_list(values.size());
+  for (const T &value : values) {
+    this->dump_value(writer, value);
+  }
+  writer.end_list();
+}
+
+template<typename T, std::size_t N>
+void ArgumentParser::dump_variable(detail::DumpWriter &writer, const std::array<T, N> &values) {
+  writer.begin_list(values.size());
+  for (const T &value : values) {
+    this->dump_value(writer, value);
+  }
+  writer.end_list();
+}
+
+template<typename T>
+detail::ValueAccess ArgumentParser::value_access(T &value) {
+  return {
+    [this, &value](detail::BlobWriter &writer) { return this->save_variable(writer, value); },
+    [this, &value](detail::BlobReader &reader) { return this->load_variable(reader, value); },
+    [this, &value](std::vector<std::string> &texts) { return this->format_variable(value, texts); },
+    detail::type_hash<T>(),
+    [this, &value](detail::DumpWriter &writer) { this->dump_variable(writer, value); },
+    detail::DumpTraits<T>::type,
+    detail::DumpTraits<T>::list,
+    [this](detail::BlobReader &reader) {
+      T value {};
+      return this->load_variable(reader, value);
+    }
+  };
+}
+
+template<typename T>
+bool ArgumentParser::bind(std::string_view long_name, T &value) {
+  const std::size_t index = m_spec ? m_spec->find(long_name) : SpecImage::npos;
+  if (index == SpecImage::npos) {
     return false;
   }
-  m_arguments.emplace_back(
-    name,
-    help,
-    required,
-    N,
-    [&](const char **args) -> bool {
-      for (unsigned int i = 0; i < N; ++i) {
-        m_ss.clear();
-        m_ss.rdbuf()->str(args[i]);
-        m_ss >> value[i];
-        if (m_ss.rdbuf()->in_avail() != 0)
-          return false;
-      }
+  const std::size_t nargs = m_spec->option(index).nargs;
+  if constexpr (std::is_same_v<T, bool>) {
+    if (nargs != 0) {
+      return false;
+    }
+    m_spec_bindings[static_cast<std::uint32_t>(index)] = [&value](const char **) -> bool {
+      value = true;
       return true;
+    };
+  }
+  else {
+    if (nargs != 1) {
+      return false;
     }
-  );
+    m_spec_bindings[static_cast<std::uint32_t>(index)] = [this, &value](const char **args) -> bool {
+      return this->convert(*args, value);
+    };
+  }
   return true;
 }
 
+template<typename T>
+bool ArgumentParser::bind(std::string_view long_name, std::vector<T> &value) {
+  const std::size_t index = m_spec ? m_spec->find(long_name) : SpecImage::npos;
+  if (index == SpecImage::npos or m_spec->option(index).nargs != 1) {
+    return false;
+  }
+  m_spec_bindings[static_cast<std::uint32_t>(index)] = [this, &value](const char **args) -> bool {
+    return this->convert_append(*args, value);
+  };
+  return true;
 }
 
+template<typename T, std::size_t N>
+bool ArgumentParser::bind(std::string_view long_name, std::array<T, N> &value) {
+  const std::size_t index = m_spec ? m_spec->find(long_name) : SpecImage::npos;
+  if (index == SpecImage::npos or m_spec->option(index).nargs != N) {
+    return false;
+  }
+  m_spec_bindings[static_cast<std::uint32_t>(index)] = [this, &value](const char **args) -> bool {
+    return this->convert_all(args, value);
+  };
+  return true;
+}
+
+template<typename T>
+bool OptionGroup::add_option(T &value, const char *help, char short_name, const char *long_name, const char *argument_name) {
+  if (m_parser == nullptr) {
+    return false;
+  }
+  const std::string qualified = this->qualified_name(long_name);
+  const std::string default_argument_name = argument_name ? "" : detail::get_argument_name(short_name, long_name);
+  if (!m_parser->add_option(value, help, short_name, qualified.c_str(),
+                            argument_name ? argument_name : default_argument_name.c_str())) {
+    return false;
+  }
+  this->mark_last_option();
+  return true;
+}
+
+template<typename T>
+bool ArgumentParser::add_option(T &value, const char *help, char short_name, const char *long_name, const char *argument_name) {
+  return this->insert_option(short_name, long_name, help, argument_name, 1,
+    [&](const char **arg) -> bool {
+      return this->convert(*arg, value);
+    },
+    this->value_checker<T, 1>(), this->value_access(value));
+}
+
+template<typename T>
+bool ArgumentParser::add_option(std::vector<T> &value, const char *help, char short_name, const char *long_name, const char *argument_name) {
+  return this->insert_option(short_name, long_name, help, argument_name, 1,
+    [&](const char **arg) -> bool {
+      return this->convert_append(*arg, value);
+    },
+    this->value_checker<T, 1>(), this->value_access(value), sizeof(T));
+}
+
+template<typename T, std::size_t N>
+bool ArgumentParser::add_option(std::array<T, N> &value, const char *help, char short_name, const char *long_name, const char *argument_name) {
+  return this->insert_option(short_name, long_name, help, argument_name, N,
+    [&](const char **args) -> bool {
+      return this->convert_all(args, value);
+    },
+    this->value_checker<T, N>(), this->value_access(value));
+}
+
+template<typename T>
+bool ArgumentParser::add_argument(T &value, const char *help, const char *name, bool required) {
+  return this->insert_argument(name, help, required, 1,
+    [&](const char **arg) -> bool {
+      return this->convert(*arg, value);
+    },
+    this->value_checker<T, 1>(), this->value_access(value));
+}
+
+template<typename T, std::size_t N>
+bool ArgumentParser::add_argument(std::array<T, N> &value, const char *help, const char *name, bool required) {
+  return this->insert_argument(name, help, required, N,
+    [&](const char **args) -> bool {
+      return this->convert_all(args, value);
+    },
+    this->value_checker<T, N>(), this->value_access(value));
+}
+
+}
+
+#include "parse_cache.h"
+#include "record.h"
+#include "session.h"
+
+#ifdef CMDLINE_HEADER_ONLY
+#include "arena-inl.h"
+#include "classify-inl.h"
+#include "cmdline-inl.h"
+#include "constraint-inl.h"
+#include "dump-inl.h"
+#include "group-inl.h"
+#include "help_text-inl.h"
+#include "interpolate-inl.h"
+#include "parse_cache-inl.h"
+#include "quantity-inl.h"
+#include "result-inl.h"
+#include "session-inl.h"
+#include "spec_image-inl.h"
+#include "stats-inl.h"
+#include "suggest-inl.h"
+#include "tokenize-inl.h"
+#include "usage-inl.h"
+#include "validator-inl.h"
+#endif
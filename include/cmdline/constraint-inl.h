@@ -0,0 +1,140 @@
+/*
+Copyright (c) 2020 Jakob Mohrbacher
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#pragma once
+
+#include "config.h"
+#include "cmdline.h"
+
+namespace cmdline {
+namespace detail {
+
+CMDLINE_INLINE void OptionSet::insert(std::size_t index) {
+  if (index / 64 >= m_words.size()) {
+    m_words.resize(index / 64 + 1, 0);
+  }
+  m_words[index / 64] |= std::uint64_t(1) << (index % 64);
+}
+
+CMDLINE_INLINE bool OptionSet::contains(std::size_t index) const {
+  return index / 64 < m_words.size() and (m_words[index / 64] >> (index % 64)) & 1;
+}
+
+CMDLINE_INLINE std::size_t OptionSet::size() const {
+  std::size_t count = 0;
+  for (const std::uint64_t word : m_words) {
+    count += static_cast<std::size_t>(std::popcount(word));
+  }
+  return count;
+}
+
+CMDLINE_INLINE std::size_t OptionSet::count_common(const OptionSet &other) const {
+  const std::size_t n = std::min(m_words.size(), other.m_words.size());
+  std::size_t count = 0;
+  for (std::size_t w = 0; w < n; ++w) {
+    count += static_cast<std::size_t>(std::popcount(m_words[w] & other.m_words[w]));
+  }
+  return count;
+}
+
+CMDLINE_INLINE bool OptionSet::is_subset_of(const OptionSet &other) const {
+  for (std::size_t w = 0; w < m_words.size(); ++w) {
+    const std::uint64_t theirs = w < other.m_words.size() ? other.m_words[w] : 0;
+    if (m_words[w] & ~theirs) {
+      return false;
+    }
+  }
+  return true;
+}
+
+CMDLINE_INLINE bool is_satisfied(const Constraint &constraint, const OptionSet &present) {
+  switch (constraint.kind) {
+  case ConstraintKind::required:
+    return constraint.group.is_subset_of(present);
+  case ConstraintKind::exclusive:
+    return constraint.group.count_common(present) <= 1;
+  case ConstraintKind::at_least_one:
+    return constraint.group.count_common(present) != 0;
+  case ConstraintKind::dependency:
+    return !present.contains(constraint.option) or constraint.group.is_subset_of(present);
+  }
+  return true;
+}
+
+}
+
+CMDLINE_INLINE bool ArgumentParser::option_group(std::initializer_list<const char *> names, detail::OptionSet &group) {
+  group.clear(m_options.size());
+  for (const char *name : names) {
+    std::size_t index;
+    if (name[0] == '-' and name[1] != '-' and name[1] != '\0' and name[2] == '\0') {
+      index = this->option_index(name[1]);
+    }
+    else {
+      index = this->option_index(std::string_view(name[0] == '-' and name[1] == '-' ? name + 2 : name));
+    }
+    if (index == npos) {
+      return false;
+    }
+    group.insert(index);
+  }
+  return names.size() != 0;
+}
+
+CMDLINE_INLINE bool ArgumentParser::add_constraint(ConstraintKind kind, const char *option, std::initializer_list<const char *> names) {
+  detail::Constraint constraint { kind, 0, {} };
+  if (option != nullptr) {
+    detail::OptionSet dependent;
+    if (!this->option_group({ option }, dependent)) {
+      return false;
+    }
+    dependent.for_each([&](std::size_t index) { constraint.option = static_cast<std::uint32_t>(index); });
+  }
+  if (!this->option_group(names, constraint.group)) {
+    return false;
+  }
+  m_constraints.push_back(std::move(constraint));
+  return true;
+}
+
+CMDLINE_INLINE bool ArgumentParser::check_constraints(const char **argv) {
+  m_present.clear(m_options.size());
+  for (std::size_t i = 0; i < m_options.size(); ++i) {
+    if (m_options[i].occurrences != 0) {
+      m_present.insert(i);
+    }
+  }
+  return this->check_constraints(argv, m_present);
+}
+
+CMDLINE_INLINE bool ArgumentParser::check_constraints(const char **argv, const detail::OptionSet &present) {
+  bool all_ok = true;
+  for (std::size_t i = 0; i < m_constraints.size(); ++i) {
+    if (!detail::is_satisfied(m_constraints[i], present)) {
+      all_ok = false;
+      this->report(argv, { ErrorCode::constraint_violated,
+        static_cast<std::uint16_t>(m_constraints[i].kind), -1, static_cast<std::uint32_t>(i), 0 });
+    }
+  }
+  return all_ok;
+}
+
+}
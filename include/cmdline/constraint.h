@@ -0,0 +1,85 @@
+/*
+Copyright (c) 2020 Jakob Mohrbacher
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#pragma once
+
+#include <cstdint>
+
+#include <bit>
+#include <vector>
+
+namespace cmdline {
+
+enum class ConstraintKind : std::uint8_t {
+  required,     //< every option of the group must be given
+  exclusive,    //< at most one option of the group may be given
+  at_least_one, //< at least one option of the group must be given
+  dependency,   //< if `option' is given, every option of the group must be given
+};
+
+namespace detail {
+
+/**
+ * A set of option indices, one bit per option.
+ */
+class OptionSet {
+  std::vector<std::uint64_t> m_words;
+
+public:
+  void clear(std::size_t options) { m_words.assign((options + 63) / 64, 0); }
+  void insert(std::size_t index);
+  bool contains(std::size_t index) const;
+  std::size_t size() const;
+
+  /**
+   * @brief Number of options in both sets.
+   */
+  std::size_t count_common(const OptionSet &other) const;
+  /**
+   * @brief Whether every option of this set is also in `other'.
+   */
+  bool is_subset_of(const OptionSet &other) const;
+
+  template<typename F>
+  void for_each(F &&f) const {
+    for (std::size_t w = 0; w < m_words.size(); ++w) {
+      for (std::uint64_t word = m_words[w]; word; word &= word - 1) {
+        f(w * 64 + static_cast<std::size_t>(std::countr_zero(word)));
+      }
+    }
+  }
+};
+
+struct Constraint {
+  ConstraintKind kind;
+  std::uint32_t option; //< the dependent option of a `dependency'
+  OptionSet group;
+};
+
+/**
+ * @brief Checks a constraint against the set of given options, looking at
+ * one word per 64 options.
+ */
+bool is_satisfied(const Constraint &constraint, const OptionSet &present);
+
+}
+
+}
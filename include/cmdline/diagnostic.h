@@ -0,0 +1,68 @@
+/*
+Copyright (c) 2020 Jakob Mohrbacher
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#pragma once
+
+#include <cstdint>
+
+namespace cmdline {
+
+enum class ErrorCode : std::uint8_t {
+  duplicate_option,           //< id: existing option, detail: short name or 0
+  required_after_optional,    //< id: the optional argument
+  ambiguous_option,
+  unrecognized_option,        //< offset: start of the name
+  invalid_option,             //< offset: the option character
+  option_missing_argument,    //< id: option, detail: 1 if given by long name
+  option_invalid_argument,    //< id: option, argv_index/offset: the value
+  option_validation_failed,   //< id: option, detail: validator index
+  unrecognized_argument,
+  argument_missing_value,     //< id: argument
+  argument_invalid_value,     //< id: argument
+  argument_validation_failed, //< id: argument, detail: validator index
+  argument_required,          //< id: argument
+  invalid_command_line,       //< detail: `TokenizeStatus', offset: in the command string
+  limit_exceeded,             //< detail: `LimitKind', id: option for per option limits
+  constraint_violated,        //< detail: `ConstraintKind', id: constraint
+  duplicate_group,            //< id: existing group
+  option_unexpected_argument, //< id: option, offset: the value
+  interpolation_failed,       //< detail: `InterpolateStatus', id: option or argument, offset: in the value
+};
+
+/**
+ * A single error, recorded without any formatting.
+ *
+ * `argv_index' and `offset' locate the offending text, `argv[argv_index] +
+ * offset'; `argv_index' is -1 for errors not caused by the arguments, like
+ * duplicate options. Use `ArgumentParser::format_diagnostic' to get the
+ * message.
+ */
+struct Diagnostic {
+  ErrorCode code;
+  std::uint16_t detail;
+  std::int32_t argv_index;
+  std::uint32_t id;
+  std::uint32_t offset;
+
+  friend bool operator==(const Diagnostic &, const Diagnostic &) = default;
+};
+
+}
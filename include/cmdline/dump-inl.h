@@ -0,0 +1,283 @@
+/*
+Copyright (c) 2020 Jakob Mohrbacher
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#pragma once
+
+#include "config.h"
+#include "cmdline.h"
+
+#include <unistd.h>
+
+#include <cerrno>
+#include <charconv>
+#include <cmath>
+
+namespace cmdline {
+namespace detail {
+
+CMDLINE_INLINE const char * dump_type_name(DumpType type) {
+  switch (type) {
+  case DumpType::none: return "none";
+  case DumpType::boolean: return "boolean";
+  case DumpType::integer: return "integer";
+  case DumpType::unsigned_integer: return "unsigned";
+  case DumpType::number: return "number";
+  case DumpType::string: return "string";
+  }
+  return "";
+}
+
+/**
+ * @brief Appends `str' escaped for a JSON string, without the quotes.
+ */
+CMDLINE_INLINE void append_escaped(DumpWriter &writer, std::string_view str) {
+  static const char hex[] = "0123456789abcdef";
+  const char *run = str.data();
+  const char *const end = str.data() + str.size();
+  for (const char *p = run; p != end; ++p) {
+    const unsigned char c = static_cast<unsigned char>(*p);
+    if (c >= 0x20 and c != '"' and c != '\\') {
+      continue;
+    }
+    writer.append(run, static_cast<std::size_t>(p - run));
+    run = p + 1;
+    switch (c) {
+    case '"': writer.append("\\\""); break;
+    case '\\': writer.append("\\\\"); break;
+    case '\n': writer.append("\\n"); break;
+    case '\t': writer.append("\\t"); break;
+    case '\r': writer.append("\\r"); break;
+    default: {
+      const char escape[] = { '\\', 'u', '0', '0', hex[c >> 4], hex[c & 15] };
+      writer.append(escape, sizeof(escape));
+    }
+    }
+  }
+  writer.append(run, static_cast<std::size_t>(end - run));
+}
+
+CMDLINE_INLINE void DumpWriter::string_literal(std::string_view str) {
+  if (m_format == DumpFormat::json) {
+    this->append('"');
+    append_escaped(*this, str);
+    this->append('"');
+  }
+  else {
+    this->write(static_cast<std::uint32_t>(str.size()));
+    this->append(str);
+  }
+}
+
+CMDLINE_INLINE void DumpWriter::begin_list(std::size_t count) {
+  if (m_format == DumpFormat::json) {
+    this->separate();
+    this->append('[');
+    m_first = true;
+  }
+  else {
+    this->write(static_cast<std::uint32_t>(count));
+  }
+}
+
+CMDLINE_INLINE void DumpWriter::end_list() {
+  if (m_format == DumpFormat::json) {
+    this->append(']');
+  }
+}
+
+CMDLINE_INLINE void DumpWriter::boolean(bool value) {
+  if (m_format == DumpFormat::json) {
+    this->separate();
+    this->append(value ? std::string_view("true") : std::string_view("false"));
+  }
+  else {
+    this->write(static_cast<std::uint8_t>(value));
+  }
+}
+
+CMDLINE_INLINE void DumpWriter::integer(std::int64_t value) {
+  if (m_format == DumpFormat::json) {
+    this->separate();
+    char buffer[24];
+    const auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+    this->append(buffer, static_cast<std::size_t>(result.ptr - buffer));
+  }
+  else {
+    this->write(value);
+  }
+}
+
+CMDLINE_INLINE void DumpWriter::unsigned_integer(std::uint64_t value) {
+  if (m_format == DumpFormat::json) {
+    this->separate();
+    char buffer[24];
+    const auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+    this->append(buffer, static_cast<std::size_t>(result.ptr - buffer));
+  }
+  else {
+    this->write(value);
+  }
+}
+
+CMDLINE_INLINE void DumpWriter::number(double value) {
+  if (m_format == DumpFormat::json) {
+    this->separate();
+    // JSON has no infinity or NaN
+    if (!std::isfinite(value)) {
+      this->append("null");
+      return;
+    }
+    char buffer[32];
+    const auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+    this->append(buffer, static_cast<std::size_t>(result.ptr - buffer));
+  }
+  else {
+    this->write(value);
+  }
+}
+
+CMDLINE_INLINE void DumpWriter::string(std::string_view value) {
+  if (m_format == DumpFormat::json) {
+    this->separate();
+  }
+  this->string_literal(value);
+}
+
+/**
+ * @brief Writes one option or argument; the value is written by `write_value'.
+ */
+template<typename WriteValue>
+void dump_entry(DumpWriter &writer, bool first, DumpEntryKind kind, std::string_view prefix, std::string_view name,
+                DumpSource source, DumpType type, bool list, WriteValue write_value) {
+  if (writer.format() == DumpFormat::binary) {
+    writer.write(DumpEntry { kind, source, type, static_cast<std::uint8_t>(list),
+      static_cast<std::uint32_t>(prefix.size() + name.size()) });
+    writer.append(prefix);
+    writer.append(name);
+    write_value();
+    return;
+  }
+  writer.append(first ? std::string_view("{\"name\":\"") : std::string_view(",{\"name\":\""));
+  writer.append(prefix);
+  append_escaped(writer, name);
+  writer.append("\",\"type\":\"");
+  writer.append(dump_type_name(type));
+  if (list) {
+    writer.append("[]");
+  }
+  writer.append(source == DumpSource::argv ? std::string_view("\",\"source\":\"argv\",\"value\":")
+                                           : std::string_view("\",\"source\":\"default\",\"value\":"));
+  writer.begin_value();
+  if (type == DumpType::none) {
+    writer.append("null");
+  }
+  else {
+    write_value();
+  }
+  writer.append('}');
+}
+
+}
+
+CMDLINE_INLINE std::size_t ArgumentParser::dump_config(char *buffer, std::size_t size, DumpFormat format) {
+  detail::DumpWriter writer(buffer, size, format);
+  const bool json = format == DumpFormat::json;
+  if (json) {
+    writer.append("{\"options\":[");
+  }
+  else {
+    DumpHeader header {};
+    std::memcpy(header.magic, DUMP_MAGIC, sizeof(header.magic));
+    header.version = DUMP_VERSION;
+    header.entry_count = static_cast<std::uint32_t>(m_options.size() + m_arguments.size() + (m_unhandled != nullptr));
+    writer.write(header);
+  }
+
+  for (std::size_t i = 0; i < m_options.size(); ++i) {
+    const Option &opt = m_options[i];
+    const char short_name[] = { '-', opt.short_name };
+    const bool by_long_name = !opt.long_name.empty();
+    const detail::ValueAccess &access = opt.value_access;
+    const DumpType type = access.dump ? access.dump_type : DumpType::none;
+    detail::dump_entry(writer, i == 0, DumpEntryKind::option,
+      by_long_name ? std::string_view("--") : std::string_view(short_name, 2),
+      by_long_name ? std::string_view(opt.long_name) : std::string_view(),
+      opt.occurrences != 0 ? DumpSource::argv : DumpSource::default_value, type, access.dump_list,
+      [&] {
+        if (type != DumpType::none) {
+          access.dump(writer);
+        }
+      });
+  }
+
+  if (json) {
+    writer.append("],\"arguments\":[");
+  }
+  for (std::size_t i = 0; i < m_arguments.size(); ++i) {
+    const detail::ValueAccess &access = m_arguments[i].value_access;
+    const DumpType type = access.dump ? access.dump_type : DumpType::none;
+    detail::dump_entry(writer, i == 0, DumpEntryKind::argument, "", m_arguments[i].name,
+      i < m_argument_count ? DumpSource::argv : DumpSource::default_value, type, access.dump_list,
+      [&] {
+        if (type != DumpType::none) {
+          access.dump(writer);
+        }
+      });
+  }
+  if (m_unhandled) {
+    detail::dump_entry(writer, m_arguments.empty(), DumpEntryKind::unhandled, "", m_unhandled_name,
+      m_unhandled_count != 0 ? DumpSource::argv : DumpSource::default_value, DumpType::string, true,
+      [&] {
+        writer.begin_list(m_unhandled_count);
+        for (std::size_t i = m_unhandled->size() - m_unhandled_count; i < m_unhandled->size(); ++i) {
+          writer.string((*m_unhandled)[i]);
+        }
+        writer.end_list();
+      });
+  }
+  if (json) {
+    writer.append("]}\n");
+  }
+  return writer.length();
+}
+
+CMDLINE_INLINE bool ArgumentParser::write_config(int fd, DumpFormat format) {
+  std::size_t length = this->dump_config(m_dump_buffer.data(), m_dump_buffer.size(), format);
+  if (length > m_dump_buffer.size()) {
+    m_dump_buffer.resize(length);
+    length = this->dump_config(m_dump_buffer.data(), m_dump_buffer.size(), format);
+  }
+  // One call, unless a pipe or socket takes less
+  std::size_t written = 0;
+  while (written < length) {
+    const ssize_t n = ::write(fd, m_dump_buffer.data() + written, length - written);
+    if (n < 0 and errno == EINTR) {
+      continue;
+    }
+    if (n <= 0) {
+      return false;
+    }
+    written += static_cast<std::size_t>(n);
+  }
+  return true;
+}
+
+}
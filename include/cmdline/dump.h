@@ -0,0 +1,201 @@
+/*
+Copyright (c) 2020 Jakob Mohrbacher
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+namespace cmdline {
+
+template<typename T>
+class Lazy;
+
+enum class DumpFormat : std::uint8_t {
+  json,
+  binary,
+};
+
+/**
+ * Type of the values of an option or argument in a dump. Values of other
+ * types are written as the text `canonical_args' would give.
+ */
+enum class DumpType : std::uint8_t {
+  none,    //< the value cannot be read, written as null or left out
+  boolean,
+  integer,
+  unsigned_integer,
+  number,
+  string,
+};
+
+enum class DumpSource : std::uint8_t {
+  default_value, //< not given in the last parse
+  argv,          //< given in the last parse, including interpolated values
+};
+
+/**
+ * Start of a binary dump, followed by `entry_count' entries of
+ *
+ * - `DumpEntry'
+ * - the name, `name_length' bytes
+ * - for lists, the number of values as a std::uint32_t
+ * - the values: booleans as one byte, integers as std::int64_t or
+ *   std::uint64_t, numbers as double and strings as a std::uint32_t length
+ *   followed by the bytes
+ *
+ * in native byte order without padding.
+ */
+struct DumpHeader {
+  char magic[4];
+  std::uint32_t version;
+  std::uint32_t entry_count;
+};
+
+enum class DumpEntryKind : std::uint8_t {
+  option,
+  argument,
+  unhandled, //< the catch-all argument
+};
+
+struct DumpEntry {
+  DumpEntryKind kind;
+  DumpSource source;
+  DumpType type;
+  std::uint8_t list; //< 1 for vectors and arrays
+  std::uint32_t name_length;
+};
+
+inline constexpr char DUMP_MAGIC[4] = { 'C', 'L', 'D', 'C' };
+inline constexpr std::uint32_t DUMP_VERSION = 1;
+
+namespace detail {
+
+template<typename T>
+constexpr DumpType dump_type() {
+  if constexpr (std::is_same_v<T, bool>) {
+    return DumpType::boolean;
+  }
+  else if constexpr (std::is_integral_v<T> and !std::is_same_v<T, char>) {
+    return std::is_signed_v<T> ? DumpType::integer : DumpType::unsigned_integer;
+  }
+  else if constexpr (std::is_floating_point_v<T>) {
+    return DumpType::number;
+  }
+  else {
+    return DumpType::string;
+  }
+}
+
+template<typename T>
+struct DumpTraits {
+  static constexpr DumpType type = dump_type<T>();
+  static constexpr bool list = false;
+};
+
+template<typename T>
+struct DumpTraits<std::vector<T>> {
+  static constexpr DumpType type = dump_type<T>();
+  static constexpr bool list = true;
+};
+
+template<typename T, std::size_t N>
+struct DumpTraits<std::array<T, N>> {
+  static constexpr DumpType type = dump_type<T>();
+  static constexpr bool list = true;
+};
+
+/**
+ * Appends a dump to a fixed size buffer, keeping track of the length the
+ * dump would have without truncation.
+ */
+class DumpWriter {
+  char *m_buffer;
+  std::size_t m_size;
+  std::size_t m_length = 0;
+  DumpFormat m_format;
+  bool m_first = true; //< no separator before the next value of a JSON list
+
+  void separate() {
+    if (!m_first) {
+      this->append(',');
+    }
+    m_first = false;
+  }
+
+public:
+  DumpWriter(char *buffer, std::size_t size, DumpFormat format)
+    : m_buffer(buffer), m_size(size), m_format(format) {}
+
+  DumpFormat format() const { return m_format; }
+  /**
+   * @brief Starts the value of an entry, which is not preceded by a
+   * separator.
+   */
+  void begin_value() { m_first = true; }
+  std::size_t length() const { return m_length; }
+
+  void append(const void *data, std::size_t size) {
+    if (m_length < m_size) {
+      std::memcpy(m_buffer + m_length, data, std::min(size, m_size - m_length));
+    }
+    m_length += size;
+  }
+
+  void append(char c) {
+    if (m_length < m_size) {
+      m_buffer[m_length] = c;
+    }
+    ++m_length;
+  }
+
+  void append(std::string_view str) {
+    this->append(str.data(), str.size());
+  }
+
+  template<typename T>
+  void write(const T &value) {
+    this->append(&value, sizeof(value));
+  }
+
+  /**
+   * @brief Writes a JSON string, or the length and bytes of `str'.
+   */
+  void string_literal(std::string_view str);
+
+  void begin_list(std::size_t count);
+  void end_list();
+
+  void boolean(bool value);
+  void integer(std::int64_t value);
+  void unsigned_integer(std::uint64_t value);
+  void number(double value);
+  void string(std::string_view value);
+};
+
+}
+}
@@ -0,0 +1,233 @@
+/*
+Copyright (c) 2020 Jakob Mohrbacher
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#pragma once
+
+#include "config.h"
+#include "getopt_compat.h"
+
+#include <cstdlib>
+#include <cstring>
+
+namespace cmdline {
+
+CMDLINE_INLINE Getopt::Getopt(const char *optstring, const struct option *longopts) {
+  m_parser.m_getopt_syntax = true;
+  m_parser.abbreviations = true;
+  if (*optstring == '+' or *optstring == '-') {
+    m_ordering = *optstring == '+' ? require_order : return_in_order;
+    ++optstring;
+  }
+  else if (std::getenv("POSIXLY_CORRECT") != nullptr) {
+    m_ordering = require_order;
+  }
+  m_colon = *optstring == ':';
+  m_parser.error_messages = !m_colon;
+  m_parser.set_diagnostic_buffer(&m_diagnostic, 1);
+
+  std::size_t long_count = 0;
+  while (longopts != nullptr and longopts[long_count].name != nullptr) {
+    ++long_count;
+  }
+  std::vector<bool> long_done(long_count, false);
+  const std::size_t short_count = std::strlen(optstring);
+  m_parser.m_options.reserve(1 + short_count + long_count);
+  m_names.reserve(1 + short_count + long_count);
+  m_entries.reserve(short_count + long_count);
+
+  // The parser's own `--help' is only reachable if the table has one
+  m_names.resize(1);
+  m_parser.m_options[0].long_name.clear();
+
+  for (const char *p = optstring; *p; ++p) {
+    if (*p == ':' or *p == ';') {
+      continue;
+    }
+    const int has_arg = p[1] != ':' ? no_argument : p[2] != ':' ? required_argument : optional_argument;
+    const std::int32_t short_entry = static_cast<std::int32_t>(m_entries.size());
+    m_entries.push_back({ static_cast<unsigned char>(*p), nullptr, -1 });
+    // A long option returning the same character becomes the long name of
+    // the same option
+    std::int32_t long_entry = -1;
+    const char *long_name = "";
+    for (std::size_t i = 0; i < long_count; ++i) {
+      const struct option &o = longopts[i];
+      if (!long_done[i] and o.flag == nullptr and o.val == static_cast<unsigned char>(*p) and o.has_arg == has_arg) {
+        long_done[i] = true;
+        long_entry = static_cast<std::int32_t>(m_entries.size());
+        m_entries.push_back({ o.val, nullptr, static_cast<int>(i) });
+        long_name = o.name;
+        break;
+      }
+    }
+    this->add(*p, long_name, has_arg, short_entry, long_entry);
+  }
+  for (std::size_t i = 0; i < long_count; ++i) {
+    if (!long_done[i]) {
+      const struct option &o = longopts[i];
+      const std::int32_t long_entry = static_cast<std::int32_t>(m_entries.size());
+      m_entries.push_back({ o.val, o.flag, static_cast<int>(i) });
+      this->add(0, o.name, o.has_arg, -1, long_entry);
+    }
+  }
+}
+
+CMDLINE_INLINE void Getopt::add(char short_name, const char *long_name, int has_arg, std::int32_t short_entry, std::int32_t long_entry) {
+  Option *opt;
+  if (!std::strcmp(long_name, "help")) {
+    if (!m_parser.validate_option(short_name, "")) {
+      return;
+    }
+    opt = &m_parser.m_options[0];
+    opt->short_name = short_name;
+    opt->long_name = long_name;
+  }
+  else {
+    if (!m_parser.validate_option(short_name, long_name)) {
+      return;
+    }
+    opt = &m_parser.m_options.emplace_back();
+    opt->short_name = short_name;
+    opt->long_name = long_name;
+    m_names.emplace_back();
+  }
+  const std::size_t index = static_cast<std::size_t>(opt - m_parser.m_options.data());
+  m_names[index] = { short_entry, long_entry };
+  opt->takes_argument = has_arg == required_argument;
+  opt->nargs = has_arg == required_argument ? 1 : 0;
+  opt->optional_value = has_arg == optional_argument;
+  opt->set_value = [this, index](const char **args) {
+    const Names &names = m_names[index];
+    m_hits.push_back({ m_long_token ? names.long_entry : names.short_entry, 0, args ? *args : nullptr });
+    return true;
+  };
+  opt->check_value = [](const char **) { return true; };
+}
+
+CMDLINE_INLINE void Getopt::add_error(const char *const *argv) {
+  ++m_error_count;
+  const Diagnostic &d = m_diagnostic;
+  Hit hit { ERROR, 0, nullptr };
+  switch (d.code) {
+  case ErrorCode::invalid_option:
+    hit.optopt = static_cast<unsigned char>(argv[d.argv_index][d.offset]);
+    break;
+  case ErrorCode::option_missing_argument:
+  case ErrorCode::option_unexpected_argument: {
+    const Names &names = m_names[d.id];
+    const std::int32_t entry = m_long_token ? names.long_entry : names.short_entry;
+    hit.optopt = entry >= 0 ? m_entries[entry].val : 0;
+    if (d.code == ErrorCode::option_missing_argument and m_colon) {
+      hit.entry = MISSING_VALUE;
+    }
+    break;
+  }
+  default:
+    break;
+  }
+  m_hits.push_back(hit);
+}
+
+CMDLINE_INLINE int Getopt::parse(int argc, char **argv) {
+  const char **args = const_cast<const char **>(argv);
+  m_parser.begin_parse();
+  m_hits.clear();
+  m_next = 0;
+  m_error_count = 0;
+  m_optarg = nullptr;
+  m_optopt = 0;
+
+  // Operands skipped by `permute', moved behind the options at the end
+  std::vector<const char *> &operands = m_skipped;
+  operands.clear();
+  int write = 1; //< the options are compacted at the front of `argv'
+  int i = 1;
+  for (; i < argc; ++i) {
+    const char *token = args[i];
+    if (token[0] != '-' or token[1] == '\0') {
+      if (m_ordering == require_order) {
+        break;
+      }
+      if (m_ordering == return_in_order) {
+        m_hits.push_back({ OPERAND, 0, token });
+        args[write++] = token;
+      }
+      else {
+        operands.push_back(token);
+      }
+      continue;
+    }
+    if (token[1] == '-' and token[2] == '\0') {
+      args[write++] = token;
+      ++i;
+      break;
+    }
+    const int start = i;
+    m_long_token = token[1] == '-';
+    m_parser.m_diagnostics_count = 0;
+    const bool ok = m_long_token ? m_parser.parse_long_option(argc, args, i)
+                                 : m_parser.parse_short_option(argc, args, i);
+    if (!ok) {
+      this->add_error(args);
+    }
+    // Writing never overtakes reading, `write' <= `start'
+    for (int k = start; k <= i; ++k) {
+      args[write++] = args[k];
+    }
+  }
+  // Every element before `i' was either written back or skipped, so the
+  // skipped operands fit exactly in between
+  std::memcpy(args + write, operands.data(), operands.size() * sizeof(*args));
+  m_optind = write;
+  return m_optind;
+}
+
+CMDLINE_INLINE int Getopt::next(int *longindex) {
+  if (m_next == m_hits.size()) {
+    m_optarg = nullptr;
+    return -1;
+  }
+  const Hit &hit = m_hits[m_next++];
+  m_optarg = hit.arg;
+  switch (hit.entry) {
+  case ERROR:
+    m_optopt = hit.optopt;
+    return '?';
+  case MISSING_VALUE:
+    m_optopt = hit.optopt;
+    return ':';
+  case OPERAND:
+    return 1;
+  default:
+    break;
+  }
+  const Entry &entry = m_entries[hit.entry];
+  if (longindex != nullptr and entry.longindex >= 0) {
+    *longindex = entry.longindex;
+  }
+  if (entry.flag != nullptr) {
+    *entry.flag = entry.val;
+    return 0;
+  }
+  return entry.val;
+}
+
+}
@@ -0,0 +1,153 @@
+/*
+Copyright (c) 2020 Jakob Mohrbacher
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#pragma once
+
+#include <getopt.h>
+
+#include <cstdint>
+#include <vector>
+
+#include "cmdline.h"
+
+namespace cmdline {
+
+/**
+ * Parses a command line described by a `getopt_long' option string and
+ * `struct option' table, for porting programs that use `getopt_long'.
+ *
+ * The options are added to an `ArgumentParser' and the whole command line is
+ * parsed at once by `parse'; `next' then hands out the options in the order
+ * they were given, returning what `getopt_long' would have returned.
+ *
+ * Like with `getopt_long':
+ *  - `x:' takes a value attached or in the next element, `x::' only an
+ *    attached one; the same for `required_argument' and `optional_argument'
+ *    long options, whose values are given as `--name value' or
+ *    `--name=value', and `--name=value' respectively.
+ *  - Option values may start with `-', and the last option of a group like
+ *    `-xzf' may take a value.
+ *  - Long options may be abbreviated to a unique prefix.
+ *  - Operands are moved behind the options in `argv', unless the option
+ *    string starts with `+' or POSIXLY_CORRECT is set, in which case the
+ *    first operand ends the options; with a leading `-' operands are
+ *    returned in order as options with the value 1.
+ *  - `--' ends the options and `-' alone is an operand.
+ *  - Errors return `?', or `:' for a missing value if the option string
+ *    starts with `:', which also disables the error messages.
+ *
+ * Differently, an error in an element ends that element; the rest of a group
+ * of short options is skipped.
+ */
+class Getopt {
+public:
+  Getopt(const char *optstring, const struct option *longopts);
+  Getopt(const Getopt &) = delete;
+  Getopt & operator=(const Getopt &) = delete;
+
+  /**
+   * @brief Parses `argv' and reorders it like `getopt_long'; returns the
+   * index of the first operand, the final `optind' of `getopt_long'.
+   */
+  int parse(int argc, char **argv);
+
+  /**
+   * @brief Returns the next option like `getopt_long' would, or -1 after the
+   * last. Long options with a `flag' store their `val' there and return 0;
+   * `longindex' receives the table index for options given by long name.
+   */
+  int next(int *longindex = nullptr);
+
+  /**
+   * @brief The value of the option last returned by `next', or null.
+   */
+  const char * optarg() const { return m_optarg; }
+  /**
+   * @brief The option character of the last error.
+   */
+  int optopt() const { return m_optopt; }
+  /**
+   * @brief Index of the first operand after `parse'.
+   */
+  int optind() const { return m_optind; }
+
+  /**
+   * @brief Number of errors in the last `parse'.
+   */
+  std::size_t error_count() const { return m_error_count; }
+
+  ArgumentParser & parser() { return m_parser; }
+
+private:
+  enum Ordering : std::uint8_t {
+    permute,
+    require_order,
+    return_in_order,
+  };
+
+  // What `next' returns for an option
+  struct Entry {
+    int val;
+    int *flag;
+    int longindex; //< -1 for short options
+  };
+
+  static constexpr std::int32_t ERROR = -1;          //< `?' or `:'
+  static constexpr std::int32_t MISSING_VALUE = -2;  //< `:' with a leading `:' in the option string
+  static constexpr std::int32_t OPERAND = -3;        //< 1 with `return_in_order'
+
+  struct Hit {
+    std::int32_t entry; //< index into `m_entries', or one of the constants above
+    std::int32_t optopt;
+    const char *arg;
+  };
+
+  // Entries of an `ArgumentParser' option by the name it was given by
+  struct Names {
+    std::int32_t short_entry = -1;
+    std::int32_t long_entry = -1;
+  };
+
+  ArgumentParser m_parser;
+  Ordering m_ordering = permute;
+  bool m_colon = false;
+  std::vector<Entry> m_entries;
+  std::vector<Names> m_names; //< by option index
+  Diagnostic m_diagnostic {};
+
+  std::vector<Hit> m_hits;
+  std::size_t m_next = 0;
+  bool m_long_token = false; //< the element being parsed is a long option
+  std::vector<const char *> m_skipped; //< operands moved behind the options
+  std::size_t m_error_count = 0;
+  const char *m_optarg = nullptr;
+  int m_optopt = 0;
+  int m_optind = 1;
+
+  void add(char short_name, const char *long_name, int has_arg, std::int32_t short_entry, std::int32_t long_entry);
+  void add_error(const char *const *argv);
+};
+
+}
+
+#ifdef CMDLINE_HEADER_ONLY
+#include "getopt_compat-inl.h"
+#endif
@@ -0,0 +1,94 @@
+/*
+Copyright (c) 2020 Jakob Mohrbacher
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#pragma once
+
+#include "config.h"
+#include "cmdline.h"
+
+namespace cmdline {
+
+CMDLINE_INLINE OptionGroup ArgumentParser::add_group(const char *name, const char *help) {
+  const std::string_view group(name);
+  if (group.empty() or group[0] == '-' or group.find_first_of(".=") != std::string_view::npos) {
+    return OptionGroup {};
+  }
+  for (std::size_t i = 0; i < m_groups.size(); ++i) {
+    if (m_groups[i].name == group) {
+      this->report(nullptr, { ErrorCode::duplicate_group, 0, -1, static_cast<std::uint32_t>(i), 0 });
+      return OptionGroup {};
+    }
+  }
+  m_groups.push_back({ name, help, nullptr });
+  return OptionGroup(this, static_cast<std::uint32_t>(m_groups.size() - 1));
+}
+
+CMDLINE_INLINE void ArgumentParser::dispatch_groups() {
+  for (std::uint32_t i = 0; i < m_groups.size(); ++i) {
+    if (m_groups[i].handler) {
+      m_groups[i].handler(OptionGroup(this, i));
+    }
+  }
+}
+
+CMDLINE_INLINE std::string OptionGroup::qualified_name(const char *long_name) const {
+  if (long_name == nullptr or *long_name == '\0') {
+    return "";
+  }
+  return this->name() + '.' + long_name;
+}
+
+CMDLINE_INLINE void OptionGroup::mark_last_option() {
+  m_parser->m_options.back().group = m_index;
+}
+
+CMDLINE_INLINE const std::string & OptionGroup::name() const {
+  static const std::string none;
+  return m_parser ? m_parser->m_groups[m_index].name : none;
+}
+
+CMDLINE_INLINE bool OptionGroup::add_option(bool &value, const char *help, char short_name, const char *long_name) {
+  if (m_parser == nullptr) {
+    return false;
+  }
+  const std::string qualified = this->qualified_name(long_name);
+  if (!m_parser->add_option(value, help, short_name, qualified.c_str())) {
+    return false;
+  }
+  this->mark_last_option();
+  return true;
+}
+
+CMDLINE_INLINE void OptionGroup::on_parsed(std::function<void(const OptionGroup &)> handler) {
+  if (m_parser != nullptr) {
+    m_parser->m_groups[m_index].handler = std::move(handler);
+  }
+}
+
+CMDLINE_INLINE bool OptionGroup::given(const char *long_name) const {
+  if (m_parser == nullptr) {
+    return false;
+  }
+  const std::size_t index = m_parser->option_index(std::string_view(this->qualified_name(long_name)));
+  return index != ArgumentParser::npos and m_parser->m_options[index].occurrences != 0;
+}
+
+}
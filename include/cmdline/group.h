@@ -0,0 +1,98 @@
+/*
+Copyright (c) 2020 Jakob Mohrbacher
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#pragma once
+
+#include <cstdint>
+
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace cmdline {
+
+class ArgumentParser;
+class OptionGroup;
+
+namespace detail {
+
+struct Group {
+  std::string name;
+  std::string help;
+  std::function<void(const OptionGroup &)> handler;
+};
+
+}
+
+/**
+ * A named set of options registered by one component into a shared parser.
+ * Long names are prefixed with the group name, `--NAME.OPTION', so
+ * components only need to agree on distinct group names; adding an option
+ * that collides with an existing short or long name fails as for
+ * `ArgumentParser::add_option'.
+ *
+ * All groups are parsed in the same pass over argv. After a successful
+ * parse, the handler of each group is called in the order the groups were
+ * added.
+ *
+ * The handle refers to the parser, which has to outlive it. A handle for a
+ * name that is already taken is not valid and adding options to it fails.
+ */
+class OptionGroup {
+  friend class ArgumentParser;
+
+  ArgumentParser *m_parser { nullptr };
+  std::uint32_t m_index { 0 };
+
+  OptionGroup(ArgumentParser *parser, std::uint32_t index)
+    : m_parser(parser), m_index(index) {}
+
+  std::string qualified_name(const char *long_name) const;
+  void mark_last_option();
+
+public:
+  OptionGroup() = default;
+
+  bool valid() const { return m_parser != nullptr; }
+  const std::string & name() const;
+
+  /**
+   * @brief Adds an option as `ArgumentParser::add_option', with the long
+   * name prefixed by the group name. The default argument name is derived
+   * from the unprefixed name.
+   */
+  bool add_option(bool &value, const char *help, char short_name, const char *long_name);
+  template<typename T>
+  bool add_option(T &value, const char *help, char short_name, const char *long_name, const char *argument_name = nullptr);
+
+  /**
+   * @brief Sets the function called after a successful parse.
+   */
+  void on_parsed(std::function<void(const OptionGroup &)> handler);
+
+  /**
+   * @brief Returns whether the option, given by its unprefixed long name,
+   * was given in the last parse.
+   */
+  bool given(const char *long_name) const;
+};
+
+}
@@ -0,0 +1,164 @@
+/*
+Copyright (c) 2020 Jakob Mohrbacher
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#pragma once
+
+#include "config.h"
+#include "help_text.h"
+
+#include <cstring>
+
+#include <algorithm>
+#include <array>
+
+namespace cmdline {
+namespace detail {
+
+// A control byte below 0x80 is followed by that many plus one literal bytes,
+// otherwise the low bits are a match length less MIN_MATCH, followed by the
+// distance back as 16 bits little endian
+inline constexpr std::size_t LZ_MIN_MATCH = 4;
+inline constexpr std::size_t LZ_MAX_MATCH = 0x7f + LZ_MIN_MATCH;
+inline constexpr std::size_t LZ_MAX_LITERALS = 0x80;
+inline constexpr std::size_t LZ_MAX_DISTANCE = 0xffff;
+
+CMDLINE_INLINE void lz_compress(std::string_view text, std::string &out) {
+  constexpr unsigned HASH_BITS = 12;
+  std::array<std::uint32_t, 1 << HASH_BITS> table;
+  table.fill(static_cast<std::uint32_t>(-1));
+  auto hash = [&](std::size_t pos) {
+    std::uint32_t word;
+    std::memcpy(&word, text.data() + pos, sizeof(word));
+    return (word * 2654435761u) >> (32 - HASH_BITS);
+  };
+  std::size_t literals = 0;
+  auto flush = [&](std::size_t end) {
+    while (literals != 0) {
+      const std::size_t n = std::min(literals, LZ_MAX_LITERALS);
+      out += static_cast<char>(n - 1);
+      out.append(text.data() + end - literals, n);
+      literals -= n;
+    }
+  };
+  std::size_t pos = 0;
+  while (pos + LZ_MIN_MATCH <= text.size()) {
+    const std::uint32_t h = hash(pos);
+    const std::size_t candidate = table[h];
+    table[h] = static_cast<std::uint32_t>(pos);
+    std::size_t length = 0;
+    if (candidate < pos and pos - candidate <= LZ_MAX_DISTANCE) {
+      const std::size_t limit = std::min(text.size() - pos, LZ_MAX_MATCH);
+      while (length < limit and text[candidate + length] == text[pos + length]) {
+        ++length;
+      }
+    }
+    if (length < LZ_MIN_MATCH) {
+      ++literals;
+      ++pos;
+      continue;
+    }
+    flush(pos);
+    const std::size_t distance = pos - candidate;
+    out += static_cast<char>(0x80 | (length - LZ_MIN_MATCH));
+    out += static_cast<char>(distance & 0xff);
+    out += static_cast<char>(distance >> 8);
+    pos += length;
+  }
+  literals += text.size() - pos;
+  flush(text.size());
+}
+
+CMDLINE_INLINE void lz_decompress(std::string_view data, std::string &out) {
+  std::size_t pos = 0;
+  while (pos < data.size()) {
+    const unsigned char control = static_cast<unsigned char>(data[pos++]);
+    if (control < 0x80) {
+      out.append(data.data() + pos, control + 1u);
+      pos += control + 1u;
+    }
+    else {
+      const std::size_t length = (control & 0x7f) + LZ_MIN_MATCH;
+      const std::size_t distance = static_cast<unsigned char>(data[pos])
+        | static_cast<std::size_t>(static_cast<unsigned char>(data[pos + 1])) << 8;
+      pos += 2;
+      // Copied a byte at a time, a match may overlap the text it produces
+      std::size_t from = out.size() - distance;
+      for (std::size_t i = 0; i < length; ++i) {
+        out += out[from++];
+      }
+    }
+  }
+}
+
+CMDLINE_INLINE void HelpStore::seal(bool compress) {
+  Block block { static_cast<std::uint32_t>(m_pending.size()), {} };
+  if (compress) {
+    lz_compress(m_pending, block.data);
+  }
+  if (!compress or block.data.size() >= m_pending.size()) {
+    block.data.assign(m_pending);
+  }
+  else {
+    block.data.shrink_to_fit();
+  }
+  m_blocks.push_back(std::move(block));
+  m_pending.clear();
+}
+
+CMDLINE_INLINE HelpText HelpStore::add(std::string_view text, bool compress) {
+  if (text.empty()) {
+    return HelpText {};
+  }
+  const HelpText result { nullptr, static_cast<std::uint32_t>(m_length), static_cast<std::uint32_t>(text.length()) };
+  m_pending.append(text);
+  m_pending += '\0';
+  m_length += text.length() + 1;
+  if (m_pending.size() >= BLOCK_SIZE) {
+    this->seal(compress);
+  }
+  return result;
+}
+
+CMDLINE_INLINE std::string HelpStore::decode() const {
+  std::string text;
+  text.reserve(m_length);
+  for (const Block &block : m_blocks) {
+    if (block.data.size() == block.length) {
+      text += block.data;
+    }
+    else {
+      lz_decompress(block.data, text);
+    }
+  }
+  text += m_pending;
+  return text;
+}
+
+CMDLINE_INLINE std::size_t HelpStore::memory() const {
+  std::size_t bytes = m_blocks.capacity() * sizeof(Block) + m_pending.capacity();
+  for (const Block &block : m_blocks) {
+    bytes += block.data.capacity();
+  }
+  return bytes;
+}
+
+}
+}
@@ -0,0 +1,101 @@
+/*
+Copyright (c) 2020 Jakob Mohrbacher
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace cmdline {
+namespace detail {
+
+/**
+ * Help text of an option or argument, either static text kept by pointer or
+ * a NUL terminated string at `offset' in the decoded `HelpStore'.
+ */
+struct HelpText {
+  const char *data = nullptr;
+  std::uint32_t offset = 0;
+  std::uint32_t length = 0;
+
+  bool empty() const { return length == 0; }
+
+  /**
+   * @brief Returns the text, `decoded' being the result of
+   * `HelpStore::decode'.
+   */
+  const char * c_str(const std::string &decoded) const {
+    return data ? data : length == 0 ? "" : decoded.c_str() + offset;
+  }
+};
+
+/**
+ * Keeps copied help text out of the options, in blocks that are only read
+ * back by `ArgumentParser::usage'. Blocks can be compressed as they fill up.
+ */
+class HelpStore {
+  static constexpr std::size_t BLOCK_SIZE = 16 * 1024;
+
+  struct Block {
+    std::uint32_t length; //< of the text, equal to the size of `data' if not compressed
+    std::string data;
+  };
+
+  std::vector<Block> m_blocks;
+  std::string m_pending; //< text not yet moved to a block
+  std::size_t m_length { 0 };
+
+  void seal(bool compress);
+
+public:
+  /**
+   * @brief Copies `text' into the store, compressing the block it ends up
+   * in if `compress' is set when the block is full.
+   */
+  HelpText add(std::string_view text, bool compress);
+
+  /**
+   * @brief Returns all text in the store.
+   */
+  std::string decode() const;
+
+  /**
+   * @brief Heap memory held by the store.
+   */
+  std::size_t memory() const;
+};
+
+/**
+ * @brief Compresses `text' into `out', a byte oriented LZ77 format read by
+ * `lz_decompress'. Matches reach back at most 64KiB.
+ */
+void lz_compress(std::string_view text, std::string &out);
+/**
+ * @brief Appends the text compressed by `lz_compress' to `out'.
+ */
+void lz_decompress(std::string_view data, std::string &out);
+
+}
+}
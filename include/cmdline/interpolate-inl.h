@@ -0,0 +1,141 @@
+/*
+Copyright (c) 2020 Jakob Mohrbacher
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#pragma once
+
+#include "config.h"
+#include "interpolate.h"
+
+#include <cstdlib>
+#include <cstring>
+
+namespace cmdline {
+namespace detail {
+
+struct Expansion {
+  std::string &out;
+  const std::size_t max_depth;
+  const std::size_t max_length;
+  InterpolateStatus status { InterpolateStatus::ok };
+  std::size_t offset { 0 };
+  bool changed { false };
+};
+
+/**
+ * @brief Appends `text', from `p' on with the first `$' at `dollar', to
+ * `e.out', expanding variables. Errors are located in the top level text,
+ * at the variable whose value failed to expand.
+ */
+CMDLINE_INLINE bool expand(Expansion &e, const char *text, const char *p, const char *dollar, std::size_t depth) {
+  auto fail = [&](InterpolateStatus status, const char *at) {
+    if (e.status == InterpolateStatus::ok) {
+      e.status = status;
+    }
+    if (depth == 0) {
+      e.offset = static_cast<std::size_t>(at - text);
+    }
+    return false;
+  };
+  while (dollar != nullptr) {
+    e.out.append(p, dollar);
+    if (dollar[1] == '$') {
+      e.out += '$';
+      e.changed = true;
+      p = dollar + 2;
+    }
+    else if (dollar[1] != '{') {
+      e.out += '$';
+      p = dollar + 1;
+    }
+    else {
+      const char *name = dollar + 2;
+      const char *close = std::strchr(name, '}');
+      if (close == nullptr) {
+        return fail(InterpolateStatus::unterminated_variable, dollar);
+      }
+      const std::string variable(name, close);
+      const char *value = std::getenv(variable.c_str());
+      if (value == nullptr) {
+        return fail(InterpolateStatus::undefined_variable, dollar);
+      }
+      const char *nested = std::strchr(value, '$');
+      if (nested == nullptr) {
+        e.out += value;
+      }
+      else if (depth == e.max_depth) {
+        return fail(InterpolateStatus::too_deep, dollar);
+      }
+      else if (!expand(e, value, value, nested, depth + 1)) {
+        return fail(e.status, dollar);
+      }
+      e.changed = true;
+      p = close + 1;
+    }
+    if (e.out.size() > e.max_length) {
+      return fail(InterpolateStatus::too_long, p);
+    }
+    dollar = std::strchr(p, '$');
+  }
+  e.out += p;
+  if (e.out.size() > e.max_length) {
+    return fail(InterpolateStatus::too_long, p);
+  }
+  return true;
+}
+
+}
+
+CMDLINE_INLINE const char *interpolate_status_message(InterpolateStatus status) {
+  switch (status) {
+  case InterpolateStatus::ok: return "no error";
+  case InterpolateStatus::undefined_variable: return "undefined variable";
+  case InterpolateStatus::unterminated_variable: return "unterminated `${'";
+  case InterpolateStatus::too_deep: return "variables nested too deeply";
+  case InterpolateStatus::too_long: return "expanded value too long";
+  }
+  return "";
+}
+
+CMDLINE_INLINE InterpolateResult interpolate(const char *text, std::string &out, std::size_t max_depth,
+                                             std::size_t max_length) {
+  const bool home = text[0] == '~' and (text[1] == '\0' or text[1] == '/');
+  const char *p = home ? text + 1 : text;
+  const char *dollar = std::strchr(p, '$');
+  if (dollar == nullptr and !home) {
+    return { InterpolateStatus::ok, text, 0 };
+  }
+  out.clear();
+  detail::Expansion e { out, max_depth, max_length };
+  if (home) {
+    const char *value = std::getenv("HOME");
+    if (value == nullptr) {
+      return { InterpolateStatus::undefined_variable, nullptr, 0 };
+    }
+    out += value;
+    e.changed = true;
+  }
+  if (!detail::expand(e, text, p, dollar, 0)) {
+    return { e.status, nullptr, e.offset };
+  }
+  return { InterpolateStatus::ok, e.changed ? out.c_str() : text, 0 };
+}
+
+}
@@ -0,0 +1,65 @@
+/*
+Copyright (c) 2020 Jakob Mohrbacher
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include <string>
+
+namespace cmdline {
+
+enum class InterpolateStatus : std::uint8_t {
+  ok,
+  undefined_variable,
+  unterminated_variable,
+  too_deep,
+  too_long,
+};
+
+const char *interpolate_status_message(InterpolateStatus status);
+
+struct InterpolateResult {
+  InterpolateStatus status;
+  const char *value;  //< `text' itself if nothing was expanded, `out.c_str()' otherwise
+  std::size_t offset; //< position of the error in `text'
+
+  explicit operator bool() const { return status == InterpolateStatus::ok; }
+};
+
+/**
+ * @brief Expands `${NAME}' to the value of the environment variable NAME,
+ * and `~' at the start of `text', alone or followed by `/', to $HOME.
+ *
+ * `$$' is a literal `$', any other `$' is kept. `${...}' in the values of
+ * variables is expanded as well, up to `max_depth' levels deep; `~' only at
+ * the start of `text'. Fails if a variable is not set, a `${' is not closed,
+ * variables are nested deeper than `max_depth' or the result is longer than
+ * `max_length'.
+ *
+ * `text' is scanned once. If it contains neither `$' nor a leading `~', it
+ * is returned as it is and `out' is not touched.
+ */
+InterpolateResult interpolate(const char *text, std::string &out, std::size_t max_depth = 8,
+                              std::size_t max_length = 64 * 1024);
+
+}
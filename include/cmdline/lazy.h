@@ -0,0 +1,122 @@
+/*
+Copyright (c) 2020 Jakob Mohrbacher
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#pragma once
+
+#include <cstdint>
+
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+namespace cmdline {
+
+template<typename T>
+class Lazy;
+
+namespace detail {
+
+template<typename T>
+struct is_lazy : std::false_type {};
+template<typename T>
+struct is_lazy<Lazy<T>> : std::true_type {};
+
+/**
+ * @brief Converts `text' as `ArgumentParser::convert' does, for values
+ * converted outside of a parse; defined in cmdline.h after the
+ * `parse_value' overloads.
+ */
+template<typename T>
+bool convert_text(const char *text, T &value);
+
+}
+
+/**
+ * A value that is converted when it is first read instead of during the
+ * parse, for options that are only read on some paths.
+ *
+ * Parsing only keeps a pointer to the text of the value, so argv (or the
+ * blob given to `load_result') has to outlive the first read. The result of
+ * the conversion is kept; an invalid value leaves the previous value, the
+ * default, in place. Set `ArgumentParser::convert_lazy_values' to convert
+ * during the parse anyway, so invalid values fail it.
+ *
+ * Reading is not thread safe until the value has been converted once.
+ */
+template<typename T>
+class Lazy {
+  static_assert(!std::is_same_v<T, std::string_view> and !std::is_same_v<T, const char *>,
+                "std::string_view and const char * values are not converted");
+
+  enum class State : std::uint8_t { unconverted, valid, invalid };
+
+  const char *m_text { nullptr };
+  mutable T m_value {};
+  mutable State m_state { State::valid };
+
+  void convert() const {
+    if (m_state == State::unconverted) {
+      T value {};
+      if (detail::convert_text(m_text, value)) {
+        m_value = std::move(value);
+        m_state = State::valid;
+      }
+      else {
+        m_state = State::invalid;
+      }
+    }
+  }
+
+public:
+  Lazy() = default;
+  Lazy(T value)
+    : m_value(std::move(value)) {}
+
+  /**
+   * @brief Sets the text to convert on the next read.
+   */
+  void assign(const char *text) {
+    m_text = text;
+    m_state = State::unconverted;
+  }
+
+  /**
+   * @brief The text of the value, nullptr if none was given.
+   */
+  const char * text() const { return m_text; }
+
+  /**
+   * @brief Converts the value if needed and returns whether it is valid.
+   */
+  bool valid() const {
+    this->convert();
+    return m_state == State::valid;
+  }
+
+  const T & value() const {
+    this->convert();
+    return m_value;
+  }
+  const T & operator*() const { return this->value(); }
+  const T * operator->() const { return &this->value(); }
+};
+
+}
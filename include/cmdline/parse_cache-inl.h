@@ -0,0 +1,260 @@
+/*
+Copyright (c) 2020 Jakob Mohrbacher
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#pragma once
+
+#include "config.h"
+#include "cmdline.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+
+namespace cmdline {
+namespace detail {
+
+CMDLINE_INLINE std::uint64_t fnv1a_64(const void *data, std::size_t size, std::uint64_t hash = 0xcbf29ce484222325) {
+  const unsigned char *bytes = static_cast<const unsigned char *>(data);
+  for (std::size_t i = 0; i < size; ++i) {
+    hash = (hash ^ bytes[i]) * 0x100000001b3;
+  }
+  return hash;
+}
+
+/**
+ * @brief Hashes file contents a word at a time in four independent lanes, so
+ * the multiplications overlap; byte-wise FNV-1a over a 64KiB configuration
+ * file costs more than the rest of a cache hit.
+ */
+CMDLINE_INLINE std::uint64_t hash_contents(const void *data, std::size_t size) {
+  constexpr std::uint64_t K = 0x9e3779b97f4a7c15;
+  std::uint64_t lanes[4] = { K, K + 1, K + 2, K + 3 };
+  const char *bytes = static_cast<const char *>(data);
+  std::size_t i = 0;
+  for (; i + sizeof(lanes) <= size; i += sizeof(lanes)) {
+    for (int j = 0; j < 4; ++j) {
+      std::uint64_t word;
+      std::memcpy(&word, bytes + i + j * sizeof(word), sizeof(word));
+      const std::uint64_t x = (lanes[j] ^ word) * K;
+      lanes[j] = (x << 31) | (x >> 33);
+    }
+  }
+  const std::uint64_t hash = fnv1a_64(lanes, sizeof(lanes));
+  return fnv1a_64(bytes + i, size - i, hash ^ size);
+}
+
+template<typename T>
+void append_key(std::string &key, const T &value) {
+  key.append(reinterpret_cast<const char *>(&value), sizeof(value));
+}
+
+CMDLINE_INLINE void append_key(std::string &key, std::string_view str) {
+  append_key(key, static_cast<std::uint64_t>(str.size()));
+  key.append(str);
+}
+
+}
+
+CMDLINE_INLINE ParseCache::ParseCache(std::string directory)
+  : m_directory(std::move(directory)) {
+}
+
+CMDLINE_INLINE ParseCache::~ParseCache() {
+  this->unmap();
+}
+
+CMDLINE_INLINE void ParseCache::add_environment(const char *name) {
+  m_environment.emplace_back(name);
+}
+
+CMDLINE_INLINE void ParseCache::add_file(const char *path) {
+  m_files.emplace_back(path);
+}
+
+CMDLINE_INLINE void ParseCache::fingerprint(const ArgumentParser &parser, int argc, const char **argv, std::string &key) const {
+  detail::append_key(key, parser.spec_hash());
+  detail::append_key(key, static_cast<std::uint32_t>(argc));
+  for (int i = 1; i < argc; ++i) {
+    detail::append_key(key, std::string_view(argv[i]));
+  }
+  for (const std::string &name : m_environment) {
+    const char *value = std::getenv(name.c_str());
+    detail::append_key(key, std::string_view(name));
+    detail::append_key(key, static_cast<std::uint8_t>(value != nullptr));
+    if (value != nullptr) {
+      detail::append_key(key, std::string_view(value));
+    }
+  }
+  for (const std::string &path : m_files) {
+    detail::append_key(key, std::string_view(path));
+    struct stat st;
+    const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0 or ::fstat(fd, &st) != 0) {
+      detail::append_key(key, static_cast<std::uint8_t>(0));
+      if (fd >= 0) {
+        ::close(fd);
+      }
+      continue;
+    }
+    std::uint64_t hash = detail::hash_contents(nullptr, 0);
+    if (st.st_size > 0) {
+      void *data = ::mmap(nullptr, static_cast<std::size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+      if (data != MAP_FAILED) {
+        hash = detail::hash_contents(data, static_cast<std::size_t>(st.st_size));
+        ::munmap(data, static_cast<std::size_t>(st.st_size));
+      }
+    }
+    ::close(fd);
+    detail::append_key(key, static_cast<std::uint8_t>(1));
+    detail::append_key(key, static_cast<std::uint64_t>(st.st_size));
+    detail::append_key(key, static_cast<std::int64_t>(st.st_mtim.tv_sec));
+    detail::append_key(key, static_cast<std::int64_t>(st.st_mtim.tv_nsec));
+    detail::append_key(key, hash);
+  }
+}
+
+CMDLINE_INLINE bool ParseCache::parse_args(ArgumentParser &parser, int argc, const char **argv, bool exit_on_failure) {
+  this->unmap();
+  m_hit = false;
+  std::string key;
+  this->fingerprint(parser, argc, argv, key);
+  char name[32];
+  std::snprintf(name, sizeof(name), "/%016llx.cache",
+    static_cast<unsigned long long>(detail::fnv1a_64(key.data(), key.size())));
+  const std::string path = m_directory + name;
+
+  if (this->load(parser, path, key)) {
+    m_hit = true;
+    // Counted as the parse it stands for
+    if (parser.m_usage != nullptr) {
+      parser.m_usage->count_parse();
+      for (std::size_t i = 0; i < parser.m_options.size(); ++i) {
+        if (parser.m_options[i].occurrences != 0) {
+          parser.m_usage->count_option(i);
+        }
+      }
+    }
+    if (!parser.m_groups.empty()) {
+      parser.dispatch_groups();
+    }
+    return true;
+  }
+  if (!parser.parse_args(argc, argv, exit_on_failure)) {
+    return false;
+  }
+  std::vector<char> result;
+  if (parser.save_result(result)) {
+    this->store(path, key, result);
+  }
+  return true;
+}
+
+CMDLINE_INLINE bool ParseCache::load(ArgumentParser &parser, const std::string &path, const std::string &key) {
+  const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    return false;
+  }
+  struct stat st;
+  void *data = MAP_FAILED;
+  if (::fstat(fd, &st) == 0 and static_cast<std::size_t>(st.st_size) >= sizeof(detail::ParseCacheHeader)) {
+    data = ::mmap(nullptr, static_cast<std::size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+  }
+  ::close(fd);
+  if (data == MAP_FAILED) {
+    return false;
+  }
+  m_mapped = static_cast<const char *>(data);
+  m_mapped_size = static_cast<std::size_t>(st.st_size);
+
+  detail::ParseCacheHeader header;
+  std::memcpy(&header, m_mapped, sizeof(header));
+  const bool valid = std::memcmp(header.magic, detail::PARSE_CACHE_MAGIC, sizeof(header.magic)) == 0
+    and header.version == detail::PARSE_CACHE_VERSION
+    and header.key_size == key.size()
+    and header.result_offset >= sizeof(header) + key.size()
+    and header.result_offset <= m_mapped_size
+    and header.result_size == m_mapped_size - header.result_offset
+    // The name is only a hash of the key, the key itself has to match
+    and std::memcmp(m_mapped + sizeof(header), key.data(), key.size()) == 0;
+  if (valid) {
+    // A hit stands for a whole parse, nothing of the previous one is kept
+    parser.begin_parse();
+  }
+  if (!valid or !parser.load_result(m_mapped + header.result_offset, header.result_size)) {
+    this->unmap();
+    return false;
+  }
+  return true;
+}
+
+CMDLINE_INLINE void ParseCache::store(const std::string &path, const std::string &key, const std::vector<char> &result) const {
+  detail::ParseCacheHeader header {};
+  std::memcpy(header.magic, detail::PARSE_CACHE_MAGIC, sizeof(header.magic));
+  header.version = detail::PARSE_CACHE_VERSION;
+  header.key_size = static_cast<std::uint32_t>(key.size());
+  header.result_offset = static_cast<std::uint32_t>((sizeof(header) + key.size() + 7) / 8 * 8);
+  header.result_size = result.size();
+  std::vector<char> file(header.result_offset + result.size(), '\0');
+  std::memcpy(file.data(), &header, sizeof(header));
+  std::memcpy(file.data() + sizeof(header), key.data(), key.size());
+  std::memcpy(file.data() + header.result_offset, result.data(), result.size());
+
+  if (::mkdir(m_directory.c_str(), 0755) != 0 and errno != EEXIST) {
+    return;
+  }
+  // Written under a name of its own and renamed into place, so readers see
+  // either no file or a complete one
+  std::string temporary = path + ".XXXXXX";
+  const int fd = ::mkostemp(temporary.data(), O_CLOEXEC);
+  if (fd < 0) {
+    return;
+  }
+  ::fchmod(fd, 0644);
+  std::size_t written = 0;
+  while (written < file.size()) {
+    const ssize_t n = ::write(fd, file.data() + written, file.size() - written);
+    if (n < 0 and errno == EINTR) {
+      continue;
+    }
+    if (n <= 0) {
+      break;
+    }
+    written += static_cast<std::size_t>(n);
+  }
+  if (::close(fd) != 0 or written != file.size() or ::rename(temporary.c_str(), path.c_str()) != 0) {
+    ::unlink(temporary.c_str());
+  }
+}
+
+CMDLINE_INLINE void ParseCache::unmap() {
+  if (m_mapped != nullptr) {
+    ::munmap(const_cast<char *>(m_mapped), m_mapped_size);
+  }
+  m_mapped = nullptr;
+  m_mapped_size = 0;
+}
+
+}
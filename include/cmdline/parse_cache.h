@@ -0,0 +1,114 @@
+/*
+Copyright (c) 2020 Jakob Mohrbacher
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace cmdline {
+
+class ArgumentParser;
+
+namespace detail {
+
+inline constexpr char PARSE_CACHE_MAGIC[4] = { 'C', 'L', 'P', 'C' };
+inline constexpr std::uint32_t PARSE_CACHE_VERSION = 1;
+
+/**
+ * Start of a cache file, followed by the fingerprint it was written for and
+ * the `save_result' blob at `result_offset'.
+ */
+struct ParseCacheHeader {
+  char magic[4];
+  std::uint32_t version;
+  std::uint32_t key_size;
+  std::uint32_t result_offset;
+  std::uint64_t result_size;
+};
+
+}
+
+/**
+ * Caches parse results in a directory, for programs that are run many times
+ * with the same command line.
+ *
+ * A result is looked up by a fingerprint of the parser's options and
+ * arguments, the command line without the program name, the environment
+ * variables given to `add_environment' and the files given to `add_file'
+ * (path, size, modification time and a hash of the contents). On a hit the
+ * cache file is mapped and loaded with `ArgumentParser::load_result' instead
+ * of parsing; validators and constraints are not run again, so files and
+ * variables that they or the program read should be added as well.
+ *
+ * Only successful parses are cached. Cache files are written to a temporary
+ * name and renamed, so concurrent runs never see a partial file; failing to
+ * read or write the cache only costs the parse.
+ *
+ * `std::string_view' and `const char *' values loaded on a hit point into the
+ * mapped cache file, which stays mapped until the next `parse_args' or the
+ * destruction of the cache.
+ */
+class ParseCache {
+public:
+  explicit ParseCache(std::string directory);
+  ~ParseCache();
+
+  ParseCache(const ParseCache &) = delete;
+  ParseCache & operator=(const ParseCache &) = delete;
+
+  /**
+   * @brief Makes the result depend on the value of an environment variable.
+   */
+  void add_environment(const char *name);
+  /**
+   * @brief Makes the result depend on the contents of a file, like a
+   * configuration file the program reads.
+   */
+  void add_file(const char *path);
+
+  /**
+   * @brief Parses like `ArgumentParser::parse_args', or loads the result of
+   * an earlier parse with the same fingerprint.
+   */
+  bool parse_args(ArgumentParser &parser, int argc, const char **argv, bool exit_on_failure = true);
+
+  /**
+   * @brief Whether the last `parse_args' was served from the cache.
+   */
+  bool hit() const { return m_hit; }
+
+private:
+  std::string m_directory;
+  std::vector<std::string> m_environment;
+  std::vector<std::string> m_files;
+  bool m_hit = false;
+  const char *m_mapped = nullptr;
+  std::size_t m_mapped_size = 0;
+
+  void fingerprint(const ArgumentParser &parser, int argc, const char **argv, std::string &key) const;
+  bool load(ArgumentParser &parser, const std::string &path, const std::string &key);
+  void store(const std::string &path, const std::string &key, const std::vector<char> &result) const;
+  void unmap();
+};
+
+}
@@ -0,0 +1,230 @@
+/*
+Copyright (c) 2020 Jakob Mohrbacher
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#pragma once
+
+#include "config.h"
+#include "quantity.h"
+
+#include <cstring>
+
+#include <charconv>
+
+namespace cmdline {
+namespace detail {
+
+using u128 = unsigned __int128;
+
+CMDLINE_INLINE bool parse_decimal(const char *&str, Decimal &number) {
+  number = { false, 0, 0 };
+  if (*str == '-' or *str == '+') {
+    number.negative = *str == '-';
+    ++str;
+  }
+  bool have_digits = false;
+  bool in_fraction = false;
+  for (;; ++str) {
+    if (*str == '.' and !in_fraction) {
+      in_fraction = true;
+      continue;
+    }
+    const unsigned digit = static_cast<unsigned char>(*str) - '0';
+    if (digit > 9) {
+      break;
+    }
+    if (__builtin_mul_overflow(number.mantissa, 10u, &number.mantissa)
+        or __builtin_add_overflow(number.mantissa, digit, &number.mantissa)) {
+      return false;
+    }
+    number.fraction_digits += in_fraction;
+    have_digits = true;
+  }
+  return have_digits;
+}
+
+CMDLINE_INLINE bool parse_scale_prefix(const char *&str, UnitRatio &unit) {
+  static constexpr char prefixes[] = "kMGTPE";
+  unit = { 1, 1 };
+  char ch = *str == 'K' ? 'k' : *str;
+  const char *p = ch ? std::strchr(prefixes, ch) : nullptr;
+  if (p == nullptr) {
+    return true;
+  }
+  const int exponent = static_cast<int>(p - prefixes) + 1;
+  const bool binary = str[1] == 'i';
+  for (int i = 0; i < exponent; ++i) {
+    unit.num *= binary ? 1024 : 1000;
+  }
+  str += 1 + binary;
+  return true;
+}
+
+CMDLINE_INLINE bool parse_time_unit(const char *&str, UnitRatio &unit) {
+  struct Entry {
+    const char *name;
+    std::size_t length;
+    UnitRatio ratio;
+  };
+  // Longer names first so `ms' and `min' are not taken for `m'
+  static constexpr Entry units[] = {
+    { "min", 3, { 60, 1 } },
+    { "ns", 2, { 1, 1'000'000'000 } },
+    { "us", 2, { 1, 1'000'000 } },
+    { "ms", 2, { 1, 1'000 } },
+    { "s", 1, { 1, 1 } },
+    { "m", 1, { 60, 1 } },
+    { "h", 1, { 3'600, 1 } },
+    { "d", 1, { 86'400, 1 } },
+  };
+  for (const Entry &e : units) {
+    if (!std::strncmp(str, e.name, e.length)) {
+      unit = e.ratio;
+      str += e.length;
+      return true;
+    }
+  }
+  return false;
+}
+
+CMDLINE_INLINE bool parse_quantity(const char *str, UnitKind kind, Decimal &number, UnitRatio &unit, const char *&rest) {
+  if (!parse_decimal(str, number)) {
+    return false;
+  }
+  if (kind == UnitKind::scale) {
+    parse_scale_prefix(str, unit);
+  }
+  else if (*str == '\0') {
+    unit = { 1, 1 };
+  }
+  else if (!parse_time_unit(str, unit)) {
+    return false;
+  }
+  rest = str;
+  return true;
+}
+
+CMDLINE_INLINE bool scale_exact(const Decimal &number, UnitRatio unit, std::uint64_t num, std::uint64_t den, std::uint64_t &result) {
+  u128 n = number.mantissa;
+  u128 d = 1;
+  for (unsigned i = 0; i < number.fraction_digits; ++i) {
+    d *= 10;
+  }
+  if (__builtin_mul_overflow(n, static_cast<u128>(unit.num), &n)
+      or __builtin_mul_overflow(n, static_cast<u128>(num), &n)
+      or __builtin_mul_overflow(d, static_cast<u128>(unit.den), &d)
+      or __builtin_mul_overflow(d, static_cast<u128>(den), &d)) {
+    return false;
+  }
+  if (n % d != 0) {
+    return false;
+  }
+  n /= d;
+  if (n > std::numeric_limits<std::uint64_t>::max()) {
+    return false;
+  }
+  result = static_cast<std::uint64_t>(n);
+  return true;
+}
+
+CMDLINE_INLINE long double scale_real(const Decimal &number, UnitRatio unit, std::uint64_t num, std::uint64_t den) {
+  long double v = static_cast<long double>(number.mantissa);
+  for (unsigned i = 0; i < number.fraction_digits; ++i) {
+    v /= 10;
+  }
+  v = v * unit.num * num / (static_cast<long double>(unit.den) * den);
+  return number.negative ? -v : v;
+}
+
+CMDLINE_INLINE void append_real(std::string &out, double value) {
+  // Fixed notation since `parse_quantity' does not take an exponent
+  char buffer[400];
+  const auto result = std::to_chars(buffer, buffer + sizeof(buffer), value, std::chars_format::fixed);
+  out.append(buffer, result.ptr);
+}
+
+CMDLINE_INLINE void append_integer(std::string &out, std::int64_t value) {
+  char buffer[24];
+  const auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+  out.append(buffer, result.ptr);
+}
+
+}
+
+CMDLINE_INLINE bool parse_value(const char *str, Bytes &value) {
+  detail::Decimal number;
+  detail::UnitRatio unit;
+  const char *rest;
+  if (!detail::parse_quantity(str, detail::UnitKind::scale, number, unit, rest)
+      or number.negative) {
+    return false;
+  }
+  if (*rest == 'B') {
+    ++rest;
+  }
+  return *rest == '\0' and detail::scale_exact(number, unit, 1, 1, value.value);
+}
+
+CMDLINE_INLINE bool parse_value(const char *str, Count &value) {
+  detail::Decimal number;
+  detail::UnitRatio unit;
+  const char *rest;
+  if (!detail::parse_quantity(str, detail::UnitKind::scale, number, unit, rest)
+      or number.negative or *rest) {
+    return false;
+  }
+  return detail::scale_exact(number, unit, 1, 1, value.value);
+}
+
+CMDLINE_INLINE bool parse_value(const char *str, Rate &value) {
+  detail::Decimal number;
+  detail::UnitRatio prefix;
+  detail::UnitRatio per;
+  const char *rest;
+  if (!detail::parse_quantity(str, detail::UnitKind::scale, number, prefix, rest)
+      or number.negative or *rest != '/') {
+    return false;
+  }
+  ++rest;
+  if (!detail::parse_time_unit(rest, per) or *rest) {
+    return false;
+  }
+  value.per_second = static_cast<double>(detail::scale_real(number, prefix, per.den, per.num));
+  return true;
+}
+
+CMDLINE_INLINE void format_value(const Bytes &value, std::string &out) {
+  char buffer[24];
+  const auto result = std::to_chars(buffer, buffer + sizeof(buffer), value.value);
+  out.append(buffer, result.ptr);
+}
+
+CMDLINE_INLINE void format_value(const Count &value, std::string &out) {
+  char buffer[24];
+  const auto result = std::to_chars(buffer, buffer + sizeof(buffer), value.value);
+  out.append(buffer, result.ptr);
+}
+
+CMDLINE_INLINE void format_value(const Rate &value, std::string &out) {
+  detail::append_real(out, value.per_second);
+  out += "/s";
+}
+
+}
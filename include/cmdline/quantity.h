@@ -0,0 +1,191 @@
+/*
+Copyright (c) 2020 Jakob Mohrbacher
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#pragma once
+
+#include <cstdint>
+
+#include <chrono>
+#include <limits>
+#include <ratio>
+#include <string>
+#include <type_traits>
+
+namespace cmdline {
+
+/**
+ * A byte size like `512', `4k', `1.5GiB'.
+ *
+ * SI suffixes (k, M, G, T, P, E, optionally followed by `B') are powers of
+ * 1000, IEC suffixes (Ki, Mi, Gi, Ti, Pi, Ei, optionally followed by `B') are
+ * powers of 1024.
+ */
+struct Bytes {
+  std::uint64_t value = 0;
+};
+
+/**
+ * A scaled count like `250', `10k', `2M', accepting the same suffixes as
+ * `Bytes' without the trailing `B'.
+ */
+struct Count {
+  std::uint64_t value = 0;
+};
+
+/**
+ * A scaled count per unit of time like `10k/s', `5/ms' or `3M/h', stored as
+ * events per second.
+ */
+struct Rate {
+  double per_second = 0.0;
+};
+
+namespace detail {
+
+/**
+ * A number split into its digits, e.g. `1.25' is {125, 2}.
+ */
+struct Decimal {
+  bool negative;
+  std::uint64_t mantissa;
+  unsigned fraction_digits;
+};
+
+/**
+ * A unit as a ratio to the base unit (bytes, 1 or seconds).
+ */
+struct UnitRatio {
+  std::uint64_t num;
+  std::uint64_t den;
+};
+
+enum class UnitKind {
+  scale,
+  duration
+};
+
+/**
+ * @brief Parses a number followed by a unit suffix of the given kind.
+ * `rest' receives the first character after the suffix.
+ * Does not allocate.
+ */
+bool parse_quantity(const char *str, UnitKind kind, Decimal &number, UnitRatio &unit, const char *&rest);
+
+/**
+ * @brief Computes number * unit.num * num / (unit.den * den), failing on
+ * overflow or if the result is not an integer.
+ */
+bool scale_exact(const Decimal &number, UnitRatio unit, std::uint64_t num, std::uint64_t den, std::uint64_t &result);
+
+long double scale_real(const Decimal &number, UnitRatio unit, std::uint64_t num, std::uint64_t den);
+
+/**
+ * @brief Appends the shortest fixed-point text that `parse_quantity' reads
+ * back as `value'.
+ */
+void append_real(std::string &out, double value);
+void append_integer(std::string &out, std::int64_t value);
+
+}
+
+bool parse_value(const char *str, Bytes &value);
+bool parse_value(const char *str, Count &value);
+bool parse_value(const char *str, Rate &value);
+
+void format_value(const Bytes &value, std::string &out);
+void format_value(const Count &value, std::string &out);
+void format_value(const Rate &value, std::string &out);
+
+/**
+ * @brief Parses a duration like `250ms', `1.5s', `2h' or `-3d'.
+ * Accepted units are ns, us, ms, s, m/min, h and d; a plain number is
+ * seconds. Fails on overflow or if the value is not representable exactly
+ * in the target duration.
+ */
+template<typename Rep, typename Period>
+bool parse_value(const char *str, std::chrono::duration<Rep, Period> &value) {
+  detail::Decimal number;
+  detail::UnitRatio unit;
+  const char *rest;
+  if (!detail::parse_quantity(str, detail::UnitKind::duration, number, unit, rest) or *rest) {
+    return false;
+  }
+  if constexpr (std::is_floating_point_v<Rep>) {
+    value = std::chrono::duration<Rep, Period>(static_cast<Rep>(
+      detail::scale_real(number, unit, Period::den, Period::num)));
+    return true;
+  }
+  else {
+    std::uint64_t magnitude;
+    if (!detail::scale_exact(number, unit, Period::den, Period::num, magnitude)) {
+      return false;
+    }
+    const std::uint64_t max = static_cast<std::uint64_t>(std::numeric_limits<Rep>::max());
+    if (!number.negative or magnitude == 0) {
+      if (magnitude > max) {
+        return false;
+      }
+      value = std::chrono::duration<Rep, Period>(static_cast<Rep>(magnitude));
+      return true;
+    }
+    if constexpr (std::is_signed_v<Rep>) {
+      // The magnitude of the minimum is one more than the maximum
+      if (magnitude - 1 > max) {
+        return false;
+      }
+      value = std::chrono::duration<Rep, Period>(-static_cast<Rep>(magnitude - 1) - 1);
+      return true;
+    }
+    else {
+      return false;
+    }
+  }
+}
+
+/**
+ * @brief Appends a duration in the form `parse_value' accepts, using the
+ * unit of `Period' if it has a suffix and seconds otherwise.
+ */
+template<typename Rep, typename Period>
+void format_value(const std::chrono::duration<Rep, Period> &value, std::string &out) {
+  const char *suffix = nullptr;
+  if constexpr (std::is_same_v<Period, std::nano>) suffix = "ns";
+  else if constexpr (std::is_same_v<Period, std::micro>) suffix = "us";
+  else if constexpr (std::is_same_v<Period, std::milli>) suffix = "ms";
+  else if constexpr (std::is_same_v<Period, std::ratio<1>>) suffix = "s";
+  else if constexpr (std::is_same_v<Period, std::ratio<60>>) suffix = "m";
+  else if constexpr (std::is_same_v<Period, std::ratio<3600>>) suffix = "h";
+  else if constexpr (std::is_same_v<Period, std::ratio<86400>>) suffix = "d";
+  if (suffix == nullptr) {
+    detail::append_real(out, static_cast<double>(value.count()) * Period::num / Period::den);
+    out += 's';
+    return;
+  }
+  if constexpr (std::is_floating_point_v<Rep>) {
+    detail::append_real(out, static_cast<double>(value.count()));
+  }
+  else {
+    detail::append_integer(out, static_cast<std::int64_t>(value.count()));
+  }
+  out += suffix;
+}
+
+}
@@ -0,0 +1,248 @@
+/*
+Copyright (c) 2020 Jakob Mohrbacher
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <vector>
+
+#include "cmdline.h"
+
+namespace cmdline {
+
+/**
+ * A parser whose options and arguments are bound to members of `Record'
+ * instead of variables, so the same parser fills any number of records.
+ * Each binding stores the member pointer and is resolved against the record
+ * given to `parse_args' or `select', so parsing many command lines does not
+ * set up a parser for each of them.
+ *
+ * Options bound to variables with the `ArgumentParser' overloads are shared
+ * by all records. `std::string_view' and `const char *' members point into
+ * the string arena of the parser, as for variables.
+ *
+ * `save_result', `load_result' and `canonical_args', and parsing through
+ * the `ArgumentParser' interface, use the selected record, which has to be
+ * alive then. Without one, as before the first `select' or after
+ * `parse_batch', they fail on the first member binding they reach (a parse
+ * with `ErrorCode::option_invalid_argument' or `argument_invalid_value'),
+ * and `dump_config' shows value-initialized members.
+ */
+template<typename Record>
+class RecordParser : public ArgumentParser {
+  Record *m_record { nullptr };
+  std::vector<const char *> Record::*m_unhandled_member { nullptr };
+  std::vector<const char *> m_unselected; //< catch-all values while no record is selected
+
+  template<typename Field>
+  detail::ValueAccess field_access(Field Record::*member);
+
+public:
+  using ArgumentParser::add_option;
+  using ArgumentParser::add_argument;
+  using ArgumentParser::parse_args;
+
+  /**
+   * @brief Adds a flag option, as `ArgumentParser::add_option', setting the
+   * member of the record being parsed.
+   */
+  bool add_option(bool Record::*member, const char *help, char short_name, const char *long_name);
+  template<typename T>
+  bool add_option(T Record::*member, const char *help, char short_name, const char *long_name, const char *argument_name = nullptr);
+  template<typename T>
+  bool add_option(std::vector<T> Record::*member, const char *help, char short_name, const char *long_name, const char *argument_name = nullptr);
+  template<typename T, std::size_t N>
+  bool add_option(std::array<T, N> Record::*member, const char *help, char short_name, const char *long_name, const char *argument_name = nullptr);
+
+  template<typename T>
+  bool add_argument(T Record::*member, const char *help, const char *name, bool required = true);
+  template<typename T, std::size_t N>
+  bool add_argument(std::array<T, N> Record::*member, const char *help, const char *name, bool required = true);
+  /**
+   * @brief Adds the catch-all argument, see `ArgumentParser::add_argument'.
+   */
+  void add_argument(std::vector<const char *> Record::*member, const char *name = "");
+
+  /**
+   * @brief Sets the record that member bindings refer to.
+   */
+  void select(Record &record) {
+    m_record = &record;
+    if (m_unhandled_member != nullptr) {
+      m_unhandled = &(record.*m_unhandled_member);
+    }
+  }
+  Record * selected() const { return m_record; }
+
+  /**
+   * @brief Parses arguments into `record'.
+   */
+  bool parse_args(Record &record, int argc, const char **argv, bool exit_on_failure = true) {
+    this->select(record);
+    return this->parse_args(argc, argv, exit_on_failure);
+  }
+
+  /**
+   * @brief Parses each command line, with the program name as its first
+   * element, into a value-initialized record appended to `records'.
+   * Records of command lines that fail to parse are reset to `Record {}'
+   * and their indices into `command_lines' appended to `failed'.
+   * Never exits; no record is selected afterwards.
+   * @return The number of command lines parsed successfully.
+   */
+  std::size_t parse_batch(const std::vector<std::vector<const char *>> &command_lines,
+                          std::vector<Record> &records, std::vector<std::size_t> *failed = nullptr);
+};
+
+///////////////////////////////////////////////////////////////////////////
+// Implementations of template functions
+
+template<typename Record>
+template<typename Field>
+detail::ValueAccess RecordParser<Record>::field_access(Field Record::*member) {
+  // Only used by `save_result', `load_result', `canonical_args' and
+  // `dump_config', which resolve the member of the selected record on each
+  // use
+  return {
+    [this, member](detail::BlobWriter &writer) {
+      return m_record != nullptr and this->save_variable(writer, m_record->*member);
+    },
+    [this, member](detail::BlobReader &reader) {
+      return m_record != nullptr and this->load_variable(reader, m_record->*member);
+    },
+    [this, member](std::vector<std::string> &texts) {
+      return m_record != nullptr and this->format_variable(m_record->*member, texts);
+    },
+    detail::type_hash<Field>(),
+    [this, member](detail::DumpWriter &writer) {
+      this->dump_variable(writer, m_record != nullptr ? m_record->*member : Field {});
+    },
+    detail::DumpTraits<Field>::type,
+    detail::DumpTraits<Field>::list,
+    [this](detail::BlobReader &reader) {
+      // Fails here so that a load without a record stores nothing
+      Field value {};
+      return m_record != nullptr and this->load_variable(reader, value);
+    }
+  };
+}
+
+template<typename Record>
+bool RecordParser<Record>::add_option(bool Record::*member, const char *help, char short_name, const char *long_name) {
+  return this->insert_option(short_name, long_name, help, nullptr, 0,
+    [this, member](const char **) -> bool {
+      if (m_record == nullptr) {
+        return false;
+      }
+      m_record->*member = true;
+      return true;
+    },
+    nullptr, this->field_access(member));
+}
+
+template<typename Record>
+template<typename T>
+bool RecordParser<Record>::add_option(T Record::*member, const char *help, char short_name, const char *long_name, const char *argument_name) {
+  return this->insert_option(short_name, long_name, help, argument_name, 1,
+    [this, member](const char **arg) -> bool {
+      return m_record != nullptr and this->convert(*arg, m_record->*member);
+    },
+    this->template value_checker<T, 1>(), this->field_access(member));
+}
+
+template<typename Record>
+template<typename T>
+bool RecordParser<Record>::add_option(std::vector<T> Record::*member, const char *help, char short_name, const char *long_name, const char *argument_name) {
+  return this->insert_option(short_name, long_name, help, argument_name, 1,
+    [this, member](const char **arg) -> bool {
+      return m_record != nullptr and this->convert_append(*arg, m_record->*member);
+    },
+    this->template value_checker<T, 1>(), this->field_access(member), sizeof(T));
+}
+
+template<typename Record>
+template<typename T, std::size_t N>
+bool RecordParser<Record>::add_option(std::array<T, N> Record::*member, const char *help, char short_name, const char *long_name, const char *argument_name) {
+  return this->insert_option(short_name, long_name, help, argument_name, N,
+    [this, member](const char **args) -> bool {
+      return m_record != nullptr and this->convert_all(args, m_record->*member);
+    },
+    this->template value_checker<T, N>(), this->field_access(member));
+}
+
+template<typename Record>
+template<typename T>
+bool RecordParser<Record>::add_argument(T Record::*member, const char *help, const char *name, bool required) {
+  return this->insert_argument(name, help, required, 1,
+    [this, member](const char **arg) -> bool {
+      return m_record != nullptr and this->convert(*arg, m_record->*member);
+    },
+    this->template value_checker<T, 1>(), this->field_access(member));
+}
+
+template<typename Record>
+template<typename T, std::size_t N>
+bool RecordParser<Record>::add_argument(std::array<T, N> Record::*member, const char *help, const char *name, bool required) {
+  return this->insert_argument(name, help, required, N,
+    [this, member](const char **args) -> bool {
+      return m_record != nullptr and this->convert_all(args, m_record->*member);
+    },
+    this->template value_checker<T, N>(), this->field_access(member));
+}
+
+template<typename Record>
+void RecordParser<Record>::add_argument(std::vector<const char *> Record::*member, const char *name) {
+  if (m_unhandled == nullptr) {
+    m_unhandled_member = member;
+    m_unhandled_name = name;
+    m_unhandled = m_record != nullptr ? &(m_record->*member) : &m_unselected;
+  }
+}
+
+template<typename Record>
+std::size_t RecordParser<Record>::parse_batch(const std::vector<std::vector<const char *>> &command_lines,
+                                              std::vector<Record> &records, std::vector<std::size_t> *failed) {
+  const std::size_t first = records.size();
+  records.resize(first + command_lines.size());
+  std::size_t parsed = 0;
+  for (std::size_t i = 0; i < command_lines.size(); ++i) {
+    Record &record = records[first + i];
+    const std::vector<const char *> &argv = command_lines[i];
+    // `parse_args' does not write to argv
+    if (this->parse_args(record, static_cast<int>(argv.size()), const_cast<const char **>(argv.data()), false)) {
+      ++parsed;
+    }
+    else {
+      record = Record {};
+      if (failed != nullptr) {
+        failed->push_back(i);
+      }
+    }
+  }
+  m_record = nullptr;
+  if (m_unhandled_member != nullptr) {
+    m_unhandled = &m_unselected;
+  }
+  return parsed;
+}
+
+}
@@ -0,0 +1,327 @@
+/*
+Copyright (c) 2020 Jakob Mohrbacher
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#pragma once
+
+#include "config.h"
+#include "cmdline.h"
+
+#include <cstddef>
+
+namespace cmdline {
+namespace detail {
+
+CMDLINE_INLINE void BlobWriter::write_string(std::string_view str) {
+  const std::uint32_t offset = static_cast<std::uint32_t>(m_strings.size());
+  const std::uint32_t length = static_cast<std::uint32_t>(str.size());
+  m_strings.insert(m_strings.end(), str.begin(), str.end());
+  m_strings.push_back('\0');
+  this->write(offset);
+  this->write(length);
+}
+
+CMDLINE_INLINE void BlobWriter::begin_record(RecordKind kind, std::uint32_t id) {
+  m_record_start = m_records.size();
+  this->write(RecordHeader { kind, id, 0 });
+}
+
+CMDLINE_INLINE void BlobWriter::end_record() {
+  const std::uint32_t size = static_cast<std::uint32_t>(m_records.size() - m_record_start - sizeof(RecordHeader));
+  std::memcpy(m_records.data() + m_record_start + offsetof(RecordHeader, size), &size, sizeof(size));
+  ++m_record_count;
+}
+
+CMDLINE_INLINE bool BlobReader::read_string(const char *&str, std::size_t &length) {
+  std::uint32_t offset;
+  std::uint32_t size;
+  if (!this->read(offset) or !this->read(size)) {
+    return false;
+  }
+  // The arena always ends in a NUL, so checking the terminator of the value
+  // also ensures it does not run past the arena
+  if (offset >= m_strings_size or size >= m_strings_size - offset or m_strings[offset + size] != '\0') {
+    return false;
+  }
+  str = m_strings + offset;
+  length = size;
+  return true;
+}
+
+CMDLINE_INLINE std::uint32_t fnv1a(std::string_view data, std::uint32_t hash) {
+  for (const char c : data) {
+    hash = (hash ^ static_cast<unsigned char>(c)) * 16777619u;
+  }
+  return hash;
+}
+
+CMDLINE_INLINE std::uint32_t hash_value(std::uint32_t hash, std::uint64_t value) {
+  return fnv1a(std::string_view(reinterpret_cast<const char *>(&value), sizeof(value)), hash);
+}
+
+}
+
+CMDLINE_INLINE std::uint32_t ArgumentParser::spec_hash() const {
+  std::uint32_t hash = detail::fnv1a("");
+  for (const Option &opt : m_options) {
+    hash = detail::hash_value(hash, static_cast<unsigned char>(opt.short_name));
+    hash = detail::fnv1a(opt.long_name, hash);
+    hash = detail::hash_value(hash, opt.nargs);
+    hash = detail::hash_value(hash, opt.value_access.type);
+  }
+  for (const Argument &arg : m_arguments) {
+    hash = detail::fnv1a(arg.name, hash);
+    hash = detail::hash_value(hash, arg.nargs);
+    hash = detail::hash_value(hash, arg.value_access.type);
+  }
+  return detail::hash_value(hash, m_unhandled != nullptr);
+}
+
+CMDLINE_INLINE bool ArgumentParser::save_result(std::vector<char> &blob) {
+  detail::BlobWriter writer;
+  std::vector<std::uint64_t> presence((m_options.size() + 63) / 64, 0);
+  for (std::size_t i = 0; i < m_options.size(); ++i) {
+    if (m_options[i].occurrences == 0 or !m_options[i].value_access.save) {
+      continue;
+    }
+    presence[i / 64] |= std::uint64_t(1) << (i % 64);
+    writer.begin_record(detail::RecordKind::option, static_cast<std::uint32_t>(i));
+    if (!m_options[i].value_access.save(writer)) {
+      return false;
+    }
+    writer.end_record();
+  }
+  for (std::size_t i = 0; i < m_argument_count; ++i) {
+    writer.begin_record(detail::RecordKind::argument, static_cast<std::uint32_t>(i));
+    if (!m_arguments[i].value_access.save(writer)) {
+      return false;
+    }
+    writer.end_record();
+  }
+  if (m_unhandled and m_unhandled_count) {
+    writer.begin_record(detail::RecordKind::unhandled, 0);
+    writer.write(static_cast<std::uint32_t>(m_unhandled_count));
+    for (std::size_t i = m_unhandled->size() - m_unhandled_count; i < m_unhandled->size(); ++i) {
+      writer.write_string((*m_unhandled)[i]);
+    }
+    writer.end_record();
+  }
+
+  detail::ResultHeader header {};
+  std::memcpy(header.magic, detail::RESULT_MAGIC, sizeof(header.magic));
+  header.version = detail::RESULT_VERSION;
+  header.spec_hash = this->spec_hash();
+  header.option_count = static_cast<std::uint32_t>(m_options.size());
+  header.record_count = writer.record_count();
+  header.records_size = static_cast<std::uint32_t>(writer.records().size());
+  header.strings_size = static_cast<std::uint32_t>(writer.strings().size());
+
+  const std::size_t presence_size = presence.size() * sizeof(std::uint64_t);
+  blob.resize(sizeof(header) + presence_size + writer.records().size() + writer.strings().size());
+  char *out = blob.data();
+  std::memcpy(out, &header, sizeof(header));
+  out += sizeof(header);
+  if (presence_size) {
+    std::memcpy(out, presence.data(), presence_size);
+    out += presence_size;
+  }
+  if (!writer.records().empty()) {
+    std::memcpy(out, writer.records().data(), writer.records().size());
+    out += writer.records().size();
+  }
+  if (!writer.strings().empty()) {
+    std::memcpy(out, writer.strings().data(), writer.strings().size());
+  }
+  return true;
+}
+
+CMDLINE_INLINE bool ArgumentParser::load_result(const void *data, std::size_t size) {
+  const char *bytes = static_cast<const char *>(data);
+  detail::ResultHeader header;
+  if (size < sizeof(header)) {
+    return false;
+  }
+  std::memcpy(&header, bytes, sizeof(header));
+  const std::size_t presence_size = (std::size_t(header.option_count) + 63) / 64 * sizeof(std::uint64_t);
+  if (std::memcmp(header.magic, detail::RESULT_MAGIC, sizeof(header.magic)) != 0
+      or header.version != detail::RESULT_VERSION
+      or header.spec_hash != this->spec_hash()
+      or header.option_count != m_options.size()
+      or size != sizeof(header) + presence_size + header.records_size + header.strings_size
+      or (header.strings_size and bytes[size - 1] != '\0')) {
+    return false;
+  }
+  const char *presence = bytes + sizeof(header);
+  const char *records = presence + presence_size;
+  const char *strings = records + header.records_size;
+  auto given = [&](std::size_t i) {
+    std::uint64_t word;
+    std::memcpy(&word, presence + i / 64 * sizeof(word), sizeof(word));
+    return (word >> (i % 64)) & 1;
+  };
+
+  // The records are read twice, first checking all of them so a malformed
+  // result changes no variable, then storing the values
+  auto read_records = [&](bool store) {
+    std::size_t argument_count = 0;
+    detail::BlobReader reader(records, header.records_size, strings, header.strings_size);
+    for (std::uint32_t r = 0; r < header.record_count; ++r) {
+      detail::RecordHeader record;
+      if (!reader.read(record) or record.size > reader.remaining()) {
+        return false;
+      }
+      const char *values = records + (header.records_size - reader.remaining());
+      detail::BlobReader value_reader(values, record.size, strings, header.strings_size);
+      reader = detail::BlobReader(values + record.size, reader.remaining() - record.size, strings, header.strings_size);
+
+      switch (record.kind) {
+        case detail::RecordKind::option: {
+          if (record.id >= m_options.size() or !given(record.id)) {
+            return false;
+          }
+          const detail::ValueAccess &access = m_options[record.id].value_access;
+          if (!(store ? access.load : access.check) or !(store ? access.load : access.check)(value_reader)) {
+            return false;
+          }
+          break;
+        }
+        case detail::RecordKind::argument: {
+          // Arguments are assigned in order
+          if (record.id != argument_count or record.id >= m_arguments.size()) {
+            return false;
+          }
+          const detail::ValueAccess &access = m_arguments[record.id].value_access;
+          if (!(store ? access.load : access.check) or !(store ? access.load : access.check)(value_reader)) {
+            return false;
+          }
+          ++argument_count;
+          break;
+        }
+        case detail::RecordKind::unhandled: {
+          std::uint32_t count;
+          if (!m_unhandled or !value_reader.read(count) or count > value_reader.remaining()) {
+            return false;
+          }
+          if (store) {
+            m_unhandled->reserve(m_unhandled->size() + count);
+          }
+          for (std::uint32_t i = 0; i < count; ++i) {
+            const char *str;
+            std::size_t length;
+            if (!value_reader.read_string(str, length)) {
+              return false;
+            }
+            if (store) {
+              m_unhandled->push_back(str);
+            }
+          }
+          if (store) {
+            m_unhandled_count += count;
+          }
+          break;
+        }
+        default:
+          return false;
+      }
+      if (value_reader.remaining() != 0) {
+        return false;
+      }
+    }
+    if (store) {
+      m_argument_count = argument_count;
+    }
+    return reader.remaining() == 0;
+  };
+  if (!read_records(false)) {
+    return false;
+  }
+
+  for (std::size_t i = 0; i < m_options.size(); ++i) {
+    m_options[i].occurrences = given(i);
+  }
+  m_unhandled_count = 0;
+  if (m_unhandled) {
+    m_unhandled->clear();
+  }
+  return read_records(true);
+}
+
+CMDLINE_INLINE bool ArgumentParser::canonical_args(std::vector<std::string> &args) {
+  std::vector<std::string> values;
+  args.clear();
+  for (const Option &opt : m_options) {
+    if (opt.occurrences == 0) {
+      continue;
+    }
+    const std::string name = opt.long_name.empty()
+      ? std::string { '-', opt.short_name }
+      : "--" + opt.long_name;
+    if (!opt.takes_argument) {
+      args.push_back(name);
+      continue;
+    }
+    values.clear();
+    if (!opt.value_access.format or !opt.value_access.format(values)) {
+      return false;
+    }
+    for (std::size_t i = 0; i + opt.nargs <= values.size(); i += opt.nargs) {
+      if (opt.nargs == 1 and !values[i].empty()) {
+        // Attached, so values starting with `-' are not taken as options
+        args.push_back(name + (opt.long_name.empty() ? "" : "=") + values[i]);
+        continue;
+      }
+      args.push_back(name);
+      for (std::size_t n = i; n < i + opt.nargs; ++n) {
+        if (values[n][0] == '-') {
+          return false;
+        }
+        args.push_back(std::move(values[n]));
+      }
+    }
+  }
+
+  for (std::size_t i = 0; i < m_argument_count; ++i) {
+    values.clear();
+    if (!m_arguments[i].value_access.format(values)) {
+      return false;
+    }
+    for (std::string &value : values) {
+      if (value[0] == '-') {
+        return false;
+      }
+      args.push_back(std::move(value));
+    }
+  }
+  // Only the catch-all argument accepts values starting with `-', after `--'
+  const std::size_t first_unhandled = args.size();
+  bool needs_terminator = false;
+  if (m_unhandled) {
+    for (std::size_t i = m_unhandled->size() - m_unhandled_count; i < m_unhandled->size(); ++i) {
+      needs_terminator |= (*m_unhandled)[i][0] == '-';
+      args.emplace_back((*m_unhandled)[i]);
+    }
+  }
+  if (needs_terminator) {
+    args.insert(args.begin() + first_unhandled, "--");
+  }
+  return true;
+}
+
+}
@@ -0,0 +1,160 @@
+/*
+Copyright (c) 2020 Jakob Mohrbacher
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+
+#include <functional>
+#include <string>
+#include <string_view>
+#include <typeinfo>
+#include <vector>
+
+#include "dump.h"
+
+namespace cmdline {
+namespace detail {
+
+/**
+ * Start of a serialized result, followed by the presence bits of the
+ * options (64 per word), the records and the string arena.
+ * Each record is a `RecordHeader' followed by `size' bytes of values.
+ */
+struct ResultHeader {
+  char magic[4];
+  std::uint32_t version;
+  std::uint32_t spec_hash;
+  std::uint32_t option_count;
+  std::uint32_t record_count;
+  std::uint32_t records_size;
+  std::uint32_t strings_size;
+  std::uint32_t reserved;
+};
+
+inline constexpr char RESULT_MAGIC[4] = { 'C', 'L', 'R', 'S' };
+inline constexpr std::uint32_t RESULT_VERSION = 1;
+
+enum class RecordKind : std::uint32_t {
+  option,
+  argument,
+  unhandled,
+};
+
+struct RecordHeader {
+  RecordKind kind;
+  std::uint32_t id;
+  std::uint32_t size;
+};
+
+/**
+ * Builds the value records and the string arena of a serialized result.
+ * Strings are stored once in the arena, NUL terminated, and referenced by
+ * offset so the result can be loaded at any address.
+ */
+class BlobWriter {
+  std::vector<char> m_records;
+  std::vector<char> m_strings;
+  std::size_t m_record_start = 0;
+  std::uint32_t m_record_count = 0;
+
+public:
+  void write(const void *data, std::size_t size) {
+    const char *bytes = static_cast<const char *>(data);
+    m_records.insert(m_records.end(), bytes, bytes + size);
+  }
+
+  template<typename T>
+  void write(const T &value) {
+    this->write(&value, sizeof(value));
+  }
+
+  void write_string(std::string_view str);
+
+  void begin_record(RecordKind kind, std::uint32_t id);
+  void end_record();
+
+  const std::vector<char> & records() const { return m_records; }
+  const std::vector<char> & strings() const { return m_strings; }
+  std::uint32_t record_count() const { return m_record_count; }
+};
+
+/**
+ * Reads the values of one record, strings are returned as pointers into
+ * the arena.
+ */
+class BlobReader {
+  const char *m_pos;
+  const char *m_end;
+  const char *m_strings;
+  std::size_t m_strings_size;
+
+public:
+  BlobReader(const char *data, std::size_t size, const char *strings, std::size_t strings_size)
+    : m_pos(data), m_end(data + size), m_strings(strings), m_strings_size(strings_size) {}
+
+  bool read(void *data, std::size_t size) {
+    if (static_cast<std::size_t>(m_end - m_pos) < size) {
+      return false;
+    }
+    std::memcpy(data, m_pos, size);
+    m_pos += size;
+    return true;
+  }
+
+  template<typename T>
+  bool read(T &value) {
+    return this->read(&value, sizeof(value));
+  }
+
+  bool read_string(const char *&str, std::size_t &length);
+
+  std::size_t remaining() const { return static_cast<std::size_t>(m_end - m_pos); }
+};
+
+/**
+ * Type-erased access to the variable bound to an option or argument.
+ */
+struct ValueAccess {
+  std::function<bool(BlobWriter &)> save;
+  std::function<bool(BlobReader &)> load;
+  /**
+   * Appends the value as text, one string per value, so it can be parsed
+   * again.
+   */
+  std::function<bool(std::vector<std::string> &)> format;
+  std::uint32_t type; //< hash of the type, to reject results of a different parser
+  std::function<void(DumpWriter &)> dump; //< writes the value for `dump_config'
+  DumpType dump_type = DumpType::none;
+  bool dump_list = false;
+  std::function<bool(BlobReader &)> check; //< reads a value as `load' does without storing it
+};
+
+std::uint32_t fnv1a(std::string_view data, std::uint32_t hash = 2166136261u);
+
+template<typename T>
+std::uint32_t type_hash() {
+  return fnv1a(typeid(T).name());
+}
+
+}
+}
@@ -0,0 +1,249 @@
+/*
+Copyright (c) 2020 Jakob Mohrbacher
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#pragma once
+
+#include "config.h"
+#include "cmdline.h"
+
+namespace cmdline {
+namespace detail {
+
+CMDLINE_INLINE std::unique_ptr<char[]> copy_string(const char *str) {
+  const std::size_t size = std::strlen(str) + 1;
+  std::unique_ptr<char[]> result(new char[size]);
+  std::memcpy(result.get(), str, size);
+  return result;
+}
+
+}
+
+CMDLINE_INLINE ParseSession::ParseSession(ArgumentParser &parser, const char *program_name)
+  : m_parser(parser), m_program_name(detail::copy_string(program_name)) {
+  m_argv.push_back(m_program_name.get());
+  this->check_global();
+}
+
+CMDLINE_INLINE void ParseSession::assign(std::size_t count, const char *const *tokens) {
+  m_tokens.clear();
+  m_argv.resize(1);
+  for (std::size_t i = 0; i < count; ++i) {
+    m_tokens.push_back(detail::copy_string(tokens[i]));
+    m_argv.push_back(m_tokens.back().get());
+  }
+  m_states.assign(count, TokenState {});
+  m_hits.clear();
+  m_first_new = 0;
+  m_end_new = count;
+  this->reparse(0, 0);
+}
+
+CMDLINE_INLINE void ParseSession::edit(std::size_t first, std::size_t count, const char *const *tokens, std::size_t n) {
+  first = std::min(first, m_tokens.size());
+  count = std::min(count, m_tokens.size() - first);
+
+  // An item looks at no more tokens after its first one than it takes
+  // values, so only the items starting that far before the edit can change.
+  std::size_t lookahead = 1;
+  for (const Option &opt : m_parser.m_options) {
+    lookahead = std::max(lookahead, opt.nargs);
+  }
+  for (const Argument &arg : m_parser.m_arguments) {
+    lookahead = std::max(lookahead, arg.nargs);
+  }
+  std::size_t start = first > lookahead ? first - lookahead : 0;
+  while (start > 0 and m_states[start].item_length == 0) {
+    --start;
+  }
+
+  m_tokens.erase(m_tokens.begin() + first, m_tokens.begin() + first + count);
+  m_argv.erase(m_argv.begin() + first + 1, m_argv.begin() + first + 1 + count);
+  m_states.erase(m_states.begin() + first, m_states.begin() + first + count);
+  for (std::size_t i = 0; i < n; ++i) {
+    m_tokens.insert(m_tokens.begin() + first + i, detail::copy_string(tokens[i]));
+    m_argv.insert(m_argv.begin() + first + 1 + i, m_tokens[first + i].get());
+  }
+  m_states.insert(m_states.begin() + first, n, TokenState {});
+
+  m_first_new = first;
+  m_end_new = first + n;
+  this->reparse(start, static_cast<std::ptrdiff_t>(n) - static_cast<std::ptrdiff_t>(count));
+}
+
+CMDLINE_INLINE void ParseSession::reparse(std::size_t start, std::ptrdiff_t delta) {
+  std::size_t argind = 0;
+  bool terminated = false;
+  if (start < m_first_new) {
+    argind = m_states[start].argind;
+    terminated = m_states[start].terminated;
+  }
+
+  // Hits from `start' on are found again, those after the point where the
+  // parse catches up with the previous one are kept.
+  const auto split = std::lower_bound(m_hits.begin(), m_hits.end(), start,
+    [](const Hit &hit, std::size_t token) { return hit.token < token; });
+  const std::vector<Hit> tail(split, m_hits.end());
+  m_hits.erase(split, m_hits.end());
+
+  m_parser.m_session = this;
+  const int argc = static_cast<int>(m_argv.size());
+  const char **argv = m_argv.data();
+  std::size_t t = start;
+  bool caught_up = false;
+  m_reparsed = 0;
+  while (t < m_tokens.size()) {
+    const TokenState &old = m_states[t];
+    if (t >= m_end_new and old.item_length != 0 and old.argind == argind and old.terminated == terminated) {
+      caught_up = true;
+      break;
+    }
+
+    const std::uint32_t item_argind = static_cast<std::uint32_t>(argind);
+    const bool item_terminated = terminated;
+    m_head = t;
+    m_item_values.clear();
+    m_item_has_error = false;
+    int i = static_cast<int>(t) + 1;
+    m_parser.parse_item(argc, argv, i, argind, terminated);
+    const std::size_t last = std::max(static_cast<std::size_t>(i) - 1, t);
+
+    for (std::size_t k = t; k <= last; ++k) {
+      m_states[k] = TokenState {};
+    }
+    TokenState &head = m_states[t];
+    head.item_length = static_cast<std::uint32_t>(last - t + 1);
+    head.argind = item_argind;
+    head.terminated = item_terminated;
+    head.has_error = m_item_has_error;
+    head.error = m_item_error;
+    if (m_item_has_error and head.error.argv_index >= 0) {
+      head.error.argv_index -= static_cast<std::int32_t>(t + 1);
+    }
+    for (const ItemValue &v : m_item_values) {
+      m_states[v.token].value = v.value;
+      m_states[v.token].owner = v.owner;
+      m_states[v.token].converted = v.converted;
+    }
+    m_reparsed += last - t + 1;
+    t = last + 1;
+  }
+  m_parser.m_session = nullptr;
+
+  if (caught_up) {
+    const std::size_t resume = static_cast<std::size_t>(static_cast<std::ptrdiff_t>(t) - delta);
+    for (const Hit &hit : tail) {
+      if (hit.token >= resume) {
+        m_hits.push_back({ static_cast<std::uint32_t>(hit.token + delta), hit.option });
+      }
+    }
+  }
+  else {
+    m_final_argind = argind;
+  }
+  this->check_global();
+}
+
+CMDLINE_INLINE void ParseSession::check_global() {
+  m_global.clear();
+  m_parser.m_session = this;
+  m_global_check = true;
+  const char **argv = m_argv.data();
+  if (!m_parser.m_constraints.empty()) {
+    detail::OptionSet present;
+    present.clear(m_parser.m_options.size());
+    for (const Hit &hit : m_hits) {
+      present.insert(hit.option);
+    }
+    // The help option is always the first one
+    if (!present.contains(0)) {
+      m_parser.check_constraints(argv, present);
+    }
+  }
+  m_parser.check_required_arguments(argv, m_final_argind);
+  m_global_check = false;
+  m_parser.m_session = nullptr;
+}
+
+CMDLINE_INLINE bool ParseSession::convert(bool is_option, std::size_t owner, const char **args, int argv_index) {
+  if (is_option) {
+    m_hits.push_back({ static_cast<std::uint32_t>(m_head), static_cast<std::uint32_t>(owner) });
+  }
+  if (args == nullptr) {
+    return true;
+  }
+  const std::size_t token = static_cast<std::size_t>(argv_index) - 1;
+  const std::size_t nargs = is_option ? m_parser.m_options[owner].nargs : m_parser.m_arguments[owner].nargs;
+  const ValueKind value = is_option ? option_value : argument_value;
+
+  // Values that did not change and belong to the same option or argument
+  // as before convert the same way; failures convert again to find the
+  // value that failed
+  const TokenState &old = m_states[token];
+  const bool unchanged = token + nargs <= m_first_new or token >= m_end_new;
+  bool ok;
+  if (unchanged and old.value == value and old.owner == owner and old.converted) {
+    ok = true;
+  }
+  else if (is_option) {
+    ok = m_parser.m_options[owner].check_value(args);
+  }
+  else {
+    ok = m_parser.m_arguments[owner].check_value(args);
+  }
+  m_item_values.push_back({ static_cast<std::uint32_t>(token), value, static_cast<std::uint32_t>(owner), ok });
+  return ok;
+}
+
+CMDLINE_INLINE void ParseSession::record(const Diagnostic &d) {
+  if (m_global_check) {
+    m_global.push_back(d);
+  }
+  else if (!m_item_has_error) {
+    m_item_has_error = true;
+    m_item_error = d;
+  }
+}
+
+CMDLINE_INLINE bool ParseSession::valid() const {
+  return m_global.empty() and std::none_of(m_states.begin(), m_states.end(),
+    [](const TokenState &state) { return state.has_error; });
+}
+
+CMDLINE_INLINE std::vector<Diagnostic> ParseSession::diagnostics() const {
+  std::vector<Diagnostic> result;
+  for (std::size_t t = 0; t < m_states.size(); ++t) {
+    if (m_states[t].has_error) {
+      Diagnostic d = m_states[t].error;
+      if (d.argv_index >= 0) {
+        d.argv_index += static_cast<std::int32_t>(t + 1);
+      }
+      result.push_back(d);
+    }
+  }
+  result.insert(result.end(), m_global.begin(), m_global.end());
+  return result;
+}
+
+CMDLINE_INLINE bool ParseSession::apply() {
+  return m_parser.parse_args(static_cast<int>(m_argv.size()), m_argv.data(), false);
+}
+
+}
@@ -0,0 +1,152 @@
+/*
+Copyright (c) 2020 Jakob Mohrbacher
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#pragma once
+
+#include <cstdint>
+
+#include <initializer_list>
+#include <memory>
+#include <vector>
+
+#include "diagnostic.h"
+
+namespace cmdline {
+
+class ArgumentParser;
+
+/**
+ * Keeps per-token parse state for a command line that is being edited, so
+ * that an edit only re-parses the tokens it affects.
+ *
+ * After an edit, parsing restarts at the first option or argument that
+ * could have looked at the edited tokens. It stops at the first unchanged
+ * token where the parse state (`--' seen, positional arguments assigned)
+ * matches the previous parse; everything after that is kept. Conversion
+ * results of unchanged tokens that keep their meaning are reused.
+ *
+ * Values are only checked, the variables bound to the parser are written by
+ * `apply'. Unlike `parse_args', an error does not end the parse, it resumes
+ * after the offending token so every error in the line is known. Validators
+ * and limits are only run by `apply'.
+ */
+class ParseSession {
+public:
+  explicit ParseSession(ArgumentParser &parser, const char *program_name = "");
+
+  /**
+   * @brief Replaces the whole command line, without the program name.
+   */
+  void assign(std::size_t count, const char *const *tokens);
+  /**
+   * @brief Replaces `count' tokens starting at `first' with `tokens'.
+   */
+  void edit(std::size_t first, std::size_t count, const char *const *tokens, std::size_t n);
+  void edit(std::size_t first, std::size_t count, std::initializer_list<const char *> tokens) {
+    this->edit(first, count, tokens.begin(), tokens.size());
+  }
+
+  /**
+   * @brief Number of tokens, without the program name.
+   */
+  std::size_t size() const { return m_tokens.size(); }
+  /**
+   * @brief The command line as an argv array, `argv()[0]' is the program
+   * name. Invalidated by edits.
+   */
+  const char *const *argv() const { return m_argv.data(); }
+
+  bool valid() const;
+  /**
+   * @brief Every error in the command line, in order; the `argv_index' of
+   * each refers to `argv()'.
+   */
+  std::vector<Diagnostic> diagnostics() const;
+  /**
+   * @brief Number of tokens the last edit parsed again.
+   */
+  std::size_t reparsed() const { return m_reparsed; }
+
+  /**
+   * @brief Parses the command line with `ArgumentParser::parse_args',
+   * storing the values. Stored `const char *' values point into the
+   * session and are invalidated by edits.
+   */
+  bool apply();
+
+private:
+  friend class ArgumentParser;
+  enum ValueKind : std::uint8_t {
+    no_value,
+    option_value,
+    argument_value,
+  };
+
+  struct TokenState {
+    std::uint32_t item_length; //< number of tokens of the item starting here, 0 if none does
+    std::uint32_t argind;      //< positional arguments assigned before the item
+    std::uint32_t owner;       //< option or argument a value belongs to
+    bool terminated;           //< `--' seen before the item
+    ValueKind value;           //< set on the first value token of an option or argument
+    bool converted;            //< conversion result of the values
+    bool has_error;
+    Diagnostic error;          //< `argv_index' is relative to the item
+  };
+
+  struct Hit {
+    std::uint32_t token;
+    std::uint32_t option;
+  };
+
+  ArgumentParser &m_parser;
+  std::unique_ptr<char[]> m_program_name;
+  std::vector<std::unique_ptr<char[]>> m_tokens;
+  std::vector<const char *> m_argv;
+  std::vector<TokenState> m_states;
+  std::vector<Hit> m_hits; //< options given, ordered by token
+  std::size_t m_final_argind = 0;
+  std::vector<Diagnostic> m_global; //< errors not tied to a token
+
+  // State of the edit being parsed
+  std::size_t m_first_new = 0; //< first token of the edit
+  std::size_t m_end_new = 0;   //< one past the last token of the edit
+  std::size_t m_head = 0;      //< first token of the item being parsed
+  struct ItemValue {
+    std::uint32_t token;
+    ValueKind value;
+    std::uint32_t owner;
+    bool converted;
+  };
+  std::vector<ItemValue> m_item_values;
+  bool m_item_has_error = false;
+  Diagnostic m_item_error {};
+  bool m_global_check = false;
+  std::size_t m_reparsed = 0;
+
+  void reparse(std::size_t start, std::ptrdiff_t delta);
+  void check_global();
+
+  // Called by `ArgumentParser' while the session is parsing
+  bool convert(bool is_option, std::size_t owner, const char **args, int argv_index);
+  void record(const Diagnostic &d);
+};
+
+}
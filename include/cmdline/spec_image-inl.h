@@ -0,0 +1,381 @@
+/*
+Copyright (c) 2020 Jakob Mohrbacher
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#pragma once
+
+#include "config.h"
+#include "cmdline.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <charconv>
+#include <unordered_map>
+
+namespace cmdline {
+
+CMDLINE_INLINE bool parse_spec_schema(std::string_view text, std::vector<SpecSchemaOption> &options, std::size_t &error_line) {
+  constexpr std::size_t FIELDS = 5;
+  std::string line;
+  const char *fields[FIELDS + 2];
+  for (std::size_t number = 1; !text.empty(); ++number) {
+    const std::size_t end = text.find('\n');
+    line.assign(text.substr(0, end));
+    text.remove_prefix(end == std::string_view::npos ? text.size() : end + 1);
+    if (!line.empty() and line.back() == '\r') {
+      line.pop_back();
+    }
+    const std::size_t first = line.find_first_not_of(" \t");
+    if (first == std::string::npos or line[first] == '#') {
+      continue;
+    }
+    error_line = number;
+    const TokenizeResult words = tokenize(line.data(), fields, FIELDS + 2);
+    if (!words or words.count != FIELDS) {
+      return false;
+    }
+
+    SpecSchemaOption &opt = options.emplace_back();
+    const std::string_view short_name = fields[0];
+    const std::string_view long_name = fields[1];
+    if (short_name != "-") {
+      if (short_name.length() != 1) {
+        return false;
+      }
+      opt.short_name = short_name[0];
+    }
+    if (long_name != "-") {
+      if (long_name.empty() or long_name[0] == '-' or long_name.find('=') != std::string_view::npos) {
+        return false;
+      }
+      opt.long_name = long_name;
+    }
+    if (opt.short_name == 0 and opt.long_name.empty()) {
+      return false;
+    }
+    const std::string_view nargs = fields[2];
+    const auto [ptr, ec] = std::from_chars(nargs.data(), nargs.data() + nargs.size(), opt.nargs);
+    if (ec != std::errc {} or ptr != nargs.data() + nargs.size()) {
+      return false;
+    }
+    if (opt.nargs > 0) {
+      opt.argument_name = std::string_view(fields[3]) != "-"
+        ? fields[3]
+        : detail::get_argument_name(opt.short_name, opt.long_name.empty() ? nullptr : opt.long_name.c_str());
+    }
+    opt.help = fields[4];
+  }
+  return true;
+}
+
+namespace detail {
+
+// Same layout as `ArgumentParser::usage'
+CMDLINE_INLINE void append_usage_line(std::string &out, const SpecSchemaOption &opt) {
+  constexpr std::size_t NAMES_WIDTH = 24;
+  const std::size_t start = out.size();
+  out += "  ";
+  if (opt.short_name != 0) {
+    out += '-';
+    out += opt.short_name;
+    if (!opt.long_name.empty()) {
+      out += ", ";
+    }
+  }
+  if (!opt.long_name.empty()) {
+    out += "--";
+    out += opt.long_name;
+  }
+  if (opt.nargs > 0) {
+    out += ' ';
+    for (std::size_t n = 0; n < opt.nargs; ++n) {
+      out += ' ';
+      out += opt.argument_name;
+    }
+  }
+  std::size_t written = out.size() - start;
+  if (written >= NAMES_WIDTH) {
+    out += '\n';
+    written = 0;
+  }
+  out.append(NAMES_WIDTH - written, ' ');
+  out += opt.help;
+  out += '\n';
+}
+
+template<typename T>
+CMDLINE_INLINE void append_table(std::vector<char> &image, std::uint32_t &offset, const T *data, std::size_t count) {
+  offset = static_cast<std::uint32_t>(image.size());
+  const char *bytes = reinterpret_cast<const char *>(data);
+  image.insert(image.end(), bytes, bytes + count * sizeof(T));
+}
+
+}
+
+CMDLINE_INLINE bool build_spec_image(const std::vector<SpecSchemaOption> &options, std::vector<char> &image) {
+  std::vector<char> strings;
+  std::unordered_map<std::string_view, std::uint32_t> interned;
+  // The keys point into the options, which outlive the map
+  auto intern = [&](const std::string &s) {
+    const auto [it, inserted] = interned.try_emplace(s, static_cast<std::uint32_t>(strings.size()));
+    if (inserted) {
+      strings.insert(strings.end(), s.begin(), s.end());
+      strings.push_back('\0');
+    }
+    return it->second;
+  };
+
+  std::vector<detail::SpecImageOption> entries;
+  entries.reserve(options.size());
+  std::vector<std::uint32_t> short_index(256, detail::SPEC_NO_OPTION);
+  std::unordered_map<std::string_view, std::uint32_t> long_names;
+  std::string usage;
+  for (std::size_t i = 0; i < options.size(); ++i) {
+    const SpecSchemaOption &opt = options[i];
+    const std::uint32_t index = static_cast<std::uint32_t>(i);
+    if (opt.short_name != 0) {
+      std::uint32_t &slot = short_index[static_cast<unsigned char>(opt.short_name)];
+      if (slot != detail::SPEC_NO_OPTION) {
+        return false;
+      }
+      slot = index;
+    }
+    if (!opt.long_name.empty() and !long_names.try_emplace(opt.long_name, index).second) {
+      return false;
+    }
+    entries.push_back({
+      intern(opt.long_name), static_cast<std::uint32_t>(opt.long_name.length()),
+      intern(opt.argument_name), static_cast<std::uint32_t>(opt.argument_name.length()),
+      intern(opt.help), static_cast<std::uint32_t>(opt.help.length()),
+      opt.nargs, static_cast<unsigned char>(opt.short_name)
+    });
+    detail::append_usage_line(usage, opt);
+  }
+
+  // Open addressing with linear probing, at most half full
+  std::uint32_t slots = 1;
+  while (slots < 2 * options.size()) {
+    slots *= 2;
+  }
+  std::vector<std::uint32_t> hash(slots, 0);
+  for (const auto &[name, index] : long_names) {
+    std::uint32_t slot = detail::fnv1a(name) & (slots - 1);
+    while (hash[slot] != 0) {
+      slot = (slot + 1) & (slots - 1);
+    }
+    hash[slot] = index + 1;
+  }
+
+  std::vector<std::uint32_t> sorted;
+  sorted.reserve(long_names.size());
+  for (const auto &entry : long_names) {
+    sorted.push_back(entry.second);
+  }
+  std::sort(sorted.begin(), sorted.end(), [&](std::uint32_t a, std::uint32_t b) {
+    return options[a].long_name < options[b].long_name;
+  });
+
+  detail::SpecImageHeader header {};
+  std::memcpy(header.magic, detail::SPEC_IMAGE_MAGIC, sizeof(header.magic));
+  header.version = detail::SPEC_IMAGE_VERSION;
+  header.option_count = static_cast<std::uint32_t>(options.size());
+  header.hash_slots = slots;
+  header.sorted_count = static_cast<std::uint32_t>(sorted.size());
+  header.strings_size = static_cast<std::uint32_t>(strings.size());
+  header.usage_size = static_cast<std::uint32_t>(usage.size());
+
+  image.assign(sizeof(header), '\0');
+  detail::append_table(image, header.options, entries.data(), entries.size());
+  detail::append_table(image, header.hash, hash.data(), hash.size());
+  detail::append_table(image, header.sorted, sorted.data(), sorted.size());
+  detail::append_table(image, header.short_index, short_index.data(), short_index.size());
+  detail::append_table(image, header.strings, strings.data(), strings.size());
+  detail::append_table(image, header.usage, usage.data(), usage.size());
+  header.size = static_cast<std::uint32_t>(image.size());
+  std::memcpy(image.data(), &header, sizeof(header));
+  return true;
+}
+
+CMDLINE_INLINE SpecImage::~SpecImage() {
+  this->unmap();
+}
+
+CMDLINE_INLINE bool SpecImage::map(const char *path) {
+  this->unmap();
+  const int fd = ::open(path, O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    return false;
+  }
+  struct stat st;
+  void *data = MAP_FAILED;
+  if (::fstat(fd, &st) == 0 and st.st_size > 0) {
+    data = ::mmap(nullptr, static_cast<std::size_t>(st.st_size), PROT_READ, MAP_SHARED, fd, 0);
+  }
+  ::close(fd);
+  if (data == MAP_FAILED) {
+    return false;
+  }
+  if (!this->load(data, static_cast<std::size_t>(st.st_size))) {
+    ::munmap(data, static_cast<std::size_t>(st.st_size));
+    return false;
+  }
+  m_mapped = true;
+  return true;
+}
+
+CMDLINE_INLINE bool SpecImage::load(const void *data, std::size_t size) {
+  this->unmap();
+  if (size < sizeof(detail::SpecImageHeader)
+      or reinterpret_cast<std::uintptr_t>(data) % alignof(std::uint32_t) != 0) {
+    return false;
+  }
+  const detail::SpecImageHeader &h = *static_cast<const detail::SpecImageHeader *>(data);
+  auto table_fits = [&](std::uint64_t offset, std::uint64_t count, std::uint64_t element) {
+    return offset % alignof(std::uint32_t) == 0 and offset + count * element <= size;
+  };
+  if (std::memcmp(h.magic, detail::SPEC_IMAGE_MAGIC, sizeof(h.magic)) != 0
+      or h.version != detail::SPEC_IMAGE_VERSION
+      or h.size != size
+      or h.hash_slots == 0 or (h.hash_slots & (h.hash_slots - 1)) != 0
+      or h.sorted_count > h.option_count
+      or !table_fits(h.options, h.option_count, sizeof(detail::SpecImageOption))
+      or !table_fits(h.hash, h.hash_slots, sizeof(std::uint32_t))
+      or !table_fits(h.sorted, h.sorted_count, sizeof(std::uint32_t))
+      or !table_fits(h.short_index, 256, sizeof(std::uint32_t))
+      or !table_fits(h.strings, h.strings_size, 1)
+      or h.usage > size or h.usage_size > size - h.usage) {
+    return false;
+  }
+  // The prefix search reads the options the sorted table refers to before
+  // it knows which one it returns
+  const std::uint32_t *sorted = reinterpret_cast<const std::uint32_t *>(static_cast<const char *>(data) + h.sorted);
+  for (std::uint32_t i = 0; i < h.sorted_count; ++i) {
+    if (sorted[i] >= h.option_count) {
+      return false;
+    }
+  }
+  m_data = static_cast<const char *>(data);
+  m_size = size;
+  return true;
+}
+
+CMDLINE_INLINE void SpecImage::unmap() {
+  if (m_mapped) {
+    ::munmap(const_cast<char *>(m_data), m_size);
+  }
+  m_data = nullptr;
+  m_size = 0;
+  m_mapped = false;
+}
+
+CMDLINE_INLINE std::string_view SpecImage::string(std::uint32_t offset, std::uint32_t length) const {
+  const detail::SpecImageHeader &h = this->header();
+  if (offset > h.strings_size or length > h.strings_size - offset) {
+    return {};
+  }
+  return std::string_view(m_data + h.strings + offset, length);
+}
+
+CMDLINE_INLINE SpecImage::Option SpecImage::option(std::size_t index) const {
+  const detail::SpecImageOption &e = this->entry(index);
+  return {
+    static_cast<char>(e.short_name),
+    this->string(e.long_name, e.long_length),
+    this->string(e.argument_name, e.argument_length),
+    this->string(e.help, e.help_length),
+    e.nargs
+  };
+}
+
+CMDLINE_INLINE std::size_t SpecImage::find(std::string_view long_name) const {
+  if (m_data == nullptr or long_name.empty()) {
+    return npos;
+  }
+  const detail::SpecImageHeader &h = this->header();
+  const std::uint32_t *hash = this->table(h.hash);
+  const std::uint32_t mask = h.hash_slots - 1;
+  std::uint32_t slot = detail::fnv1a(long_name) & mask;
+  for (std::uint32_t probes = 0; probes < h.hash_slots; ++probes, slot = (slot + 1) & mask) {
+    const std::uint32_t value = hash[slot];
+    if (value == 0 or value > h.option_count) {
+      return npos;
+    }
+    const detail::SpecImageOption &e = this->entry(value - 1);
+    if (this->string(e.long_name, e.long_length) == long_name) {
+      return value - 1;
+    }
+  }
+  return npos;
+}
+
+CMDLINE_INLINE std::size_t SpecImage::find(char short_name) const {
+  if (m_data == nullptr or short_name == 0) {
+    return npos;
+  }
+  const std::uint32_t index = this->table(this->header().short_index)[static_cast<unsigned char>(short_name)];
+  return index < this->header().option_count ? index : npos;
+}
+
+CMDLINE_INLINE std::size_t SpecImage::find_prefix(std::string_view prefix, bool &ambiguous) const {
+  ambiguous = false;
+  if (m_data == nullptr or prefix.empty()) {
+    return npos;
+  }
+  const detail::SpecImageHeader &h = this->header();
+  const std::uint32_t *sorted = this->table(h.sorted);
+  auto name = [&](std::uint32_t i) {
+    const detail::SpecImageOption &e = this->entry(sorted[i]);
+    return this->string(e.long_name, e.long_length);
+  };
+  // An exact match sorts before all other names starting with the prefix
+  std::uint32_t first = 0;
+  std::uint32_t count = h.sorted_count;
+  while (count > 0) {
+    const std::uint32_t step = count / 2;
+    if (name(first + step) < prefix) {
+      first += step + 1;
+      count -= step + 1;
+    }
+    else {
+      count = step;
+    }
+  }
+  if (first == h.sorted_count or !name(first).starts_with(prefix)) {
+    return npos;
+  }
+  if (name(first).length() != prefix.length()
+      and first + 1 < h.sorted_count and name(first + 1).starts_with(prefix)) {
+    ambiguous = true;
+    return npos;
+  }
+  return sorted[first];
+}
+
+CMDLINE_INLINE std::string_view SpecImage::usage() const {
+  if (m_data == nullptr) {
+    return {};
+  }
+  return std::string_view(m_data + this->header().usage, this->header().usage_size);
+}
+
+}
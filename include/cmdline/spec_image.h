@@ -0,0 +1,190 @@
+/*
+Copyright (c) 2020 Jakob Mohrbacher
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#pragma once
+
+#include <cstdint>
+
+#include <limits>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace cmdline {
+
+namespace detail {
+
+/**
+ * Start of a spec image. All offsets are from the start of the image and
+ * all tables are arrays of 32 bit words, so the image is used in place.
+ */
+struct SpecImageHeader {
+  char magic[4];
+  std::uint32_t version;
+  std::uint32_t size;           //< of the whole image
+  std::uint32_t option_count;
+  std::uint32_t options;        //< `SpecImageOption' per option
+  std::uint32_t hash_slots;     //< power of two
+  std::uint32_t hash;           //< option index + 1 per slot, 0 if empty
+  std::uint32_t sorted_count;
+  std::uint32_t sorted;         //< indices of options with a long name, by name
+  std::uint32_t short_index;    //< option index per character, `NO_OPTION' if none
+  std::uint32_t strings;        //< NUL terminated, each stored once
+  std::uint32_t strings_size;
+  std::uint32_t usage;          //< the option lines of the usage text
+  std::uint32_t usage_size;
+};
+
+struct SpecImageOption {
+  std::uint32_t long_name;      //< offset into the strings
+  std::uint32_t long_length;
+  std::uint32_t argument_name;
+  std::uint32_t argument_length;
+  std::uint32_t help;
+  std::uint32_t help_length;
+  std::uint32_t nargs;
+  std::uint32_t short_name;
+};
+
+/**
+ * An occurrence of a spec image option in a parse, its values start at
+ * `first_value' in the collected values.
+ */
+struct SpecHit {
+  std::uint32_t option;
+  std::uint32_t first_value;
+};
+
+inline constexpr char SPEC_IMAGE_MAGIC[4] = { 'C', 'L', 'S', 'P' };
+inline constexpr std::uint32_t SPEC_IMAGE_VERSION = 1;
+inline constexpr std::uint32_t SPEC_NO_OPTION = 0xffffffff;
+
+}
+
+/**
+ * An option as written in a schema, see `parse_spec_schema'.
+ */
+struct SpecSchemaOption {
+  char short_name = 0;
+  std::string long_name;
+  std::string argument_name;
+  std::string help;
+  std::uint32_t nargs = 0;
+};
+
+/**
+ * @brief Reads an option schema: one option per line as
+ * `SHORT LONG NARGS ARGUMENT_NAME HELP', with `-' for a missing short name,
+ * long name or argument name (which then defaults as for `add_option').
+ * Fields are split like a shell command line, so a help text with spaces
+ * needs quotes. Empty lines and lines starting with `#' are skipped.
+ * Returns false and sets `error_line' (1 based) on a malformed line.
+ */
+bool parse_spec_schema(std::string_view text, std::vector<SpecSchemaOption> &options, std::size_t &error_line);
+
+/**
+ * @brief Builds a spec image from schema options.
+ * Returns false if a short or long name is given twice.
+ */
+bool build_spec_image(const std::vector<SpecSchemaOption> &options, std::vector<char> &image);
+
+/**
+ * A prebuilt option spec, generated from a schema at build time by the
+ * `cmdline_spec' tool (see `cmdline_add_spec_image' in
+ * cmake/CmdlineSpec.cmake) and used in place: lookups go through the hash
+ * table, the sorted name table and the short name index stored in the
+ * image, and names and help texts point into it. Mapping a file shares its
+ * pages between all processes using it.
+ *
+ * The image uses the byte order of the machine that built it.
+ */
+class SpecImage {
+  const char *m_data { nullptr };
+  std::size_t m_size { 0 };
+  bool m_mapped { false };
+
+  const detail::SpecImageHeader & header() const {
+    return *reinterpret_cast<const detail::SpecImageHeader *>(m_data);
+  }
+  const std::uint32_t * table(std::uint32_t offset) const {
+    return reinterpret_cast<const std::uint32_t *>(m_data + offset);
+  }
+  const detail::SpecImageOption & entry(std::size_t index) const {
+    return reinterpret_cast<const detail::SpecImageOption *>(m_data + this->header().options)[index];
+  }
+  std::string_view string(std::uint32_t offset, std::uint32_t length) const;
+
+public:
+  static constexpr std::size_t npos = std::numeric_limits<std::size_t>::max();
+
+  struct Option {
+    char short_name;
+    std::string_view long_name;
+    std::string_view argument_name;
+    std::string_view help;
+    std::size_t nargs;
+  };
+
+  SpecImage() = default;
+  SpecImage(const SpecImage &) = delete;
+  SpecImage & operator=(const SpecImage &) = delete;
+  ~SpecImage();
+
+  /**
+   * @brief Maps an image file read-only.
+   * Returns false if the file can not be mapped or is not a valid image.
+   */
+  bool map(const char *path);
+
+  /**
+   * @brief Uses an image in memory, like one embedded in the program, which
+   * has to stay valid and be aligned to 4 bytes.
+   * Only the header and the table bounds are checked, the contents of a
+   * generated image are trusted.
+   */
+  bool load(const void *data, std::size_t size);
+
+  void unmap();
+
+  bool valid() const { return m_data != nullptr; }
+
+  std::size_t option_count() const { return m_data ? this->header().option_count : 0; }
+
+  Option option(std::size_t index) const;
+
+  std::size_t find(std::string_view long_name) const;
+  std::size_t find(char short_name) const;
+
+  /**
+   * @brief Finds the option a possibly abbreviated long name refers to: an
+   * exact match, or the only option starting with `prefix'.
+   * Sets `ambiguous' if there are several and no exact match.
+   */
+  std::size_t find_prefix(std::string_view prefix, bool &ambiguous) const;
+
+  /**
+   * @brief The option lines of the usage text, laid out like
+   * `ArgumentParser::usage'.
+   */
+  std::string_view usage() const;
+};
+
+}
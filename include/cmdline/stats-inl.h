@@ -0,0 +1,127 @@
+/*
+Copyright (c) 2020 Jakob Mohrbacher
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#pragma once
+
+#include "config.h"
+#include "cmdline.h"
+
+namespace cmdline {
+
+CMDLINE_INLINE const char *phase_name(Phase phase) {
+  switch (phase) {
+  case Phase::tokenization: return "tokenization";
+  case Phase::lookup: return "lookup";
+  case Phase::conversion: return "conversion";
+  case Phase::validation: return "validation";
+  case Phase::usage: return "usage";
+  }
+  return "";
+}
+
+CMDLINE_INLINE void ParseStats::reset(std::size_t options, std::size_t arguments) {
+  phase_ns.fill(0);
+  phase_calls.fill(0);
+  option_hits.assign(options, 0);
+  option_conversion_failures.assign(options, 0);
+  argument_hits.assign(arguments, 0);
+  argument_conversion_failures.assign(arguments, 0);
+  events.clear();
+}
+
+namespace detail {
+
+CMDLINE_INLINE thread_local PhaseTimer *PhaseTimer::s_current = nullptr;
+
+CMDLINE_INLINE void write_json_string(FILE *file, std::string_view str) {
+  std::fputc('"', file);
+  for (char ch : str) {
+    if (ch == '"' or ch == '\\') {
+      std::fputc('\\', file);
+      std::fputc(ch, file);
+    }
+    else if (static_cast<unsigned char>(ch) < 0x20) {
+      std::fprintf(file, "\\u%04x", ch);
+    }
+    else {
+      std::fputc(ch, file);
+    }
+  }
+  std::fputc('"', file);
+}
+
+}
+
+CMDLINE_INLINE bool ArgumentParser::write_stats(FILE *file, StatsFormat format) const {
+  const ParseStats &s = m_stats;
+
+  if (format == StatsFormat::chrome_trace) {
+    std::fputs("{\"traceEvents\":[", file);
+    // Events are recorded when they end, so inner phases come first
+    std::uint64_t origin = s.events.empty() ? 0 : s.events.front().begin_ns;
+    for (const ParseStats::TraceEvent &e : s.events) {
+      origin = std::min(origin, e.begin_ns);
+    }
+    for (std::size_t i = 0; i < s.events.size(); ++i) {
+      const ParseStats::TraceEvent &e = s.events[i];
+      std::fprintf(file, "%s{\"name\":\"%s\",\"cat\":\"cmdline\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":0,\"tid\":0}",
+        i ? "," : "", phase_name(e.phase),
+        static_cast<double>(e.begin_ns - origin) / 1000.0,
+        static_cast<double>(e.end_ns - e.begin_ns) / 1000.0);
+    }
+    std::fputs("],\"displayTimeUnit\":\"ns\"}\n", file);
+    return !std::ferror(file);
+  }
+
+  std::fputs("{\"phases\":{", file);
+  for (std::size_t p = 0; p < PHASE_COUNT; ++p) {
+    std::fprintf(file, "%s\"%s\":{\"ns\":%llu,\"calls\":%llu}", p ? "," : "",
+      phase_name(static_cast<Phase>(p)),
+      static_cast<unsigned long long>(s.phase_ns[p]),
+      static_cast<unsigned long long>(s.phase_calls[p]));
+  }
+  std::fputs("},\"options\":[", file);
+  for (std::size_t i = 0; i < s.option_hits.size() and i < m_options.size(); ++i) {
+    const Option &o = m_options[i];
+    std::fputs(i ? ",{\"name\":" : "{\"name\":", file);
+    if (o.long_name.empty()) {
+      detail::write_json_string(file, std::string_view(&o.short_name, 1));
+    }
+    else {
+      detail::write_json_string(file, o.long_name);
+    }
+    std::fprintf(file, ",\"hits\":%llu,\"conversion_failures\":%llu}",
+      static_cast<unsigned long long>(s.option_hits[i]),
+      static_cast<unsigned long long>(s.option_conversion_failures[i]));
+  }
+  std::fputs("],\"arguments\":[", file);
+  for (std::size_t i = 0; i < s.argument_hits.size() and i < m_arguments.size(); ++i) {
+    std::fputs(i ? ",{\"name\":" : "{\"name\":", file);
+    detail::write_json_string(file, m_arguments[i].name);
+    std::fprintf(file, ",\"hits\":%llu,\"conversion_failures\":%llu}",
+      static_cast<unsigned long long>(s.argument_hits[i]),
+      static_cast<unsigned long long>(s.argument_conversion_failures[i]));
+  }
+  std::fputs("]}\n", file);
+  return !std::ferror(file);
+}
+
+}
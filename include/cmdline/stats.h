@@ -0,0 +1,137 @@
+/*
+Copyright (c) 2020 Jakob Mohrbacher
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#pragma once
+
+#include <cstdint>
+
+#include <array>
+#include <chrono>
+#include <vector>
+
+namespace cmdline {
+
+enum class Phase : std::uint8_t {
+  tokenization, //< scanning argv, excluding the phases below
+  lookup,       //< finding options by name
+  conversion,   //< converting values
+  validation,   //< running validators
+  usage,        //< rendering the usage text
+};
+
+constexpr std::size_t PHASE_COUNT = 5;
+
+const char *phase_name(Phase phase);
+
+enum class StatsFormat {
+  json,
+  chrome_trace
+};
+
+/**
+ * Timings and counters collected by `ArgumentParser' when the library is
+ * built with CMDLINE_INSTRUMENTATION; otherwise everything stays zero.
+ *
+ * Phase times are exclusive: time spent converting a value is not also
+ * counted as tokenization.
+ */
+struct ParseStats {
+  struct TraceEvent {
+    Phase phase;
+    std::uint64_t begin_ns;
+    std::uint64_t end_ns;
+  };
+
+  std::array<std::uint64_t, PHASE_COUNT> phase_ns {};
+  std::array<std::uint64_t, PHASE_COUNT> phase_calls {};
+  std::vector<std::uint64_t> option_hits;
+  std::vector<std::uint64_t> option_conversion_failures;
+  std::vector<std::uint64_t> argument_hits;
+  std::vector<std::uint64_t> argument_conversion_failures;
+
+  /**
+   * Whether to record trace events, needed for the Chrome trace export.
+   */
+  bool trace = false;
+  std::size_t max_trace_events = 1 << 16;
+  std::vector<TraceEvent> events;
+
+  void reset(std::size_t options, std::size_t arguments);
+};
+
+namespace detail {
+
+/**
+ * Times a phase for as long as it exists, pausing the enclosing phase.
+ */
+class PhaseTimer {
+  using Clock = std::chrono::steady_clock;
+
+  ParseStats &m_stats;
+  PhaseTimer *m_parent;
+  Phase m_phase;
+  Clock::time_point m_begin;
+  Clock::time_point m_resumed;
+
+  static thread_local PhaseTimer *s_current;
+
+  static std::uint64_t ns(Clock::duration d) {
+    return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(d).count());
+  }
+
+public:
+  PhaseTimer(ParseStats &stats, Phase phase)
+    : m_stats(stats), m_parent(s_current), m_phase(phase), m_begin(Clock::now()), m_resumed(m_begin) {
+    if (m_parent) {
+      m_parent->m_stats.phase_ns[static_cast<std::size_t>(m_parent->m_phase)] += ns(m_begin - m_parent->m_resumed);
+    }
+    s_current = this;
+  }
+
+  ~PhaseTimer() {
+    const Clock::time_point end = Clock::now();
+    const std::size_t p = static_cast<std::size_t>(m_phase);
+    m_stats.phase_ns[p] += ns(end - m_resumed);
+    ++m_stats.phase_calls[p];
+    if (m_stats.trace and m_stats.events.size() < m_stats.max_trace_events) {
+      m_stats.events.push_back({ m_phase, ns(m_begin.time_since_epoch()), ns(end.time_since_epoch()) });
+    }
+    if (m_parent) {
+      m_parent->m_resumed = end;
+    }
+    s_current = m_parent;
+  }
+
+  PhaseTimer(const PhaseTimer &) = delete;
+  PhaseTimer & operator=(const PhaseTimer &) = delete;
+};
+
+}
+
+}
+
+#ifdef CMDLINE_INSTRUMENTATION
+#define CMDLINE_TIME_PHASE(stats, phase) ::cmdline::detail::PhaseTimer cmdline_phase_timer_(stats, phase)
+#define CMDLINE_COUNT(counters, index) ((index) < (counters).size() ? ++(counters)[index] : 0)
+#else
+#define CMDLINE_TIME_PHASE(stats, phase) ((void)0)
+#define CMDLINE_COUNT(counters, index) ((void)0)
+#endif
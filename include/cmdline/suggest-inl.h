@@ -0,0 +1,196 @@
+/*
+Copyright (c) 2020 Jakob Mohrbacher
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#pragma once
+
+#include "config.h"
+#include "suggest.h"
+
+#include <cstring>
+
+#include <algorithm>
+#include <bit>
+
+namespace cmdline {
+namespace detail {
+
+CMDLINE_INLINE EditDistancePattern::EditDistancePattern(std::string_view pattern)
+  : m_pattern(pattern) {
+  std::memset(m_peq, 0, sizeof(m_peq));
+  for (std::size_t i = 0; i < pattern.size() and i < 64; ++i) {
+    m_peq[static_cast<unsigned char>(pattern[i])] |= std::uint64_t(1) << i;
+  }
+}
+
+CMDLINE_INLINE std::size_t EditDistancePattern::distance(std::string_view text, std::size_t max) const {
+  const std::size_t m = m_pattern.size();
+  const std::size_t n = text.size();
+  if ((m > n ? m - n : n - m) > max) {
+    return max + 1;
+  }
+  if (m == 0) {
+    return n;
+  }
+
+  if (m > 64) {
+    // Plain dynamic programming, only reached for absurdly long names
+    std::vector<std::size_t> row(n + 1);
+    for (std::size_t j = 0; j <= n; ++j) {
+      row[j] = j;
+    }
+    for (std::size_t i = 1; i <= m; ++i) {
+      std::size_t diag = row[0];
+      std::size_t row_min = row[0] = i;
+      for (std::size_t j = 1; j <= n; ++j) {
+        const std::size_t up = row[j];
+        row[j] = std::min({ up + 1, row[j - 1] + 1, diag + (m_pattern[i - 1] != text[j - 1]) });
+        diag = up;
+        row_min = std::min(row_min, row[j]);
+      }
+      if (row_min > max) {
+        return max + 1;
+      }
+    }
+    return row[n];
+  }
+
+  // Myers' bit-vector algorithm in the formulation of Hyyrö, computing one
+  // column of the distance matrix per character of `text'.
+  const std::uint64_t last = std::uint64_t(1) << (m - 1);
+  std::uint64_t pv = m == 64 ? ~std::uint64_t(0) : (last << 1) - 1;
+  std::uint64_t mv = 0;
+  std::size_t score = m;
+  for (std::size_t j = 0; j < n; ++j) {
+    const std::uint64_t eq = m_peq[static_cast<unsigned char>(text[j])];
+    const std::uint64_t xv = eq | mv;
+    const std::uint64_t xh = (((eq & pv) + pv) ^ pv) | eq;
+    std::uint64_t ph = mv | ~(xh | pv);
+    std::uint64_t mh = pv & xh;
+    if (ph & last) {
+      ++score;
+    }
+    else if (mh & last) {
+      --score;
+    }
+    // The first row of the matrix grows by one per column
+    ph = (ph << 1) | 1;
+    mh <<= 1;
+    pv = mh | ~(xv | ph);
+    mv = ph & xv;
+    // Each remaining column can lower the score by at most one
+    if (score > max + (n - j - 1)) {
+      return max + 1;
+    }
+  }
+  return score;
+}
+
+CMDLINE_INLINE std::uint64_t character_set(std::string_view str) {
+  std::uint64_t set = 0;
+  for (char ch : str) {
+    set |= std::uint64_t(1) << (static_cast<unsigned char>(ch) & 63);
+  }
+  return set;
+}
+
+CMDLINE_INLINE void SuggestionIndex::clear() {
+  m_by_length.clear();
+  m_size = 0;
+}
+
+CMDLINE_INLINE void SuggestionIndex::add(std::string_view name, std::uint32_t id) {
+  if (name.size() >= m_by_length.size()) {
+    m_by_length.resize(name.size() + 1);
+  }
+  m_by_length[name.size()].push_back({ name, id, character_set(name) });
+  ++m_size;
+}
+
+CMDLINE_INLINE void SuggestionIndex::finalize() {
+  for (std::vector<Entry> &bucket : m_by_length) {
+    std::stable_sort(bucket.begin(), bucket.end(), [](const Entry &a, const Entry &b) {
+      return a.name[0] < b.name[0];
+    });
+  }
+}
+
+CMDLINE_INLINE std::vector<SuggestionIndex::Match> SuggestionIndex::find(std::string_view name, std::size_t max_results, std::size_t max_distance) const {
+  std::vector<Match> results;
+  if (max_results == 0) {
+    return results;
+  }
+  results.reserve(max_results + 1);
+  const EditDistancePattern pattern(name);
+  const std::uint64_t characters = character_set(name);
+  std::size_t bound = max_distance;
+
+  auto consider = [&](const Entry &e) {
+    const std::size_t missing = std::max(std::popcount(characters & ~e.characters),
+                                         std::popcount(e.characters & ~characters));
+    if (missing > bound) {
+      return;
+    }
+    const std::size_t d = pattern.distance(e.name, bound);
+    if (d > bound) {
+      return;
+    }
+    const Match m { e.id, static_cast<std::uint32_t>(d) };
+    results.insert(std::upper_bound(results.begin(), results.end(), m,
+      [](const Match &a, const Match &b) { return a.distance < b.distance; }), m);
+    if (results.size() > max_results) {
+      results.pop_back();
+    }
+    if (results.size() == max_results) {
+      // Only strictly better names can still make it into the results
+      const std::size_t worst = results.back().distance;
+      bound = std::min(bound, worst == 0 ? 0 : worst - 1);
+    }
+  };
+
+  auto scan_bucket = [&](std::size_t length) {
+    if (length >= m_by_length.size() or m_by_length[length].empty()) {
+      return;
+    }
+    const std::vector<Entry> &bucket = m_by_length[length];
+    if (name.empty()) {
+      std::for_each(bucket.begin(), bucket.end(), consider);
+      return;
+    }
+    // Names sharing the first character are the most likely matches, look at
+    // them first to tighten the bound for the rest of the bucket.
+    auto [first, last] = std::equal_range(bucket.begin(), bucket.end(), Entry { name.substr(0, 1), 0, 0 },
+      [](const Entry &a, const Entry &b) { return a.name[0] < b.name[0]; });
+    std::for_each(first, last, consider);
+    std::for_each(bucket.begin(), first, consider);
+    std::for_each(last, bucket.end(), consider);
+  };
+
+  for (std::size_t delta = 0; delta <= bound; ++delta) {
+    scan_bucket(name.size() + delta);
+    if (delta != 0 and delta <= name.size()) {
+      scan_bucket(name.size() - delta);
+    }
+  }
+  return results;
+}
+
+}
+}
@@ -0,0 +1,89 @@
+/*
+Copyright (c) 2020 Jakob Mohrbacher
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#pragma once
+
+#include <cstdint>
+
+#include <string_view>
+#include <vector>
+
+namespace cmdline {
+namespace detail {
+
+/**
+ * Pattern preprocessed for bit-parallel edit distance computation.
+ */
+class EditDistancePattern {
+  std::string_view m_pattern;
+  std::uint64_t m_peq[256];
+
+public:
+  explicit EditDistancePattern(std::string_view pattern);
+
+  /**
+   * @brief Computes the Levenshtein distance between the pattern and `text',
+   * giving up early once it is known to exceed `max'.
+   * @return The distance, or a value greater than `max'.
+   */
+  std::size_t distance(std::string_view text, std::size_t max) const;
+};
+
+/**
+ * @brief Hashes the characters in `str' into a 64 bit set. A character that
+ * is in one string but not in the other needs at least one edit, so the
+ * difference between two sets is a lower bound of the edit distance.
+ */
+std::uint64_t character_set(std::string_view str);
+
+/**
+ * Names grouped by length and, within each length, by first character, so
+ * a lookup only looks at names that can be within the distance bound.
+ */
+class SuggestionIndex {
+  struct Entry {
+    std::string_view name;
+    std::uint32_t id;
+    std::uint64_t characters; //< set of characters, see `character_set'
+  };
+  std::vector<std::vector<Entry>> m_by_length;
+  std::size_t m_size = 0;
+
+public:
+  struct Match {
+    std::uint32_t id;
+    std::uint32_t distance;
+  };
+
+  void clear();
+  void add(std::string_view name, std::uint32_t id);
+  void finalize();
+  std::size_t size() const { return m_size; }
+
+  /**
+   * @brief Finds the at most `max_results' closest names with a distance of
+   * at most `max_distance', ordered by distance.
+   */
+  std::vector<Match> find(std::string_view name, std::size_t max_results, std::size_t max_distance) const;
+};
+
+}
+}
@@ -0,0 +1,177 @@
+/*
+Copyright (c) 2020 Jakob Mohrbacher
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#pragma once
+
+#include "config.h"
+#include "tokenize.h"
+
+#include <array>
+#include <cstring>
+
+namespace cmdline {
+namespace detail {
+
+enum CharClass : std::uint8_t {
+  plain,
+  word_end,     //< unquoted whitespace and the terminating NUL
+  backslash,
+  single_quote,
+  double_quote,
+};
+
+constexpr std::array<std::uint8_t, 256> make_char_classes() {
+  std::array<std::uint8_t, 256> classes {};
+  classes['\0'] = word_end;
+  classes[' '] = word_end;
+  classes['\t'] = word_end;
+  classes['\n'] = word_end;
+  classes['\\'] = backslash;
+  classes['\''] = single_quote;
+  classes['"'] = double_quote;
+  return classes;
+}
+
+inline constexpr std::array<std::uint8_t, 256> CHAR_CLASSES = make_char_classes();
+
+CMDLINE_INLINE std::uint8_t char_class(char ch) {
+  return CHAR_CLASSES[static_cast<unsigned char>(ch)];
+}
+
+}
+
+CMDLINE_INLINE const char *tokenize_status_message(TokenizeStatus status) {
+  switch (status) {
+  case TokenizeStatus::ok: return "no error";
+  case TokenizeStatus::unterminated_single_quote: return "unterminated single quote";
+  case TokenizeStatus::unterminated_double_quote: return "unterminated double quote";
+  case TokenizeStatus::trailing_backslash: return "backslash at end of input";
+  case TokenizeStatus::too_many_tokens: return "too many words";
+  }
+  return "";
+}
+
+CMDLINE_INLINE TokenizeResult tokenize(char *command, const char **tokens, std::size_t capacity) {
+  using namespace detail;
+  TokenizeResult result { TokenizeStatus::ok, 0, 0 };
+  // Unquoting only ever removes characters, so within a word the write
+  // position `w' never passes the read position `r' and the word can be
+  // built in place.
+  char *r = command;
+  char *w = command;
+  auto fail = [&](TokenizeStatus status, const char *at) {
+    if (result.count < capacity) {
+      tokens[result.count] = nullptr;
+    }
+    result.status = status;
+    result.offset = static_cast<std::size_t>(at - command);
+    return result;
+  };
+
+  for (;;) {
+    while (*r == ' ' or *r == '\t' or *r == '\n') {
+      ++r;
+    }
+    if (*r == '\0') {
+      break;
+    }
+    if (result.count + 1 >= capacity) {
+      return fail(TokenizeStatus::too_many_tokens, r);
+    }
+    w = r;
+    tokens[result.count++] = w;
+
+    for (;;) {
+      switch (char_class(*r)) {
+      case plain:
+        if (w == r) {
+          do {
+            ++r;
+          } while (char_class(*r) == plain);
+          w = r;
+        }
+        else {
+          do {
+            *w++ = *r++;
+          } while (char_class(*r) == plain);
+        }
+        continue;
+      case backslash:
+        if (r[1] == '\0') {
+          return fail(TokenizeStatus::trailing_backslash, r);
+        }
+        if (r[1] != '\n') {
+          *w++ = r[1];
+        }
+        r += 2;
+        continue;
+      case single_quote: {
+        const char *close = std::strchr(r + 1, '\'');
+        if (close == nullptr) {
+          return fail(TokenizeStatus::unterminated_single_quote, r);
+        }
+        const std::size_t length = static_cast<std::size_t>(close - (r + 1));
+        std::memmove(w, r + 1, length);
+        w += length;
+        r += length + 2;
+        continue;
+      }
+      case double_quote: {
+        const char *open = r++;
+        for (; *r != '"'; ++r) {
+          if (*r == '\0') {
+            return fail(TokenizeStatus::unterminated_double_quote, open);
+          }
+          if (*r == '\\') {
+            switch (r[1]) {
+            case '$': case '`': case '"': case '\\':
+              ++r;
+              break;
+            case '\n':
+              ++r;
+              continue;
+            }
+          }
+          *w++ = *r;
+        }
+        ++r;
+        continue;
+      }
+      }
+      break;
+    }
+
+    // `r' is at a separator or the end, `w' is at most there
+    const bool end = *r == '\0';
+    *w++ = '\0';
+    if (end) {
+      break;
+    }
+    ++r;
+  }
+
+  if (capacity != 0) {
+    tokens[result.count] = nullptr;
+  }
+  return result;
+}
+
+}
@@ -0,0 +1,66 @@
+/*
+Copyright (c) 2020 Jakob Mohrbacher
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace cmdline {
+
+enum class TokenizeStatus : std::uint8_t {
+  ok,
+  unterminated_single_quote,
+  unterminated_double_quote,
+  trailing_backslash,
+  too_many_tokens,
+};
+
+const char *tokenize_status_message(TokenizeStatus status);
+
+struct TokenizeResult {
+  TokenizeStatus status;
+  std::size_t count;  //< number of tokens stored
+  std::size_t offset; //< position of the error in the command string
+
+  explicit operator bool() const { return status == TokenizeStatus::ok; }
+};
+
+/**
+ * @brief Splits a command string into words like a POSIX shell.
+ *
+ * Words are separated by unquoted spaces, tabs and newlines. A backslash
+ * quotes the next character, and a backslash-newline pair is removed. Single
+ * quotes preserve everything up to the next single quote; inside double
+ * quotes a backslash only quotes `$', ``', `"', `\' and newline. No
+ * expansions are done.
+ *
+ * Quotes and escapes are removed in place and the words are NUL terminated
+ * inside `command', so the pointers stored in `tokens' point into it. The
+ * pointers are followed by a null pointer like `argv', so `tokens' needs room
+ * for one more than the number of words. Nothing is allocated.
+ *
+ * On failure the first `count' tokens are valid, the rest of `command' is in
+ * an unspecified state.
+ */
+TokenizeResult tokenize(char *command, const char **tokens, std::size_t capacity);
+
+}
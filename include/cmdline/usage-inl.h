@@ -0,0 +1,194 @@
+/*
+Copyright (c) 2020 Jakob Mohrbacher
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#pragma once
+
+#include "config.h"
+#include "cmdline.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+
+namespace cmdline {
+namespace detail {
+
+/**
+ * @brief Maps a usage file and checks its header, returns nullptr if it is
+ * malformed.
+ */
+CMDLINE_INLINE void * map_usage(int fd, bool writable, std::size_t &size) {
+  struct stat st;
+  if (::fstat(fd, &st) != 0 or static_cast<std::size_t>(st.st_size) < sizeof(UsageHeader)) {
+    return nullptr;
+  }
+  size = static_cast<std::size_t>(st.st_size);
+  void *data = ::mmap(nullptr, size, writable ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, fd, 0);
+  if (data == MAP_FAILED) {
+    return nullptr;
+  }
+  const UsageHeader *header = static_cast<const UsageHeader *>(data);
+  const std::size_t counters_end = sizeof(UsageHeader) + header->option_count * sizeof(std::uint64_t);
+  if (std::memcmp(header->magic, USAGE_MAGIC, sizeof(header->magic)) != 0
+      or header->version != USAGE_VERSION
+      or header->names_offset != counters_end
+      or header->names_offset > size
+      or header->names_size != size - header->names_offset
+      or (header->names_size != 0 and static_cast<const char *>(data)[size - 1] != '\0')) {
+    ::munmap(data, size);
+    return nullptr;
+  }
+  return data;
+}
+
+}
+
+CMDLINE_INLINE UsageCounters::~UsageCounters() {
+  this->close();
+}
+
+CMDLINE_INLINE void UsageCounters::close() {
+  if (m_header != nullptr) {
+    ::munmap(m_header, m_size);
+  }
+  m_header = nullptr;
+  m_counters = nullptr;
+  m_option_count = 0;
+  m_size = 0;
+}
+
+CMDLINE_INLINE bool UsageCounters::open(const char *directory, const ArgumentParser &parser) {
+  this->close();
+  std::string names;
+  for (const Option &opt : parser.m_options) {
+    if (opt.long_name.empty()) {
+      names += '-';
+      names += opt.short_name;
+    }
+    else {
+      names += "--";
+      names += opt.long_name;
+    }
+    names += '\0';
+  }
+  const std::uint32_t spec_hash = parser.spec_hash();
+  char name[40];
+  std::snprintf(name, sizeof(name), "/cmdline-usage-%08x", static_cast<unsigned>(spec_hash));
+  m_path = std::string(directory) + name;
+
+  int fd = ::open(m_path.c_str(), O_RDWR | O_CLOEXEC);
+  if (fd < 0 and errno == ENOENT) {
+    if (::mkdir(directory, 0755) != 0 and errno != EEXIST) {
+      return false;
+    }
+    detail::UsageHeader header {};
+    std::memcpy(header.magic, detail::USAGE_MAGIC, sizeof(header.magic));
+    header.version = detail::USAGE_VERSION;
+    header.spec_hash = spec_hash;
+    header.option_count = static_cast<std::uint32_t>(parser.m_options.size());
+    header.names_offset = sizeof(header) + parser.m_options.size() * sizeof(std::uint64_t);
+    header.names_size = names.size();
+    std::vector<char> file(header.names_offset + names.size(), '\0');
+    std::memcpy(file.data(), &header, sizeof(header));
+    std::memcpy(file.data() + header.names_offset, names.data(), names.size());
+
+    // Linked into place complete, and never replacing a file another process
+    // already counts in
+    std::string temporary = m_path + ".XXXXXX";
+    const int out = ::mkostemp(temporary.data(), O_CLOEXEC);
+    if (out < 0) {
+      return false;
+    }
+    ::fchmod(out, 0644);
+    const bool written = ::write(out, file.data(), file.size()) == static_cast<ssize_t>(file.size());
+    const bool linked = ::close(out) == 0 and written
+      and (::link(temporary.c_str(), m_path.c_str()) == 0 or errno == EEXIST);
+    ::unlink(temporary.c_str());
+    if (!linked) {
+      return false;
+    }
+    fd = ::open(m_path.c_str(), O_RDWR | O_CLOEXEC);
+  }
+  if (fd < 0) {
+    return false;
+  }
+  std::size_t size;
+  void *data = detail::map_usage(fd, true, size);
+  ::close(fd);
+  if (data == nullptr) {
+    return false;
+  }
+  detail::UsageHeader *header = static_cast<detail::UsageHeader *>(data);
+  // The name is only a hash of the options
+  if (header->spec_hash != spec_hash or header->option_count != parser.m_options.size()
+      or header->names_size != names.size()
+      or std::memcmp(static_cast<char *>(data) + header->names_offset, names.data(), names.size()) != 0) {
+    ::munmap(data, size);
+    return false;
+  }
+  m_header = header;
+  m_counters = reinterpret_cast<std::uint64_t *>(header + 1);
+  m_option_count = header->option_count;
+  m_size = size;
+  return true;
+}
+
+CMDLINE_INLINE bool read_usage(const char *path, UsageReport &report) {
+  const int fd = ::open(path, O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    return false;
+  }
+  std::size_t size;
+  void *data = detail::map_usage(fd, false, size);
+  ::close(fd);
+  if (data == nullptr) {
+    return false;
+  }
+  auto load = [](const std::uint64_t &counter) {
+    return std::atomic_ref<std::uint64_t>(const_cast<std::uint64_t &>(counter)).load(std::memory_order_relaxed);
+  };
+  const detail::UsageHeader *header = static_cast<const detail::UsageHeader *>(data);
+  const std::uint64_t *counters = reinterpret_cast<const std::uint64_t *>(header + 1);
+  const char *name = static_cast<const char *>(data) + header->names_offset;
+  const char *const names_end = name + header->names_size;
+  report.spec_hash = header->spec_hash;
+  report.parses = load(header->parses);
+  report.options.clear();
+  bool ok = true;
+  for (std::uint32_t i = 0; i < header->option_count; ++i) {
+    if (name == names_end) {
+      ok = false;
+      break;
+    }
+    const std::size_t length = std::strlen(name);
+    report.options.push_back({ std::string(name, length), load(counters[i]) });
+    name += length + 1;
+  }
+  ::munmap(data, size);
+  return ok;
+}
+
+}
@@ -0,0 +1,122 @@
+/*
+Copyright (c) 2020 Jakob Mohrbacher
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace cmdline {
+
+class ArgumentParser;
+
+namespace detail {
+
+/**
+ * Start of a usage counter file, followed by `option_count' counters and
+ * the option names, each NUL terminated, at `names_offset'.
+ */
+struct UsageHeader {
+  char magic[4];
+  std::uint32_t version;
+  std::uint32_t spec_hash;
+  std::uint32_t option_count;
+  std::uint64_t names_offset;
+  std::uint64_t names_size;
+  std::uint64_t parses;
+};
+
+inline constexpr char USAGE_MAGIC[4] = { 'C', 'L', 'U', 'C' };
+inline constexpr std::uint32_t USAGE_VERSION = 1;
+
+}
+
+/**
+ * Counts how many parses use each option, in a file shared by all
+ * processes whose parser has the same options.
+ *
+ * The file is named after the hash of the options (see `save_result') and
+ * created on first use; counters are incremented with relaxed atomic
+ * operations on the mapped file, so counting never blocks or makes a system
+ * call. Each option is counted once per parse that gives it, including
+ * parses that fail later on, and once per hit of a `ParseCache'. Options of
+ * a spec image are not counted.
+ *
+ * Read the files with `read_usage' or the cmdline_usage tool.
+ */
+class UsageCounters {
+  detail::UsageHeader *m_header { nullptr };
+  std::uint64_t *m_counters { nullptr };
+  std::size_t m_option_count { 0 };
+  std::size_t m_size { 0 };
+  std::string m_path;
+
+public:
+  UsageCounters() = default;
+  ~UsageCounters();
+
+  UsageCounters(const UsageCounters &) = delete;
+  UsageCounters & operator=(const UsageCounters &) = delete;
+
+  /**
+   * @brief Maps the counters for the options `parser' has now, creating the
+   * file in `directory' if needed. Options added later are not counted.
+   * Returns false if the file cannot be created or mapped, or holds
+   * different options.
+   */
+  bool open(const char *directory, const ArgumentParser &parser);
+  void close();
+
+  bool is_open() const { return m_header != nullptr; }
+  const std::string & path() const { return m_path; }
+
+  void count_parse() {
+    std::atomic_ref<std::uint64_t>(m_header->parses).fetch_add(1, std::memory_order_relaxed);
+  }
+
+  void count_option(std::size_t index) {
+    if (index < m_option_count) {
+      std::atomic_ref<std::uint64_t>(m_counters[index]).fetch_add(1, std::memory_order_relaxed);
+    }
+  }
+};
+
+struct OptionUsage {
+  std::string name; //< `--long' or `-x'
+  std::uint64_t count;
+};
+
+struct UsageReport {
+  std::uint32_t spec_hash;
+  std::uint64_t parses;
+  std::vector<OptionUsage> options;
+};
+
+/**
+ * @brief Reads a usage counter file written through `UsageCounters'.
+ * Returns false if it cannot be read or is malformed.
+ */
+bool read_usage(const char *path, UsageReport &report);
+
+}
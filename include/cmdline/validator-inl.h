@@ -0,0 +1,155 @@
+/*
+Copyright (c) 2020 Jakob Mohrbacher
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#pragma once
+
+#include "config.h"
+#include "validator.h"
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <system_error>
+#include <thread>
+
+namespace cmdline {
+namespace validators {
+
+CMDLINE_INLINE Validator exists() {
+  return {
+    [](const char *path) {
+      struct stat st;
+      return ::stat(path, &st) == 0;
+    },
+    "no such file or directory",
+    true
+  };
+}
+
+CMDLINE_INLINE Validator is_directory() {
+  return {
+    [](const char *path) {
+      struct stat st;
+      return ::stat(path, &st) == 0 and S_ISDIR(st.st_mode);
+    },
+    "not a directory",
+    true
+  };
+}
+
+CMDLINE_INLINE Validator readable() {
+  return {
+    [](const char *path) {
+      return ::access(path, R_OK) == 0;
+    },
+    "not readable",
+    true
+  };
+}
+
+CMDLINE_INLINE Validator custom(std::function<bool(const char *)> check, const char *message, bool io_bound) {
+  return { std::move(check), message, io_bound };
+}
+
+}
+
+namespace detail {
+
+// Below this many I/O bound checks starting threads costs more than it saves
+inline constexpr std::size_t MIN_PARALLEL_VALIDATIONS = 64;
+// Number of checks a thread claims at once
+inline constexpr std::size_t VALIDATION_CHUNK = 32;
+
+CMDLINE_INLINE void run_validations(const std::vector<PendingValidation> &pending, std::vector<char> &ok, unsigned threads) {
+  ok.assign(pending.size(), 0);
+  std::vector<std::size_t> io;
+  for (std::size_t i = 0; i < pending.size(); ++i) {
+    if (pending[i].validator->io_bound) {
+      io.push_back(i);
+    }
+    else {
+      ok[i] = pending[i].validator->check(pending[i].value);
+    }
+  }
+
+  if (threads == 0) {
+    threads = std::max(1u, std::thread::hardware_concurrency());
+  }
+  threads = static_cast<unsigned>(std::min<std::size_t>(threads, io.size() / VALIDATION_CHUNK + 1));
+  if (io.size() < MIN_PARALLEL_VALIDATIONS or threads <= 1) {
+    for (std::size_t i : io) {
+      ok[i] = pending[i].validator->check(pending[i].value);
+    }
+    return;
+  }
+
+  // A validator that throws stops the others from claiming more checks; the
+  // exception is rethrown once all threads are joined, as the serial path
+  // would have let it propagate
+  std::atomic<std::size_t> next { 0 };
+  std::atomic<bool> failed { false };
+  std::exception_ptr error;
+  auto worker = [&]() {
+    try {
+      for (;;) {
+        const std::size_t begin = next.fetch_add(VALIDATION_CHUNK, std::memory_order_relaxed);
+        if (begin >= io.size()) {
+          return;
+        }
+        const std::size_t end = std::min(begin + VALIDATION_CHUNK, io.size());
+        for (std::size_t j = begin; j < end; ++j) {
+          const PendingValidation &p = pending[io[j]];
+          ok[io[j]] = p.validator->check(p.value);
+        }
+      }
+    }
+    catch (...) {
+      next.store(io.size(), std::memory_order_relaxed);
+      if (!failed.exchange(true)) {
+        error = std::current_exception();
+      }
+    }
+  };
+  std::vector<std::thread> pool;
+  pool.reserve(threads - 1);
+  for (unsigned t = 1; t < threads; ++t) {
+    // Without more threads the ones already started and this one do the rest
+    try {
+      pool.emplace_back(worker);
+    }
+    catch (const std::system_error &) {
+      break;
+    }
+  }
+  worker();
+  for (std::thread &t : pool) {
+    t.join();
+  }
+  if (error) {
+    std::rethrow_exception(error);
+  }
+}
+
+}
+}
@@ -0,0 +1,86 @@
+/*
+Copyright (c) 2020 Jakob Mohrbacher
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#pragma once
+
+#include <cstdint>
+
+#include <string>
+#include <vector>
+#include <functional>
+
+namespace cmdline {
+
+/**
+ * A check run on the raw value of an option or argument after all of argv
+ * has been parsed.
+ */
+struct Validator {
+  std::function<bool(const char *)> check;
+  std::string message; //< printed after the value if the check fails
+  bool io_bound; //< whether to run the check on the validation threads
+};
+
+namespace validators {
+
+/**
+ * @brief The value names an existing file system entry.
+ */
+Validator exists();
+/**
+ * @brief The value names an existing directory.
+ */
+Validator is_directory();
+/**
+ * @brief The value names a file that is readable by the process.
+ */
+Validator readable();
+/**
+ * @brief A user defined check.
+ */
+Validator custom(std::function<bool(const char *)> check, const char *message, bool io_bound = false);
+
+}
+
+namespace detail {
+
+/**
+ * A value waiting to be validated.
+ */
+struct PendingValidation {
+  const Validator *validator;
+  const char *value;
+  int argv_index; //< the value is at argv[argv_index] + offset
+  std::uint32_t offset;
+  std::size_t owner; //< option or argument index
+  std::size_t validator_index;
+  bool is_option;
+};
+
+/**
+ * @brief Runs all pending validations, spreading I/O bound ones across at
+ * most `threads' threads. The result for `pending[i]' is stored in `ok[i]'.
+ */
+void run_validations(const std::vector<PendingValidation> &pending, std::vector<char> &ok, unsigned threads);
+
+}
+
+}
@@ -0,0 +1,103 @@
+#include "gtest/gtest.h"
+#include "cmdline.h"
+
+#include <cstring>
+
+template<typename T, std::size_t N>
+auto size(T (&)[N]) { return N; }
+
+TEST(ArenaTests, Store) {
+  cmdline::StringArena arena;
+  const std::string_view a = arena.store("hello");
+  const std::string_view b = arena.store("hello");
+  EXPECT_EQ(a, "hello");
+  EXPECT_EQ(a.data()[a.size()], '\0');
+  EXPECT_NE(a.data(), b.data());
+  EXPECT_EQ(arena.bytes_used(), 12);
+
+  const std::string large(3 * cmdline::StringArena::MIN_BLOCK_SIZE, 'x');
+  EXPECT_EQ(arena.store(large), large);
+  // The space left in the current block is still used
+  const std::string_view c = arena.store("c");
+  EXPECT_EQ(c.data(), b.data() + 6);
+
+  std::vector<std::string_view> views;
+  for (int i = 0; i < 10000; ++i) {
+    views.push_back(arena.store(std::to_string(i)));
+  }
+  for (int i = 0; i < 10000; ++i) {
+    ASSERT_EQ(views[i], std::to_string(i));
+  }
+  EXPECT_EQ(a, "hello");
+
+  arena.clear();
+  EXPECT_EQ(arena.bytes_used(), 0);
+  EXPECT_EQ(arena.store("").size(), 0);
+}
+
+TEST(ArenaTests, Interning) {
+  cmdline::StringArena arena;
+  const std::string_view before = arena.store("value");
+  arena.set_interning(true);
+  const std::string_view a = arena.store("value");
+  const std::string_view b = arena.store(std::string("value"));
+  EXPECT_NE(a.data(), before.data());
+  EXPECT_EQ(a.data(), b.data());
+  EXPECT_NE(arena.store("valu").data(), a.data());
+  EXPECT_EQ(arena.store("").data(), arena.store("").data());
+
+  for (int round = 0; round < 2; ++round) {
+    for (int i = 0; i < 1000; ++i) {
+      arena.store(std::to_string(i % 100));
+    }
+  }
+  const std::size_t used = arena.bytes_used();
+  arena.store("42");
+  EXPECT_EQ(arena.bytes_used(), used);
+
+  arena.clear();
+  EXPECT_NE(arena.store("value").data(), nullptr);
+}
+
+TEST(ArenaTests, Options) {
+  cmdline::ArgumentParser p;
+  p.error_messages = false;
+  p.string_arena().set_interning(true);
+  std::string_view name;
+  const char *mode = nullptr;
+  std::vector<std::string_view> tags;
+  std::array<std::string_view, 2> pair;
+  std::string_view file;
+  p.add_option(name, "", 'n', "name");
+  p.add_option(mode, "", 'm', "mode");
+  p.add_option(tags, "", 't', "tag");
+  p.add_option(pair, "", 'p', "pair");
+  p.add_argument(file, "", "file");
+
+  char command[] = "-n alpha --mode=fast -t a -t b -t a --pair x y input";
+  const char *arena[16];
+  ASSERT_TRUE(p.parse_command_line("program_name", command, arena, size(arena), false));
+  // The values do not point into the command
+  std::memset(command, 'z', sizeof(command) - 1);
+  EXPECT_EQ(name, "alpha");
+  EXPECT_STREQ(mode, "fast");
+  ASSERT_EQ(tags.size(), 3);
+  EXPECT_EQ(tags[0], "a");
+  EXPECT_EQ(tags[1], "b");
+  EXPECT_EQ(tags[0].data(), tags[2].data());
+  EXPECT_EQ(pair[0], "x");
+  EXPECT_EQ(pair[1], "y");
+  EXPECT_EQ(file, "input");
+
+  // Round trip through a saved result and the canonical form
+  std::vector<char> blob;
+  ASSERT_TRUE(p.save_result(blob));
+  std::vector<std::string> args;
+  ASSERT_TRUE(p.canonical_args(args));
+  EXPECT_EQ(args, (std::vector<std::string> {
+    "--name=alpha", "--mode=fast", "--tag=a", "--tag=b", "--tag=a", "--pair", "x", "y", "input" }));
+  tags.clear();
+  ASSERT_TRUE(p.load_result(blob.data(), blob.size()));
+  EXPECT_EQ(tags.size(), 3);
+  EXPECT_STREQ(mode, "fast");
+}
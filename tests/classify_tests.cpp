@@ -0,0 +1,182 @@
+#include "gtest/gtest.h"
+#include "cmdline.h"
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <random>
+
+template<typename T, std::size_t N>
+auto size(T (&)[N]) { return N; }
+
+TEST(ClassifyTests, Kinds) {
+  const char *tokens[] = {
+    "", "x", "a=b", "-", "-x", "-x=1", "--", "--name", "--name=value=2", "---", "--=",
+    "a string longer than sixteen bytes with an = late in it",
+  };
+  cmdline::TokenClass classes[size(tokens)];
+  cmdline::classify_tokens(tokens, size(tokens), classes);
+  using K = cmdline::TokenKind;
+  const K kinds[] = {
+    K::positional, K::positional, K::positional, K::short_option, K::short_option, K::short_option,
+    K::terminator, K::long_option, K::long_option, K::long_option, K::long_option, K::positional,
+  };
+  const std::uint32_t equals[] = {
+    cmdline::TokenClass::no_equals, cmdline::TokenClass::no_equals, 1, cmdline::TokenClass::no_equals,
+    cmdline::TokenClass::no_equals, 2, cmdline::TokenClass::no_equals, cmdline::TokenClass::no_equals, 6,
+    cmdline::TokenClass::no_equals, 2, 43,
+  };
+  for (std::size_t i = 0; i < size(tokens); ++i) {
+    EXPECT_EQ(classes[i].kind, kinds[i]) << tokens[i];
+    EXPECT_EQ(classes[i].length, std::strlen(tokens[i])) << tokens[i];
+    EXPECT_EQ(classes[i].equals, equals[i]) << tokens[i];
+  }
+}
+
+TEST(ClassifyTests, AllOffsets) {
+  // Every alignment and every length around a block boundary, with bytes
+  // after the terminator that must not be picked up
+  char buffer[96];
+  for (std::size_t start = 0; start < 16; ++start) {
+    for (std::size_t length = 0; length < 40; ++length) {
+      for (std::size_t eq = 0; eq <= length + 1; ++eq) {
+        std::memset(buffer, '=', sizeof(buffer));
+        std::memset(buffer + start, 'a', length);
+        if (eq < length) {
+          buffer[start + eq] = '=';
+        }
+        buffer[start + length] = '\0';
+        const char *token = buffer + start;
+        cmdline::TokenClass c;
+        cmdline::classify_tokens(&token, 1, &c);
+        ASSERT_EQ(c.length, length);
+        ASSERT_EQ(c.equals, eq < length ? eq : cmdline::TokenClass::no_equals);
+      }
+    }
+  }
+}
+
+TEST(ClassifyTests, EndOfPage) {
+  // A token ending right before an inaccessible page
+  const std::size_t page = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+  void *mem = mmap(nullptr, 2 * page, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  ASSERT_NE(mem, MAP_FAILED);
+  char *base = static_cast<char *>(mem);
+  ASSERT_EQ(mprotect(base + page, page, PROT_NONE), 0);
+  for (std::size_t length = 0; length < 40; ++length) {
+    char *token = base + page - length - 1;
+    std::memset(token, 'a', length);
+    token[length] = '\0';
+    const char *t = token;
+    cmdline::TokenClass c;
+    cmdline::classify_tokens(&t, 1, &c);
+    EXPECT_EQ(c.length, length);
+  }
+  munmap(mem, 2 * page);
+}
+
+namespace {
+
+struct Outcome {
+  bool ok;
+  cmdline::Diagnostic diagnostic;
+  bool a, b;
+  int number;
+  std::vector<std::string> names;
+  std::array<int, 2> pair;
+  std::string first;
+  std::vector<const char *> rest;
+};
+
+Outcome parse(std::vector<const char *> argv, std::size_t classify_min_tokens, bool abbreviations) {
+  cmdline::ArgumentParser p;
+  Outcome o {};
+  p.error_messages = false;
+  p.abbreviations = abbreviations;
+  p.classify_min_tokens = classify_min_tokens;
+  p.set_diagnostic_buffer(&o.diagnostic, 1);
+  p.add_option(o.a, "", 'a', "alpha");
+  p.add_option(o.b, "", 'b', "beta");
+  p.add_option(o.number, "", 'n', "number");
+  p.add_option(o.names, "", 's', "name");
+  p.add_option(o.pair, "", 'p', "pair");
+  p.add_argument(o.first, "", "first", false);
+  p.add_argument(o.rest, "rest");
+  o.ok = p.parse_args(static_cast<int>(argv.size()), argv.data(), false);
+  return o;
+}
+
+}
+
+TEST(ClassifyTests, MatchesUnclassifiedParse) {
+  static const char *const pool[] = {
+    "-a", "-b", "-ab", "-n", "5", "-n7", "--number=3", "--number", "x", "-s", "foo", "--name=bar", "--nam=baz",
+    "-p", "1", "2", "--pair", "--", "--zzz", "-q", "42", "text", "", "-", "--alpha", "--al", "-number=4",
+  };
+  std::mt19937 rng(11);
+  for (int step = 0; step < 2000; ++step) {
+    std::vector<const char *> argv { "program_name" };
+    // Some inputs span several classification batches
+    for (std::size_t n = rng() % (step % 10 == 0 ? 700 : 12); n > 0; --n) {
+      argv.push_back(pool[rng() % size(pool)]);
+    }
+    const bool abbreviations = step & 1;
+    const Outcome direct = parse(argv, cmdline::Limits::unlimited, abbreviations);
+    const Outcome classified = parse(argv, 0, abbreviations);
+    ASSERT_EQ(direct.ok, classified.ok) << "step " << step;
+    if (!direct.ok) {
+      ASSERT_EQ(direct.diagnostic, classified.diagnostic) << "step " << step;
+      continue;
+    }
+    EXPECT_EQ(direct.a, classified.a);
+    EXPECT_EQ(direct.b, classified.b);
+    EXPECT_EQ(direct.number, classified.number);
+    EXPECT_EQ(direct.names, classified.names);
+    EXPECT_EQ(direct.pair, classified.pair);
+    EXPECT_EQ(direct.first, classified.first);
+    EXPECT_EQ(direct.rest, classified.rest);
+  }
+}
+
+namespace {
+
+// Records whether the first argv element was classified when the value of
+// `--probe' is converted
+struct ProbeParser : cmdline::ArgumentParser {
+  using cmdline::ArgumentParser::token_class;
+};
+
+ProbeParser *g_probe_parser = nullptr;
+bool g_probe_classified = false;
+
+struct Probe {};
+
+std::istream & operator>>(std::istream &is, Probe &) {
+  std::string text;
+  is >> text;
+  g_probe_classified = g_probe_parser->token_class(1) != nullptr;
+  return is;
+}
+
+}
+
+TEST(ClassifyTests, ClassifiesEachParse) {
+  ProbeParser p;
+  p.error_messages = false;
+  p.classify_min_tokens = 0;
+  Probe probe;
+  bool flag = false;
+  p.add_option(probe, "", 0, "probe");
+  p.add_option(flag, "", 'f', "flag");
+  // Ends in a later batch than the first, which previously kept the parser
+  // from classifying the start of the next parse
+  std::vector<const char *> argv { "program_name", "--probe=1" };
+  argv.resize(600, "-f");
+  g_probe_parser = &p;
+  for (int parse = 0; parse < 3; ++parse) {
+    g_probe_classified = false;
+    ASSERT_TRUE(p.parse_args(static_cast<int>(argv.size()), argv.data(), false));
+    EXPECT_TRUE(g_probe_classified) << "parse " << parse;
+  }
+  g_probe_parser = nullptr;
+}
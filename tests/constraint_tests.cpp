@@ -0,0 +1,116 @@
+#include "gtest/gtest.h"
+#include "cmdline.h"
+
+template<typename T, std::size_t N>
+auto size(T (&)[N]) { return N; }
+
+namespace {
+
+struct ConstraintTests : ::testing::Test {
+  cmdline::ArgumentParser p;
+  cmdline::Diagnostic diagnostics[4];
+  bool json = false, xml = false, csv = false, verbose = false;
+  std::string output, user, password;
+
+  void SetUp() override {
+    p.error_messages = false;
+    p.set_diagnostic_buffer(diagnostics, size(diagnostics));
+    p.add_option(json, "", 0, "json");
+    p.add_option(xml, "", 0, "xml");
+    p.add_option(csv, "", 'c', "");
+    p.add_option(verbose, "", 'v', "verbose");
+    p.add_option(user, "", 'u', "user");
+    p.add_option(output, "", 'o', "output");
+    p.add_option(password, "", 0, "password");
+  }
+
+  template<std::size_t N>
+  std::vector<std::string> errors(const char *(&argv)[N]) {
+    EXPECT_FALSE(p.parse_args(N, argv, false));
+    std::vector<std::string> messages;
+    for (std::size_t i = 0; i < p.diagnostic_count(); ++i) {
+      EXPECT_EQ(diagnostics[i].code, cmdline::ErrorCode::constraint_violated);
+      char buffer[128];
+      p.format_diagnostic(diagnostics[i], argv, buffer, sizeof(buffer));
+      messages.push_back(buffer);
+    }
+    return messages;
+  }
+};
+
+}
+
+TEST_F(ConstraintTests, UnknownNames) {
+  EXPECT_FALSE(p.require_options({ "nope" }));
+  EXPECT_FALSE(p.add_exclusive_group({ "json", "-x" }));
+  EXPECT_FALSE(p.add_exclusive_group({}));
+  EXPECT_FALSE(p.add_dependency("nope", { "user" }));
+  EXPECT_TRUE(p.add_exclusive_group({ "--json", "xml", "-c" }));
+}
+
+TEST_F(ConstraintTests, Required) {
+  ASSERT_TRUE(p.require_options({ "output" }));
+  {
+    const char *argv[] = {"program_name", "-o", "x"};
+    EXPECT_TRUE(p.parse_args(size(argv), argv, false));
+  }
+  {
+    const char *argv[] = {"program_name", "-v"};
+    EXPECT_EQ(errors(argv), std::vector<std::string> { "program_name: option `--output' is required" });
+  }
+  {
+    char *text = nullptr;
+    std::size_t length = 0;
+    FILE *f = open_memstream(&text, &length);
+    p.usage(f, "program_name");
+    std::fclose(f);
+    EXPECT_NE(std::string(text, length).find("[-u USER] -o OUTPUT [--password PASSWORD]"), std::string::npos);
+    std::free(text);
+  }
+  {
+    // Help skips the constraints
+    const char *argv[] = {"program_name", "--help"};
+    EXPECT_FALSE(p.parse_args(size(argv), argv, false));
+    EXPECT_EQ(p.diagnostic_count(), 0);
+  }
+}
+
+TEST_F(ConstraintTests, Groups) {
+  ASSERT_TRUE(p.add_exclusive_group({ "json", "xml", "-c" }));
+  ASSERT_TRUE(p.add_at_least_one_group({ "json", "xml", "-c" }));
+  ASSERT_TRUE(p.add_dependency("password", { "user", "verbose" }));
+  {
+    const char *argv[] = {"program_name", "--xml", "-v", "--user=me", "--password=secret"};
+    EXPECT_TRUE(p.parse_args(size(argv), argv, false));
+  }
+  {
+    const char *argv[] = {"program_name", "--json", "-c"};
+    EXPECT_EQ(errors(argv), std::vector<std::string> {
+      "program_name: only one of `--json', `--xml' or `-c' may be given" });
+  }
+  {
+    const char *argv[] = {"program_name", "--password=secret"};
+    EXPECT_EQ(errors(argv), (std::vector<std::string> {
+      "program_name: one of `--json', `--xml' or `-c' is required",
+      "program_name: option `--password' requires `--verbose' and `--user'" }));
+  }
+}
+
+TEST(OptionSetTests, Operations) {
+  cmdline::detail::OptionSet a, b;
+  a.clear(130);
+  b.clear(10);
+  for (std::size_t i : { 1, 64, 129 }) {
+    a.insert(i);
+  }
+  b.insert(64);
+  EXPECT_EQ(a.size(), 3);
+  EXPECT_TRUE(a.contains(129));
+  EXPECT_FALSE(b.contains(129));
+  EXPECT_EQ(a.count_common(b), 1);
+  EXPECT_TRUE(b.is_subset_of(a));
+  EXPECT_FALSE(a.is_subset_of(b));
+  std::vector<std::size_t> items;
+  a.for_each([&](std::size_t i) { items.push_back(i); });
+  EXPECT_EQ(items, (std::vector<std::size_t> { 1, 64, 129 }));
+}
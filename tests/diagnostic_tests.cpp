@@ -0,0 +1,111 @@
+#include "gtest/gtest.h"
+#include "cmdline.h"
+
+template<typename T, std::size_t N>
+auto size(T (&)[N]) { return N; }
+
+TEST(DiagnosticTests, Records) {
+  cmdline::ArgumentParser p;
+  p.error_messages = false;
+  cmdline::Diagnostic diagnostics[4];
+  p.set_diagnostic_buffer(diagnostics, size(diagnostics));
+
+  bool flag = false;
+  int number = 0;
+  p.add_option(flag, "", 'f', "flag");
+  p.add_option(number, "", 'n', "number");
+
+  EXPECT_FALSE(p.add_option(flag, "", 'f', ""));
+  ASSERT_EQ(p.diagnostic_count(), 1);
+  EXPECT_EQ(diagnostics[0].code, cmdline::ErrorCode::duplicate_option);
+  EXPECT_EQ(diagnostics[0].argv_index, -1);
+  EXPECT_EQ(diagnostics[0].detail, 'f');
+
+  const char *argv[] = {"program_name", "-fx"};
+  EXPECT_FALSE(p.parse_args(size(argv), argv, false));
+  ASSERT_EQ(p.diagnostic_count(), 1);
+  EXPECT_EQ(diagnostics[0].code, cmdline::ErrorCode::invalid_option);
+  EXPECT_EQ(diagnostics[0].argv_index, 1);
+  EXPECT_EQ(diagnostics[0].offset, 2);
+
+  const char *argv2[] = {"program_name", "--number=abc"};
+  EXPECT_FALSE(p.parse_args(size(argv2), argv2, false));
+  ASSERT_EQ(p.diagnostic_count(), 1);
+  EXPECT_EQ(diagnostics[0].code, cmdline::ErrorCode::option_invalid_argument);
+  EXPECT_EQ(diagnostics[0].argv_index, 1);
+  EXPECT_EQ(diagnostics[0].id, 2);
+  EXPECT_EQ(diagnostics[0].offset, 9);
+}
+
+TEST(DiagnosticTests, Format) {
+  cmdline::ArgumentParser p;
+  p.error_messages = false;
+  cmdline::Diagnostic d;
+  p.set_diagnostic_buffer(&d, 1);
+
+  bool flag = false;
+  std::array<int, 2> range;
+  p.add_option(flag, "", 0, "verbose");
+  p.add_option(range, "", 'r', "range");
+
+  char buffer[128];
+  auto format = [&](const char **argv) {
+    p.format_diagnostic(d, argv, buffer, sizeof(buffer));
+    return std::string(buffer);
+  };
+
+  {
+    const char *argv[] = {"program_name", "--verbsoe"};
+    EXPECT_FALSE(p.parse_args(size(argv), argv, false));
+    EXPECT_EQ(format(argv), "program_name: unrecognized option `--verbsoe'; did you mean `--verbose'?");
+    EXPECT_EQ(format(nullptr), "unrecognized option `--'");
+  }
+  {
+    const char *argv[] = {"program_name", "--range=1"};
+    EXPECT_FALSE(p.parse_args(size(argv), argv, false));
+    EXPECT_EQ(format(argv), "program_name: option `--range' requires 2 arguments");
+  }
+  {
+    const char *argv[] = {"program_name", "-r", "1"};
+    EXPECT_FALSE(p.parse_args(size(argv), argv, false));
+    EXPECT_EQ(format(argv), "program_name: option requires 2 arguments -- r");
+  }
+  {
+    const char *argv[] = {"program_name", "-r", "1", "x"};
+    EXPECT_FALSE(p.parse_args(size(argv), argv, false));
+    EXPECT_EQ(d.argv_index, 3);
+    EXPECT_EQ(d.offset, 0);
+    EXPECT_EQ(format(argv), "program_name: invalid argument `x' for option `--range'");
+  }
+  {
+    const char *argv[] = {"program_name", "-r", "x", "1"};
+    EXPECT_FALSE(p.parse_args(size(argv), argv, false));
+    EXPECT_EQ(d.argv_index, 2);
+    EXPECT_EQ(format(argv), "program_name: invalid argument `x' for option `--range'");
+  }
+
+  // Truncation
+  const char *argv[] = {"program_name", "--range=1"};
+  EXPECT_FALSE(p.parse_args(size(argv), argv, false));
+  const std::size_t length = p.format_diagnostic(d, argv, buffer, 10);
+  EXPECT_EQ(length, std::strlen("program_name: option `--range' requires 2 arguments"));
+  EXPECT_STREQ(buffer, "program_n");
+}
+
+TEST(DiagnosticTests, Overflow) {
+  cmdline::ArgumentParser p;
+  p.error_messages = false;
+  cmdline::Diagnostic diagnostics[1];
+  p.set_diagnostic_buffer(diagnostics, size(diagnostics));
+
+  int a, b, c;
+  p.add_argument(a, "", "a");
+  p.add_argument(b, "", "b");
+  p.add_argument(c, "", "c");
+
+  const char *argv[] = {"program_name"};
+  EXPECT_FALSE(p.parse_args(size(argv), argv, false));
+  EXPECT_EQ(p.diagnostic_count(), 3);
+  EXPECT_EQ(diagnostics[0].code, cmdline::ErrorCode::argument_required);
+  EXPECT_EQ(diagnostics[0].id, 0);
+}
@@ -0,0 +1,156 @@
+#include "gtest/gtest.h"
+#include "cmdline.h"
+
+#include <unistd.h>
+
+template<typename T, std::size_t N>
+auto size(T (&)[N]) { return N; }
+
+namespace {
+
+struct DumpTests : ::testing::Test {
+  cmdline::ArgumentParser p;
+  bool verbose = false;
+  int level = -3;
+  std::uint64_t limit = 7;
+  double ratio = 0.5;
+  std::string name = "a\"b";
+  std::vector<int> ids;
+  std::array<std::string, 2> pair;
+  cmdline::Bytes memory { 2048 };
+  std::string input;
+  std::vector<const char *> rest;
+
+  void SetUp() override {
+    p.error_messages = false;
+    p.add_option(verbose, "", 'v', "verbose");
+    p.add_option(level, "", 'l', "");
+    p.add_option(limit, "", 0, "limit");
+    p.add_option(ratio, "", 0, "ratio");
+    p.add_option(name, "", 0, "name");
+    p.add_option(ids, "", 'i', "id");
+    p.add_option(pair, "", 0, "pair");
+    p.add_option(memory, "", 0, "memory");
+    p.add_argument(input, "", "input", false);
+    p.add_argument(rest, "rest");
+  }
+
+  std::string dump(cmdline::DumpFormat format) {
+    std::string out(p.dump_config(nullptr, 0, format), '\0');
+    EXPECT_EQ(p.dump_config(out.data(), out.size(), format), out.size());
+    return out;
+  }
+};
+
+template<typename T>
+T take(const char *&p) {
+  T value;
+  std::memcpy(&value, p, sizeof(value));
+  p += sizeof(value);
+  return value;
+}
+
+}
+
+TEST_F(DumpTests, Json) {
+  const char *argv[] = { "program_name", "-v", "-i1", "-i", "2", "--pair", "x\x01y", "z", "--ratio=1e300", "in", "r" };
+  ASSERT_TRUE(p.parse_args(size(argv), argv, false));
+  EXPECT_EQ(dump(cmdline::DumpFormat::json),
+    "{\"options\":["
+    "{\"name\":\"--help\",\"type\":\"boolean\",\"source\":\"default\",\"value\":false},"
+    "{\"name\":\"--verbose\",\"type\":\"boolean\",\"source\":\"argv\",\"value\":true},"
+    "{\"name\":\"-l\",\"type\":\"integer\",\"source\":\"default\",\"value\":-3},"
+    "{\"name\":\"--limit\",\"type\":\"unsigned\",\"source\":\"default\",\"value\":7},"
+    "{\"name\":\"--ratio\",\"type\":\"number\",\"source\":\"argv\",\"value\":1e+300},"
+    "{\"name\":\"--name\",\"type\":\"string\",\"source\":\"default\",\"value\":\"a\\\"b\"},"
+    "{\"name\":\"--id\",\"type\":\"integer[]\",\"source\":\"argv\",\"value\":[1,2]},"
+    "{\"name\":\"--pair\",\"type\":\"string[]\",\"source\":\"argv\",\"value\":[\"x\\u0001y\",\"z\"]},"
+    "{\"name\":\"--memory\",\"type\":\"string\",\"source\":\"default\",\"value\":\"2048\"}"
+    "],\"arguments\":["
+    "{\"name\":\"input\",\"type\":\"string\",\"source\":\"argv\",\"value\":\"in\"},"
+    "{\"name\":\"rest\",\"type\":\"string[]\",\"source\":\"argv\",\"value\":[\"r\"]}"
+    "]}\n");
+}
+
+TEST_F(DumpTests, Truncated) {
+  const std::string full = dump(cmdline::DumpFormat::json);
+  char buffer[16];
+  std::memset(buffer, '#', sizeof(buffer));
+  EXPECT_EQ(p.dump_config(buffer, 10, cmdline::DumpFormat::json), full.size());
+  EXPECT_EQ(std::string(buffer, 10), full.substr(0, 10));
+  EXPECT_EQ(buffer[10], '#');
+}
+
+TEST_F(DumpTests, Binary) {
+  const char *argv[] = { "program_name", "-l", "4", "-i", "9", "--name=n" };
+  ASSERT_TRUE(p.parse_args(size(argv), argv, false));
+  const std::string out = dump(cmdline::DumpFormat::binary);
+  const char *at = out.data();
+  const cmdline::DumpHeader header = take<cmdline::DumpHeader>(at);
+  EXPECT_EQ(std::memcmp(header.magic, cmdline::DUMP_MAGIC, 4), 0);
+  EXPECT_EQ(header.version, cmdline::DUMP_VERSION);
+  ASSERT_EQ(header.entry_count, 11);
+
+  std::vector<std::string> names;
+  for (std::uint32_t i = 0; i < header.entry_count; ++i) {
+    const cmdline::DumpEntry entry = take<cmdline::DumpEntry>(at);
+    names.emplace_back(at, entry.name_length);
+    at += entry.name_length;
+    const std::uint32_t count = entry.list ? take<std::uint32_t>(at) : 1;
+    for (std::uint32_t n = 0; n < count; ++n) {
+      switch (entry.type) {
+      case cmdline::DumpType::none:
+        break;
+      case cmdline::DumpType::boolean:
+        take<std::uint8_t>(at);
+        break;
+      case cmdline::DumpType::integer: {
+        const std::int64_t value = take<std::int64_t>(at);
+        if (names.back() == "-l") {
+          EXPECT_EQ(value, 4);
+          EXPECT_EQ(entry.source, cmdline::DumpSource::argv);
+        }
+        if (names.back() == "--id") {
+          EXPECT_EQ(count, 1);
+          EXPECT_EQ(value, 9);
+        }
+        break;
+      }
+      case cmdline::DumpType::unsigned_integer:
+        EXPECT_EQ(take<std::uint64_t>(at), 7);
+        EXPECT_EQ(entry.source, cmdline::DumpSource::default_value);
+        break;
+      case cmdline::DumpType::number:
+        EXPECT_EQ(take<double>(at), 0.5);
+        break;
+      case cmdline::DumpType::string: {
+        const std::uint32_t length = take<std::uint32_t>(at);
+        if (names.back() == "--name") {
+          EXPECT_EQ(std::string(at, length), "n");
+        }
+        at += length;
+        break;
+      }
+      }
+    }
+  }
+  EXPECT_EQ(at, out.data() + out.size());
+  EXPECT_EQ(names, (std::vector<std::string> { "--help", "--verbose", "-l", "--limit", "--ratio", "--name", "--id",
+                                               "--pair", "--memory", "input", "rest" }));
+}
+
+TEST_F(DumpTests, WriteConfig) {
+  int fds[2];
+  ASSERT_EQ(::pipe(fds), 0);
+  ASSERT_TRUE(p.write_config(fds[1], cmdline::DumpFormat::json));
+  ASSERT_TRUE(p.write_config(fds[1], cmdline::DumpFormat::json));
+  ::close(fds[1]);
+  std::string read;
+  char buffer[4096];
+  for (ssize_t n; (n = ::read(fds[0], buffer, sizeof(buffer))) > 0;) {
+    read.append(buffer, static_cast<std::size_t>(n));
+  }
+  ::close(fds[0]);
+  const std::string one = dump(cmdline::DumpFormat::json);
+  EXPECT_EQ(read, one + one);
+}
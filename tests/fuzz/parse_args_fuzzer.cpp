@@ -0,0 +1,163 @@
+/*
+ * libFuzzer target for ArgumentParser::parse_args.
+ *
+ * The input is split at NUL bytes into argv elements; the first byte selects
+ * parser settings (abbreviations, a catch-all argument, resource limits,
+ * ignoring unknown options, classifying elements ahead of parsing).
+ * Besides looking for crashes, every input is also parsed scaled up (more
+ * tokens, and longer tokens) and the run traps if the time grows much faster
+ * than the input, to catch super-linear parse paths.
+ * Set CMDLINE_FUZZ_NO_TIMING to skip the timing check.
+ */
+#include "cmdline.h"
+
+#include <unistd.h>
+
+#include <cstdint>
+#include <cstdlib>
+
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <vector>
+
+namespace {
+
+constexpr std::size_t MAX_TOKENS = 4096;
+// The input is timed scaled by SCALE and by SCALE * SCALE, so the fixed cost
+// of setting up the parser does not hide the growth
+constexpr std::size_t SCALE = 4;
+// Allowed growth beyond linear, plus an absolute allowance for noise
+constexpr double MAX_FACTOR = 2.0;
+constexpr double SLACK_NS = 100'000.0;
+
+FILE *g_log = stderr;
+
+struct Input {
+  std::uint8_t settings;
+  std::vector<std::string> tokens;
+};
+
+bool parse(const Input &input) {
+  cmdline::ArgumentParser p;
+  p.error_messages = false;
+  p.abbreviations = input.settings & 1;
+  p.ignore_unknown = input.settings & 8;
+  if (input.settings & 16) {
+    p.classify_min_tokens = 0;
+  }
+  if (input.settings & 4) {
+    p.limits.max_tokens = 64;
+    p.limits.max_total_bytes = 4096;
+    p.limits.max_occurrences = 4;
+    p.limits.max_list_values = 3;
+    p.limits.max_arena_bytes = 256;
+  }
+
+  bool a = false, b = false, c = false;
+  int number = 0;
+  std::vector<std::string> names;
+  std::array<double, 2> pair;
+  cmdline::Bytes bytes;
+  std::chrono::milliseconds timeout;
+  std::string first;
+  std::vector<const char *> rest;
+
+  p.add_option(a, "", 'a', "alpha");
+  p.add_option(b, "", 'b', "beta");
+  p.add_option(c, "", 'c', "");
+  p.add_option(number, "", 'n', "number");
+  p.add_option(names, "", 's', "name");
+  p.add_option(pair, "", 'p', "pair");
+  p.add_option(bytes, "", 0, "size");
+  p.add_option(timeout, "", 't', "timeout");
+  p.add_argument(first, "", "first", false);
+  if (input.settings & 2) {
+    p.add_argument(rest, "rest");
+  }
+
+  std::vector<const char *> argv { "fuzz" };
+  for (const std::string &t : input.tokens) {
+    argv.push_back(t.c_str());
+  }
+  return p.parse_args(static_cast<int>(argv.size()), argv.data(), false);
+}
+
+double time_ns(const Input &input) {
+  using Clock = std::chrono::steady_clock;
+  double best = 1e300;
+  for (int run = 0; run < 3; ++run) {
+    const auto start = Clock::now();
+    parse(input);
+    best = std::min(best, std::chrono::duration<double, std::nano>(Clock::now() - start).count());
+  }
+  return best;
+}
+
+Input more_tokens(const Input &input, std::size_t scale) {
+  Input result { input.settings, {} };
+  for (std::size_t k = 0; k < scale; ++k) {
+    result.tokens.insert(result.tokens.end(), input.tokens.begin(), input.tokens.end());
+  }
+  return result;
+}
+
+// Keeps the first character so options stay options, `-abc' becomes
+// `-abcabc...'
+Input longer_tokens(const Input &input, std::size_t scale) {
+  Input result { input.settings, {} };
+  for (const std::string &t : input.tokens) {
+    std::string s = t.substr(0, 1);
+    s.reserve(t.size() * scale);
+    for (std::size_t k = 0; k < scale; ++k) {
+      s.append(t, std::min<std::size_t>(1, t.size()));
+    }
+    result.tokens.push_back(std::move(s));
+  }
+  return result;
+}
+
+template <class Scale>
+void check_growth(const Input &input, Scale scale) {
+  const double t_small = time_ns(scale(input, SCALE));
+  const double t_large = time_ns(scale(input, SCALE * SCALE));
+  if (t_large > t_small * SCALE * MAX_FACTOR + SLACK_NS) {
+    std::fprintf(g_log, "super-linear parse time: %.0fns for x%zu, %.0fns for x%zu\n",
+      t_small, SCALE, t_large, SCALE * SCALE);
+    std::fflush(g_log);
+    __builtin_trap();
+  }
+}
+
+}
+
+extern "C" int LLVMFuzzerInitialize(int *, char ***) {
+  // --help prints the usage text even with error messages disabled
+  g_log = fdopen(dup(STDERR_FILENO), "w");
+  std::freopen("/dev/null", "w", stderr);
+  return 0;
+}
+
+extern "C" int LLVMFuzzerTestOneInput(const std::uint8_t *data, std::size_t size) {
+  if (size == 0) {
+    return 0;
+  }
+  Input input { data[0], {} };
+  const char *begin = reinterpret_cast<const char *>(data + 1);
+  const char *end = reinterpret_cast<const char *>(data + size);
+  while (begin < end and input.tokens.size() < MAX_TOKENS) {
+    const char *nul = std::find(begin, end, '\0');
+    input.tokens.emplace_back(begin, nul);
+    begin = nul + 1;
+  }
+
+  parse(input);
+
+  static const bool timing = std::getenv("CMDLINE_FUZZ_NO_TIMING") == nullptr;
+  if (!timing or input.tokens.empty() or input.tokens.size() * SCALE * SCALE > MAX_TOKENS) {
+    return 0;
+  }
+  check_growth(input, more_tokens);
+  check_growth(input, longer_tokens);
+  return 0;
+}
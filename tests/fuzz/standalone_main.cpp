@@ -0,0 +1,45 @@
+/*
+ * Runs a libFuzzer target over files and directories given on the command
+ * line, for compilers without libFuzzer and for replaying the corpus as a
+ * regression test.
+ */
+#include <cstdint>
+#include <cstdio>
+
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <vector>
+
+extern "C" int LLVMFuzzerInitialize(int *argc, char ***argv);
+extern "C" int LLVMFuzzerTestOneInput(const std::uint8_t *data, std::size_t size);
+
+namespace fs = std::filesystem;
+
+static void run_file(const fs::path &path) {
+  std::ifstream in(path, std::ios::binary);
+  const std::vector<char> data { std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>() };
+  LLVMFuzzerTestOneInput(reinterpret_cast<const std::uint8_t *>(data.data()), data.size());
+}
+
+int main(int argc, char **argv) {
+  LLVMFuzzerInitialize(&argc, &argv);
+  std::size_t count = 0;
+  for (int i = 1; i < argc; ++i) {
+    const fs::path path(argv[i]);
+    if (fs::is_directory(path)) {
+      for (const fs::directory_entry &e : fs::recursive_directory_iterator(path)) {
+        if (e.is_regular_file()) {
+          run_file(e.path());
+          ++count;
+        }
+      }
+    }
+    else {
+      run_file(path);
+      ++count;
+    }
+  }
+  std::printf("ran %zu inputs\n", count);
+  return 0;
+}
@@ -0,0 +1,166 @@
+#include "gtest/gtest.h"
+#include "getopt_compat.h"
+
+#include <getopt.h>
+
+#include <random>
+#include <string>
+
+template<typename T, std::size_t N>
+auto size(T (&)[N]) { return N; }
+
+namespace {
+
+int g_flag = 0;
+
+const struct option LONG_OPTIONS[] = {
+  { "verbose", no_argument, nullptr, 'v' },
+  { "output", required_argument, nullptr, 'o' },
+  { "color", optional_argument, nullptr, 'c' },
+  { "colour", optional_argument, nullptr, 'C' },
+  { "brief", no_argument, &g_flag, 1 },
+  { "level", required_argument, nullptr, 1000 },
+  { "help", no_argument, nullptr, 'h' },
+  { nullptr, 0, nullptr, 0 },
+};
+
+struct Call {
+  int result;
+  std::string optarg;
+  int longindex;
+  int optopt;
+  int flag;
+
+  friend bool operator==(const Call &, const Call &) = default;
+};
+
+std::ostream & operator<<(std::ostream &os, const Call &c) {
+  return os << c.result << " `" << c.optarg << "' " << c.longindex << ' ' << c.optopt << ' ' << c.flag;
+}
+
+struct Outcome {
+  std::vector<Call> calls;
+  std::vector<std::string> argv;
+  int optind;
+};
+
+std::vector<std::string> to_strings(int argc, char **argv) {
+  return std::vector<std::string>(argv, argv + argc);
+}
+
+Outcome with_glibc(const char *optstring, std::vector<char *> argv) {
+  Outcome o;
+  optind = 0;
+  opterr = 0;
+  int c;
+  do {
+    int longindex = -1;
+    g_flag = 0;
+    c = getopt_long(static_cast<int>(argv.size()), argv.data(), optstring, LONG_OPTIONS, &longindex);
+    const bool error = c == '?' or c == ':';
+    o.calls.push_back({ c, !error and optarg ? optarg : "", longindex, error ? optopt : 0, g_flag });
+  } while (c != -1);
+  o.argv = to_strings(static_cast<int>(argv.size()), argv.data());
+  o.optind = optind;
+  return o;
+}
+
+Outcome with_cmdline(const char *optstring, std::vector<char *> argv) {
+  Outcome o;
+  cmdline::Getopt g(optstring, LONG_OPTIONS);
+  g.parser().error_messages = false;
+  o.optind = g.parse(static_cast<int>(argv.size()), argv.data());
+  int c;
+  do {
+    int longindex = -1;
+    g_flag = 0;
+    c = g.next(&longindex);
+    const bool error = c == '?' or c == ':';
+    o.calls.push_back({ c, !error and g.optarg() ? g.optarg() : "", longindex, error ? g.optopt() : 0, g_flag });
+  } while (c != -1);
+  o.argv = to_strings(static_cast<int>(argv.size()), argv.data());
+  return o;
+}
+
+std::vector<char *> make_argv(std::initializer_list<const char *> args) {
+  std::vector<char *> argv { const_cast<char *>("program_name") };
+  for (const char *a : args) {
+    argv.push_back(const_cast<char *>(a));
+  }
+  return argv;
+}
+
+}
+
+TEST(GetoptCompatTests, Basic) {
+  cmdline::Getopt g("vo:c::n:", LONG_OPTIONS);
+  auto argv = make_argv({ "in", "-vofile", "--color=red", "-c", "mid", "--level", "-3", "--", "-v" });
+  EXPECT_EQ(g.parse(static_cast<int>(argv.size()), argv.data()), 7);
+  EXPECT_EQ(g.next(), 'v');
+  EXPECT_EQ(g.next(), 'o');
+  EXPECT_STREQ(g.optarg(), "file");
+  int longindex = -1;
+  EXPECT_EQ(g.next(&longindex), 'c');
+  EXPECT_STREQ(g.optarg(), "red");
+  EXPECT_EQ(longindex, 2);
+  longindex = -1;
+  EXPECT_EQ(g.next(&longindex), 'c');
+  EXPECT_EQ(g.optarg(), nullptr);
+  EXPECT_EQ(longindex, -1);
+  EXPECT_EQ(g.next(), 1000);
+  EXPECT_STREQ(g.optarg(), "-3");
+  EXPECT_EQ(g.next(), -1);
+  EXPECT_EQ(g.error_count(), 0);
+  const char *expected[] = {
+    "program_name", "-vofile", "--color=red", "-c", "--level", "-3", "--", "in", "mid", "-v"
+  };
+  ASSERT_EQ(argv.size(), size(expected));
+  for (std::size_t i = 0; i < argv.size(); ++i) {
+    EXPECT_STREQ(argv[i], expected[i]);
+  }
+}
+
+TEST(GetoptCompatTests, Errors) {
+  cmdline::Getopt g(":vo:", LONG_OPTIONS);
+  auto argv = make_argv({ "-x", "--verbose=1", "--col", "--nope", "-o" });
+  g.parse(static_cast<int>(argv.size()), argv.data());
+  EXPECT_EQ(g.next(), '?');
+  EXPECT_EQ(g.optopt(), 'x');
+  EXPECT_EQ(g.next(), '?');
+  EXPECT_EQ(g.optopt(), 'v');
+  // Ambiguous between `--color' and `--colour'
+  EXPECT_EQ(g.next(), '?');
+  EXPECT_EQ(g.optopt(), 0);
+  EXPECT_EQ(g.next(), '?');
+  EXPECT_EQ(g.next(), ':');
+  EXPECT_EQ(g.optopt(), 'o');
+  EXPECT_EQ(g.next(), -1);
+  EXPECT_EQ(g.error_count(), 5);
+}
+
+TEST(GetoptCompatTests, MatchesGlibc) {
+  static const char *const pool[] = {
+    "-v", "-vv", "-o", "out", "-ofile", "-vo", "-c", "-cred", "-vcblue", "-x", "-h", "-n", "5", "-n5", "-vn",
+    "--verbose", "--verb", "--output", "--output=o", "--out", "--color", "--color=c", "--colour=c", "--col",
+    "--brief", "--br", "--level", "--level=2", "--help", "--he", "--nope", "--verbose=1", "--brief=x",
+    "--", "-", "", "operand", "another", "-3",
+  };
+  static const char *const optstrings[] = { "vo:c::hn:", "+vo:c::hn:", "-vo:c::hn:", ":vo:c::hn:", "-:vo:c::hn:" };
+  std::mt19937 rng(5);
+  for (int step = 0; step < 5000; ++step) {
+    std::vector<char *> argv { const_cast<char *>("program_name") };
+    for (std::size_t n = rng() % 10; n > 0; --n) {
+      argv.push_back(const_cast<char *>(pool[rng() % size(pool)]));
+    }
+    const char *optstring = optstrings[rng() % size(optstrings)];
+    const Outcome expected = with_glibc(optstring, argv);
+    const Outcome actual = with_cmdline(optstring, argv);
+    std::string command_line;
+    for (char *a : argv) {
+      command_line += std::string(" `") + a + "'";
+    }
+    ASSERT_EQ(actual.calls, expected.calls) << optstring << command_line;
+    ASSERT_EQ(actual.argv, expected.argv) << optstring << command_line;
+    ASSERT_EQ(actual.optind, expected.optind) << optstring << command_line;
+  }
+}
@@ -0,0 +1,144 @@
+#include "gtest/gtest.h"
+#include "cmdline.h"
+
+template<typename T, std::size_t N>
+auto size(T (&)[N]) { return N; }
+
+namespace {
+
+struct Logging {
+  std::string level = "info";
+  bool json = false;
+  bool configured = false;
+
+  void add_options(cmdline::ArgumentParser &p) {
+    cmdline::OptionGroup group = p.add_group("log", "Logging");
+    group.add_option(level, "Minimum level", 0, "level");
+    group.add_option(json, "Write JSON", 0, "json");
+    group.on_parsed([this](const cmdline::OptionGroup &g) {
+      configured = g.given("level") or g.given("json");
+    });
+  }
+};
+
+struct Metrics {
+  int port = 0;
+  bool verbose = false;
+  std::vector<std::string> tags;
+
+  void add_options(cmdline::ArgumentParser &p) {
+    cmdline::OptionGroup group = p.add_group("metrics");
+    group.add_option(port, "Port to serve on", 'p', "port");
+    group.add_option(verbose, "", 'v', "verbose");
+    group.add_option(tags, "", 0, "tag");
+  }
+};
+
+}
+
+TEST(GroupTests, OnePass) {
+  cmdline::ArgumentParser p;
+  p.error_messages = false;
+  bool dry_run = false;
+  std::string file;
+  p.add_option(dry_run, "", 'n', "dry-run");
+  p.add_argument(file, "", "file");
+  Logging logging;
+  Metrics metrics;
+  logging.add_options(p);
+  metrics.add_options(p);
+
+  const char *argv[] = {
+    "program_name", "--log.level=debug", "-nvp", "9000", "--metrics.tag", "a", "--metrics.tag=b", "f",
+  };
+  // `-nvp' groups flags of different groups; `p' takes an argument
+  EXPECT_FALSE(p.parse_args(size(argv), argv, false));
+  argv[2] = "-nv";
+  argv[3] = "-p9000";
+  ASSERT_TRUE(p.parse_args(size(argv), argv, false));
+  EXPECT_TRUE(dry_run);
+  EXPECT_EQ(logging.level, "debug");
+  EXPECT_FALSE(logging.json);
+  EXPECT_TRUE(logging.configured);
+  EXPECT_EQ(metrics.port, 9000);
+  EXPECT_TRUE(metrics.verbose);
+  EXPECT_EQ(metrics.tags, (std::vector<std::string> { "a", "b" }));
+  EXPECT_EQ(file, "f");
+
+  const char *plain[] = { "program_name", "f" };
+  ASSERT_TRUE(p.parse_args(size(plain), plain, false));
+  EXPECT_FALSE(logging.configured);
+}
+
+TEST(GroupTests, Conflicts) {
+  cmdline::ArgumentParser p;
+  p.error_messages = false;
+  cmdline::Diagnostic d[4];
+  p.set_diagnostic_buffer(d, size(d));
+
+  cmdline::OptionGroup log = p.add_group("log");
+  ASSERT_TRUE(log.valid());
+  EXPECT_EQ(log.name(), "log");
+  cmdline::OptionGroup again = p.add_group("log");
+  EXPECT_FALSE(again.valid());
+  EXPECT_EQ(d[0].code, cmdline::ErrorCode::duplicate_group);
+  char message[64];
+  p.format_diagnostic(d[0], nullptr, message, sizeof(message));
+  EXPECT_STREQ(message, "duplicate option group `log'");
+  int x;
+  EXPECT_FALSE(again.add_option(x, "", 0, "level"));
+  EXPECT_FALSE(p.add_group("").valid());
+  EXPECT_FALSE(p.add_group("a.b").valid());
+  EXPECT_FALSE(p.add_group("-a").valid());
+
+  // Same long name in different groups is fine, short names are shared
+  cmdline::OptionGroup metrics = p.add_group("metrics");
+  int a, b;
+  EXPECT_TRUE(log.add_option(a, "", 'l', "level"));
+  EXPECT_TRUE(metrics.add_option(b, "", 0, "level"));
+  EXPECT_FALSE(metrics.add_option(b, "", 'l', "other"));
+  EXPECT_FALSE(metrics.add_option(b, "", 0, "level"));
+
+  int c;
+  EXPECT_FALSE(p.add_option(c, "", 0, "log.level"));
+}
+
+TEST(GroupTests, IgnoreUnknown) {
+  // A library-local parser that only knows its own options
+  cmdline::ArgumentParser p;
+  p.error_messages = false;
+  p.ignore_unknown = true;
+  Metrics metrics;
+  metrics.add_options(p);
+
+  const char *argv[] = {
+    "program_name", "--log.level=debug", "-xp1", "file", "--metrics.port=9000", "-vq", "--other", "more",
+  };
+  ASSERT_TRUE(p.parse_args(size(argv), argv, false));
+  EXPECT_EQ(metrics.port, 9000);
+  EXPECT_TRUE(metrics.verbose);
+
+  p.ignore_unknown = false;
+  EXPECT_FALSE(p.parse_args(size(argv), argv, false));
+}
+
+TEST(GroupTests, Usage) {
+  cmdline::ArgumentParser p;
+  bool dry_run = false;
+  p.add_option(dry_run, "Do nothing", 'n', "dry-run");
+  Logging logging;
+  Metrics metrics;
+  logging.add_options(p);
+  metrics.add_options(p);
+
+  char *text;
+  std::size_t length;
+  FILE *file = open_memstream(&text, &length);
+  p.usage(file, "program_name");
+  std::fclose(file);
+  const std::string usage(text, length);
+  std::free(text);
+  EXPECT_NE(usage.find("  -n, --dry-run         Do nothing\n\nlog options: Logging\n"
+                       "  --log.level  LEVEL    Minimum level\n"), std::string::npos) << usage;
+  EXPECT_NE(usage.find("\nmetrics options:\n  -p, --metrics.port  PORT\n"), std::string::npos) << usage;
+}
@@ -0,0 +1,31 @@
+#include "gtest/gtest.h"
+#include "cmdline.h"
+#include "getopt_compat.h"
+
+TEST(HeaderOnlyTests, Parse) {
+  cmdline::ArgumentParser p;
+  p.error_messages = false;
+  bool verbose = false;
+  cmdline::Bytes size;
+  std::string name;
+  p.add_option(verbose, "", 'v', "verbose");
+  p.add_option(size, "", 's', "size");
+  p.add_argument(name, "", "name");
+  const char *argv[] = { "program_name", "-v", "--size=4KiB", "file" };
+  ASSERT_TRUE(p.parse_args(4, argv, false));
+  EXPECT_TRUE(verbose);
+  EXPECT_EQ(size.value, 4096);
+  EXPECT_EQ(name, "file");
+}
+
+TEST(HeaderOnlyTests, Getopt) {
+  const struct option long_options[] = {
+    { "verbose", no_argument, nullptr, 'v' },
+    { nullptr, 0, nullptr, 0 },
+  };
+  cmdline::Getopt g("vo:", long_options);
+  char *argv[] = { const_cast<char *>("program_name"), const_cast<char *>("in"), const_cast<char *>("-ofile") };
+  EXPECT_EQ(g.parse(3, argv), 2);
+  EXPECT_EQ(g.next(), 'o');
+  EXPECT_STREQ(g.optarg(), "file");
+}
@@ -0,0 +1,26 @@
+#include "gtest/gtest.h"
+#include "cmdline.h"
+#include "getopt_compat.h"
+
+TEST(HeaderOnlyTests, Session) {
+  cmdline::ArgumentParser p;
+  p.error_messages = false;
+  int number = 0;
+  p.add_option(number, "", 'n', "number");
+  cmdline::ParseSession s(p, "program_name");
+  s.edit(0, 0, { "-n", "x" });
+  EXPECT_FALSE(s.valid());
+  s.edit(1, 1, { "3" });
+  EXPECT_TRUE(s.valid());
+  EXPECT_TRUE(s.apply());
+  EXPECT_EQ(number, 3);
+}
+
+TEST(HeaderOnlyTests, Tokenize) {
+  char command[] = "a 'b c' d";
+  const char *tokens[4];
+  const cmdline::TokenizeResult r = cmdline::tokenize(command, tokens, 4);
+  ASSERT_TRUE(r);
+  EXPECT_EQ(r.count, 3);
+  EXPECT_STREQ(tokens[1], "b c");
+}
@@ -0,0 +1,105 @@
+#include "gtest/gtest.h"
+#include "cmdline.h"
+
+#include <cstdlib>
+
+#include <random>
+#include <string>
+#include <string_view>
+
+template<typename T, std::size_t N>
+auto size(T (&)[N]) { return N; }
+
+namespace {
+
+std::string round_trip(std::string_view text) {
+  std::string compressed;
+  cmdline::detail::lz_compress(text, compressed);
+  std::string decompressed;
+  cmdline::detail::lz_decompress(compressed, decompressed);
+  return decompressed;
+}
+
+std::string usage_of(cmdline::ArgumentParser &p) {
+  char *text;
+  std::size_t length;
+  FILE *file = open_memstream(&text, &length);
+  p.usage(file, "program_name");
+  std::fclose(file);
+  const std::string usage(text, length);
+  std::free(text);
+  return usage;
+}
+
+struct Options {
+  std::vector<int> values = std::vector<int>(2000);
+  std::string file;
+  std::vector<std::string> help;
+
+  Options() {
+    for (std::size_t i = 0; i < values.size(); ++i) {
+      help.push_back("Sets the value of option number " + std::to_string(i) + " used by the program");
+    }
+  }
+
+  void add_to(cmdline::ArgumentParser &p) {
+    for (std::size_t i = 0; i < values.size(); ++i) {
+      p.add_option(values[i], help[i].c_str(), 0, ("option-" + std::to_string(i)).c_str(),
+                   i % 2 ? "N" : nullptr);
+    }
+    p.add_argument(file, "File to read", "file");
+  }
+};
+
+}
+
+TEST(HelpTextTests, CompressionRoundTrips) {
+  using namespace std::literals;
+  const std::string_view texts[] = {
+    ""sv,
+    "abc"sv,
+    "aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa"sv,
+    "Display this message\0Display this message\0Display that message"sv,
+  };
+  for (std::size_t i = 0; i < size(texts); ++i) {
+    EXPECT_EQ(round_trip(texts[i]), texts[i]);
+  }
+  std::mt19937 random(42);
+  std::string noise(100'000, '\0');
+  for (char &ch : noise) {
+    ch = static_cast<char>(random() % 4 + 'a');
+  }
+  EXPECT_EQ(round_trip(noise), noise);
+}
+
+TEST(HelpTextTests, StoreKeepsOffsets) {
+  cmdline::detail::HelpStore store;
+  std::vector<std::pair<cmdline::detail::HelpText, std::string>> added;
+  for (int i = 0; i < 5000; ++i) {
+    const std::string text = "Help text " + std::to_string(i * 7);
+    added.emplace_back(store.add(text, i % 3 != 0), text);
+  }
+  EXPECT_TRUE(store.add("", true).empty());
+  const std::string decoded = store.decode();
+  for (const auto &[help, text] : added) {
+    EXPECT_EQ(help.c_str(decoded), text);
+  }
+}
+
+TEST(HelpTextTests, UsageIsTheSameForEachStorage) {
+  Options copied_options, compressed_options, static_options;
+  cmdline::ArgumentParser copied, compressed, kept;
+  compressed.compress_help = true;
+  kept.static_help = true;
+  copied_options.add_to(copied);
+  compressed_options.add_to(compressed);
+  static_options.add_to(kept);
+
+  const std::string usage = usage_of(copied);
+  EXPECT_NE(usage.find("  --option-1  N         Sets the value of option number 1 used by the program\n"),
+            std::string::npos);
+  EXPECT_NE(usage.find(" [--option-2 OPTION_2] "), std::string::npos);
+  EXPECT_NE(usage.find("  file                  File to read\n"), std::string::npos);
+  EXPECT_EQ(usage_of(compressed), usage);
+  EXPECT_EQ(usage_of(kept), usage);
+}
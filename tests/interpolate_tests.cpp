@@ -0,0 +1,147 @@
+#include "gtest/gtest.h"
+#include "cmdline.h"
+
+#include <cstdlib>
+
+template<typename T, std::size_t N>
+auto size(T (&)[N]) { return N; }
+
+namespace {
+
+struct InterpolateTests : ::testing::Test {
+  std::string out;
+  std::string home;
+
+  void SetUp() override {
+    home = std::getenv("HOME") ? std::getenv("HOME") : "";
+    ::setenv("HOME", "/home/user", 1);
+    ::setenv("CMDLINE_A", "alpha", 1);
+    ::setenv("CMDLINE_B", "${CMDLINE_A}/b", 1);
+    ::setenv("CMDLINE_SELF", "x${CMDLINE_SELF}", 1);
+    ::setenv("CMDLINE_EMPTY", "", 1);
+    ::unsetenv("CMDLINE_UNSET");
+  }
+
+  void TearDown() override {
+    ::setenv("HOME", home.c_str(), 1);
+  }
+
+  std::string expand(const char *text) {
+    const cmdline::InterpolateResult result = cmdline::interpolate(text, out);
+    EXPECT_TRUE(result) << text;
+    return result ? result.value : "";
+  }
+};
+
+}
+
+TEST_F(InterpolateTests, Unchanged) {
+  static const char *const texts[] = { "", "plain", "a$b", "$", "x~", "~user/x", "a}b{" };
+  for (const char *text : texts) {
+    out = "untouched";
+    const cmdline::InterpolateResult result = cmdline::interpolate(text, out);
+    EXPECT_TRUE(result);
+    EXPECT_EQ(result.value, text) << text;
+  }
+  EXPECT_EQ(out, "untouched");
+}
+
+TEST_F(InterpolateTests, Expand) {
+  EXPECT_EQ(expand("${CMDLINE_A}"), "alpha");
+  EXPECT_EQ(expand("x${CMDLINE_A}y${CMDLINE_A}z"), "xalphayalphaz");
+  EXPECT_EQ(expand("${CMDLINE_EMPTY}-"), "-");
+  EXPECT_EQ(expand("~"), "/home/user");
+  EXPECT_EQ(expand("~/run/${CMDLINE_A}"), "/home/user/run/alpha");
+  EXPECT_EQ(expand("a/~"), "a/~");
+  EXPECT_EQ(expand("$$"), "$");
+  EXPECT_EQ(expand("$${CMDLINE_A}"), "${CMDLINE_A}");
+  EXPECT_EQ(expand("cost $5 ${CMDLINE_A}"), "cost $5 alpha");
+  EXPECT_EQ(expand("${CMDLINE_B}/c"), "alpha/b/c");
+}
+
+TEST_F(InterpolateTests, Errors) {
+  struct Case {
+    const char *text;
+    cmdline::InterpolateStatus status;
+    std::size_t offset;
+  };
+  static const Case cases[] = {
+    { "x${CMDLINE_UNSET}", cmdline::InterpolateStatus::undefined_variable, 1 },
+    { "ab${", cmdline::InterpolateStatus::unterminated_variable, 2 },
+    { "${CMDLINE_A", cmdline::InterpolateStatus::unterminated_variable, 0 },
+    { "--${CMDLINE_SELF}", cmdline::InterpolateStatus::too_deep, 2 },
+    { "${}", cmdline::InterpolateStatus::undefined_variable, 0 },
+  };
+  for (const Case &c : cases) {
+    const cmdline::InterpolateResult result = cmdline::interpolate(c.text, out);
+    EXPECT_EQ(result.status, c.status) << c.text;
+    EXPECT_EQ(result.offset, c.offset) << c.text;
+  }
+
+  EXPECT_EQ(cmdline::interpolate("${CMDLINE_B}", out, 0).status, cmdline::InterpolateStatus::too_deep);
+  EXPECT_TRUE(cmdline::interpolate("${CMDLINE_B}", out, 1));
+  EXPECT_EQ(cmdline::interpolate("${CMDLINE_A}${CMDLINE_A}", out, 8, 9).status,
+            cmdline::InterpolateStatus::too_long);
+  EXPECT_TRUE(cmdline::interpolate("${CMDLINE_A}${CMDLINE_A}", out, 8, 10));
+
+  ::unsetenv("HOME");
+  EXPECT_EQ(cmdline::interpolate("~/x", out).status, cmdline::InterpolateStatus::undefined_variable);
+}
+
+TEST_F(InterpolateTests, Parser) {
+  cmdline::ArgumentParser p;
+  p.error_messages = false;
+  std::string dir;
+  const char *name = nullptr;
+  std::array<std::string, 2> pair;
+  std::string first;
+  std::vector<const char *> rest;
+  p.add_option(dir, "", 'd', "data-dir");
+  p.add_option(name, "", 'n', "name");
+  p.add_option(pair, "", 'p', "pair");
+  p.add_argument(first, "", "first");
+  p.add_argument(rest, "rest");
+
+  const char *argv[] = { "program_name", "--data-dir=${CMDLINE_A}/run", "-nplain", "-p", "~", "$$",
+                         "${CMDLINE_B}", "~/x", "y" };
+  ASSERT_TRUE(p.parse_args(size(argv), argv, false));
+  EXPECT_EQ(dir, "${CMDLINE_A}/run");
+  EXPECT_EQ(first, "${CMDLINE_B}");
+
+  p.interpolate_values = true;
+  rest.clear();
+  ASSERT_TRUE(p.parse_args(size(argv), argv, false));
+  EXPECT_EQ(dir, "alpha/run");
+  EXPECT_STREQ(name, "plain");
+  EXPECT_EQ(pair, (std::array<std::string, 2> { "/home/user", "$" }));
+  EXPECT_EQ(first, "alpha/b");
+  ASSERT_EQ(rest.size(), 2);
+  EXPECT_STREQ(rest[0], "/home/user/x");
+  EXPECT_EQ(rest[1], argv[8]);
+}
+
+TEST_F(InterpolateTests, ParserErrors) {
+  cmdline::ArgumentParser p;
+  p.error_messages = false;
+  p.interpolate_values = true;
+  std::string dir;
+  p.add_option(dir, "", 'd', "data-dir");
+  cmdline::Diagnostic d;
+  p.set_diagnostic_buffer(&d, 1);
+
+  const char *argv[] = { "program_name", "-dx${CMDLINE_UNSET}" };
+  ASSERT_FALSE(p.parse_args(size(argv), argv, false));
+  EXPECT_EQ(d.code, cmdline::ErrorCode::interpolation_failed);
+  EXPECT_EQ(static_cast<cmdline::InterpolateStatus>(d.detail), cmdline::InterpolateStatus::undefined_variable);
+  EXPECT_EQ(d.argv_index, 1);
+  EXPECT_EQ(d.offset, 3);
+  char message[128];
+  p.format_diagnostic(d, argv, message, sizeof(message));
+  EXPECT_STREQ(message, "program_name: undefined variable in `-dx${CMDLINE_UNSET}'");
+
+  p.max_interpolated_length = 4;
+  const char *long_value[] = { "program_name", "--data-dir", "${CMDLINE_A}" };
+  ASSERT_FALSE(p.parse_args(size(long_value), long_value, false));
+  EXPECT_EQ(static_cast<cmdline::InterpolateStatus>(d.detail), cmdline::InterpolateStatus::too_long);
+  EXPECT_EQ(d.argv_index, 2);
+}
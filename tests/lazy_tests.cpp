@@ -0,0 +1,128 @@
+#include "gtest/gtest.h"
+#include "cmdline.h"
+
+template<typename T, std::size_t N>
+auto size(T (&)[N]) { return N; }
+
+namespace {
+
+struct Counted {
+  int value;
+};
+
+std::size_t g_conversions = 0;
+
+bool parse_value(const char *str, Counted &c) {
+  ++g_conversions;
+  char *end;
+  c.value = static_cast<int>(std::strtol(str, &end, 10));
+  return *str and !*end;
+}
+
+}
+
+TEST(LazyTests, ConvertsOnFirstRead) {
+  cmdline::ArgumentParser p;
+  cmdline::Lazy<Counted> counted;
+  cmdline::Lazy<int> number = 7;
+  std::vector<cmdline::Lazy<cmdline::Bytes>> sizes;
+  p.add_option(counted, "", 'k', "counted");
+  p.add_option(number, "", 'n', "number");
+  p.add_option(sizes, "", 's', "size");
+  const char *argv[] = { "program_name", "-k", "12", "-s", "1KiB", "-s", "x" };
+  g_conversions = 0;
+  ASSERT_TRUE(p.parse_args(size(argv), argv, false));
+  EXPECT_EQ(g_conversions, 0);
+
+  EXPECT_STREQ(counted.text(), "12");
+  EXPECT_EQ(counted->value, 12);
+  EXPECT_EQ((*counted).value, 12);
+  EXPECT_EQ(g_conversions, 1);
+  EXPECT_TRUE(counted.valid());
+  EXPECT_EQ(g_conversions, 1);
+
+  EXPECT_EQ(number.text(), nullptr);
+  EXPECT_TRUE(number.valid());
+  EXPECT_EQ(*number, 7);
+
+  ASSERT_EQ(sizes.size(), 2);
+  EXPECT_TRUE(sizes[0].valid());
+  EXPECT_EQ(sizes[0]->value, 1024);
+  EXPECT_FALSE(sizes[1].valid());
+  EXPECT_EQ(sizes[1]->value, 0);
+}
+
+TEST(LazyTests, InvalidKeepsDefault) {
+  cmdline::Lazy<int> number = 3;
+  number.assign("abc");
+  EXPECT_FALSE(number.valid());
+  EXPECT_EQ(*number, 3);
+  number.assign("4");
+  EXPECT_EQ(*number, 4);
+}
+
+TEST(LazyTests, ConvertDuringParse) {
+  cmdline::ArgumentParser p;
+  p.error_messages = false;
+  p.convert_lazy_values = true;
+  cmdline::Lazy<Counted> counted;
+  p.add_option(counted, "", 'k', "counted");
+  cmdline::Diagnostic d;
+  p.set_diagnostic_buffer(&d, 1);
+
+  const char *good[] = { "program_name", "-k", "5" };
+  g_conversions = 0;
+  ASSERT_TRUE(p.parse_args(size(good), good, false));
+  EXPECT_EQ(g_conversions, 1);
+  EXPECT_EQ(counted->value, 5);
+  EXPECT_EQ(g_conversions, 1);
+
+  const char *bad[] = { "program_name", "-k", "x" };
+  EXPECT_FALSE(p.parse_args(size(bad), bad, false));
+  EXPECT_EQ(d.code, cmdline::ErrorCode::option_invalid_argument);
+  EXPECT_EQ(d.argv_index, 2);
+}
+
+TEST(LazyTests, SaveAndLoad) {
+  cmdline::ArgumentParser p;
+  cmdline::Lazy<double> ratio;
+  cmdline::Lazy<int> number;
+  p.add_option(ratio, "", 'r', "ratio");
+  p.add_option(number, "", 'n', "number");
+  const char *argv[] = { "program_name", "-r", "0.25", "-n", "9" };
+  ASSERT_TRUE(p.parse_args(size(argv), argv, false));
+  std::vector<char> blob;
+  ASSERT_TRUE(p.save_result(blob));
+
+  ratio = {};
+  number = {};
+  ASSERT_TRUE(p.load_result(blob.data(), blob.size()));
+  EXPECT_EQ(*ratio, 0.25);
+  EXPECT_EQ(*number, 9);
+
+  std::vector<std::string> args;
+  ASSERT_TRUE(p.canonical_args(args));
+  EXPECT_EQ(args, (std::vector<std::string> { "--ratio=0.25", "--number=9" }));
+}
+
+TEST(LazyTests, Quantities) {
+  cmdline::ArgumentParser p;
+  p.error_messages = false;
+  cmdline::Lazy<std::chrono::milliseconds> timeout;
+  cmdline::Lazy<cmdline::Bytes> limit;
+  p.add_option(timeout, "", 't', "timeout");
+  p.add_option(limit, "", 'l', "limit");
+  const char *argv[] = { "program_name", "--timeout=1.5s", "--limit=4KiB" };
+  ASSERT_TRUE(p.parse_args(size(argv), argv, false));
+  EXPECT_TRUE(timeout.valid());
+  EXPECT_EQ(*timeout, std::chrono::milliseconds(1500));
+  EXPECT_TRUE(limit.valid());
+  EXPECT_EQ(limit->value, 4096);
+
+  const char *invalid[] = { "program_name", "--timeout=soon", "--limit=4XB" };
+  ASSERT_TRUE(p.parse_args(size(invalid), invalid, false));
+  EXPECT_FALSE(timeout.valid());
+  EXPECT_FALSE(limit.valid());
+  p.convert_lazy_values = true;
+  EXPECT_FALSE(p.parse_args(size(invalid), invalid, false));
+}
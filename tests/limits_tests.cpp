@@ -0,0 +1,118 @@
+#include "gtest/gtest.h"
+#include "cmdline.h"
+
+template<typename T, std::size_t N>
+auto size(T (&)[N]) { return N; }
+
+namespace {
+
+struct LimitsTests : ::testing::Test {
+  cmdline::ArgumentParser p;
+  cmdline::Diagnostic d;
+  bool flag = false;
+  std::vector<int> numbers;
+  std::vector<const char *> rest;
+
+  void SetUp() override {
+    p.error_messages = false;
+    p.set_diagnostic_buffer(&d, 1);
+    p.add_option(flag, "", 'f', "flag");
+    p.add_option(numbers, "", 'n', "number");
+    p.add_argument(rest, "rest");
+  }
+
+  template<std::size_t N>
+  std::string fail(const char *(&argv)[N], cmdline::LimitKind kind) {
+    EXPECT_FALSE(p.parse_args(N, argv, false));
+    EXPECT_EQ(p.diagnostic_count(), 1);
+    EXPECT_EQ(d.code, cmdline::ErrorCode::limit_exceeded);
+    EXPECT_EQ(d.detail, static_cast<std::uint16_t>(kind));
+    char buffer[128];
+    p.format_diagnostic(d, argv, buffer, sizeof(buffer));
+    return buffer;
+  }
+};
+
+}
+
+TEST_F(LimitsTests, Unlimited) {
+  const char *argv[] = {"program_name", "-f", "-n1", "-n", "2", "a", "b"};
+  EXPECT_TRUE(p.parse_args(size(argv), argv, false));
+  EXPECT_EQ(numbers.size(), 2);
+  EXPECT_EQ(rest.size(), 2);
+}
+
+TEST_F(LimitsTests, Tokens) {
+  p.limits.max_tokens = 2;
+  const char *ok[] = {"program_name", "-f", "a"};
+  EXPECT_TRUE(p.parse_args(size(ok), ok, false));
+  const char *argv[] = {"program_name", "-f", "a", "b"};
+  EXPECT_EQ(fail(argv, cmdline::LimitKind::tokens), "program_name: too many arguments (at most 2)");
+  EXPECT_EQ(d.argv_index, 3);
+}
+
+TEST_F(LimitsTests, TotalBytes) {
+  p.limits.max_total_bytes = 8;
+  const char *ok[] = {"program_name", "-f", "abcdef"};
+  EXPECT_TRUE(p.parse_args(size(ok), ok, false));
+  const char *argv[] = {"program_name", "-f", "abc", "defgh"};
+  EXPECT_EQ(fail(argv, cmdline::LimitKind::total_bytes), "program_name: arguments exceed 8 bytes");
+  EXPECT_EQ(d.argv_index, 3);
+  EXPECT_EQ(d.offset, 3);
+}
+
+TEST_F(LimitsTests, Occurrences) {
+  p.limits.max_occurrences = 2;
+  const char *argv[] = {"program_name", "-f", "--flag", "-f"};
+  EXPECT_EQ(fail(argv, cmdline::LimitKind::occurrences), "program_name: option `--flag' given more than 2 times");
+  EXPECT_EQ(d.argv_index, 3);
+}
+
+TEST_F(LimitsTests, ListValues) {
+  p.limits.max_list_values = 2;
+  {
+    const char *argv[] = {"program_name", "-n1", "-n2", "-n3"};
+    EXPECT_EQ(fail(argv, cmdline::LimitKind::list_values), "program_name: too many values for option `--number' (at most 2)");
+    EXPECT_EQ(numbers.size(), 2);
+  }
+  {
+    const char *argv[] = {"program_name", "a", "b", "c"};
+    EXPECT_EQ(fail(argv, cmdline::LimitKind::list_values), "program_name: too many positional arguments (at most 2)");
+    EXPECT_EQ(d.argv_index, 3);
+  }
+}
+
+TEST_F(LimitsTests, ArenaBytes) {
+  p.limits.max_arena_bytes = 2 * sizeof(const char *) + 6;
+  const char *ok[] = {"program_name", "abc", "def"};
+  EXPECT_TRUE(p.parse_args(size(ok), ok, false));
+  const char *argv[] = {"program_name", "abc", "defg"};
+  fail(argv, cmdline::LimitKind::arena_bytes);
+  EXPECT_EQ(d.argv_index, 2);
+}
+
+TEST_F(LimitsTests, ArenaBytesAcrossParses) {
+  std::string_view name;
+  p.add_option(name, "", 'm', "name");
+  p.limits.max_arena_bytes = 8;
+  const char *ok[] = {"program_name", "--name=abc"};
+  EXPECT_TRUE(p.parse_args(size(ok), ok, false));
+  EXPECT_TRUE(p.parse_args(size(ok), ok, false));
+  EXPECT_EQ(p.string_arena().bytes_used(), 8);
+  // The arena keeps the values of earlier parses until it is cleared
+  const char *argv[] = {"program_name", "-f", "-mx"};
+  EXPECT_EQ(fail(argv, cmdline::LimitKind::arena_bytes), "program_name: values exceed 8 bytes");
+  EXPECT_EQ(d.argv_index, 2);
+  EXPECT_EQ(d.offset, 2);
+  p.string_arena().clear();
+  EXPECT_TRUE(p.parse_args(size(argv), argv, false));
+  EXPECT_EQ(name, "x");
+
+  // Interpolated values are kept in the arena as well
+  ::setenv("CMDLINE_LIMITS_VALUE", "0123456789", 1);
+  p.interpolate_values = true;
+  p.string_arena().clear();
+  const char *expanded[] = {"program_name", "-n", "${CMDLINE_LIMITS_VALUE}"};
+  fail(expanded, cmdline::LimitKind::arena_bytes);
+  EXPECT_EQ(d.argv_index, 2);
+}
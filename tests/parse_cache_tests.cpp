@@ -0,0 +1,169 @@
+#include "gtest/gtest.h"
+#include "cmdline.h"
+
+#include <unistd.h>
+
+#include <filesystem>
+#include <fstream>
+
+template<typename T, std::size_t N>
+auto size(T (&)[N]) { return N; }
+
+namespace fs = std::filesystem;
+
+namespace {
+
+struct ParseCacheTests : ::testing::Test {
+  fs::path dir;
+  fs::path config;
+  cmdline::ArgumentParser p;
+  bool verbose = false;
+  int number = 0;
+  std::string_view name;
+  std::string file;
+
+  void SetUp() override {
+    dir = fs::temp_directory_path() / ("cmdline_parse_cache_tests_" + std::to_string(::getpid()));
+    fs::remove_all(dir);
+    fs::create_directories(dir);
+    config = dir / "config";
+    std::ofstream(config) << "first";
+    ::unsetenv("CMDLINE_PARSE_CACHE_TEST");
+    p.error_messages = false;
+    p.add_option(verbose, "", 'v', "verbose");
+    p.add_option(number, "", 'n', "number");
+    p.add_option(name, "", 0, "name");
+    p.add_argument(file, "", "file", false);
+  }
+
+  void TearDown() override {
+    fs::remove_all(dir);
+  }
+
+  void reset() {
+    verbose = false;
+    number = 0;
+    name = {};
+    file.clear();
+  }
+
+  bool parse(cmdline::ParseCache &cache, std::initializer_list<const char *> args) {
+    reset();
+    std::vector<const char *> argv { "program_name" };
+    argv.insert(argv.end(), args);
+    return cache.parse_args(p, static_cast<int>(argv.size()), argv.data(), false);
+  }
+};
+
+std::size_t count_files(const fs::path &dir) {
+  std::size_t n = 0;
+  for ([[maybe_unused]] const auto &entry : fs::directory_iterator(dir)) {
+    ++n;
+  }
+  return n;
+}
+
+}
+
+TEST_F(ParseCacheTests, HitAfterMiss) {
+  cmdline::ParseCache cache((dir / "cache").string());
+  ASSERT_TRUE(parse(cache, { "-v", "-n", "5", "--name=x", "a" }));
+  EXPECT_FALSE(cache.hit());
+  EXPECT_EQ(count_files(dir / "cache"), 1);
+
+  ASSERT_TRUE(parse(cache, { "-v", "-n", "5", "--name=x", "a" }));
+  EXPECT_TRUE(cache.hit());
+  EXPECT_TRUE(verbose);
+  EXPECT_EQ(number, 5);
+  EXPECT_EQ(name, "x");
+  EXPECT_EQ(file, "a");
+
+  ASSERT_TRUE(parse(cache, { "-v", "-n", "6", "--name=x", "a" }));
+  EXPECT_FALSE(cache.hit());
+  EXPECT_EQ(number, 6);
+  EXPECT_EQ(count_files(dir / "cache"), 2);
+}
+
+TEST_F(ParseCacheTests, HitStartsAFreshParse) {
+  cmdline::ParseCache cache((dir / "cache").string());
+  ASSERT_TRUE(parse(cache, { "-n", "5", "a" }));
+  EXPECT_FALSE(parse(cache, { "-n", "x", "a" }));
+  EXPECT_EQ(p.diagnostic_count(), 1);
+  ASSERT_TRUE(parse(cache, { "-n", "5", "a" }));
+  EXPECT_TRUE(cache.hit());
+  EXPECT_EQ(p.diagnostic_count(), 0);
+  EXPECT_EQ(number, 5);
+}
+
+TEST_F(ParseCacheTests, Environment) {
+  cmdline::ParseCache cache((dir / "cache").string());
+  cache.add_environment("CMDLINE_PARSE_CACHE_TEST");
+  ASSERT_TRUE(parse(cache, { "-v" }));
+  ASSERT_TRUE(parse(cache, { "-v" }));
+  EXPECT_TRUE(cache.hit());
+
+  ::setenv("CMDLINE_PARSE_CACHE_TEST", "", 1);
+  ASSERT_TRUE(parse(cache, { "-v" }));
+  EXPECT_FALSE(cache.hit());
+  ::setenv("CMDLINE_PARSE_CACHE_TEST", "1", 1);
+  ASSERT_TRUE(parse(cache, { "-v" }));
+  EXPECT_FALSE(cache.hit());
+  ASSERT_TRUE(parse(cache, { "-v" }));
+  EXPECT_TRUE(cache.hit());
+  ::unsetenv("CMDLINE_PARSE_CACHE_TEST");
+}
+
+TEST_F(ParseCacheTests, Files) {
+  cmdline::ParseCache cache((dir / "cache").string());
+  cache.add_file(config.c_str());
+  cache.add_file((dir / "missing").c_str());
+  ASSERT_TRUE(parse(cache, { "-n", "1" }));
+  ASSERT_TRUE(parse(cache, { "-n", "1" }));
+  EXPECT_TRUE(cache.hit());
+
+  // Same size, so only the contents or the modification time tell
+  std::ofstream(config) << "other";
+  ASSERT_TRUE(parse(cache, { "-n", "1" }));
+  EXPECT_FALSE(cache.hit());
+  ASSERT_TRUE(parse(cache, { "-n", "1" }));
+  EXPECT_TRUE(cache.hit());
+
+  std::ofstream(dir / "missing") << "";
+  ASSERT_TRUE(parse(cache, { "-n", "1" }));
+  EXPECT_FALSE(cache.hit());
+}
+
+TEST_F(ParseCacheTests, FailedParseIsNotCached) {
+  cmdline::ParseCache cache((dir / "cache").string());
+  EXPECT_FALSE(parse(cache, { "-n", "x" }));
+  EXPECT_FALSE(parse(cache, { "-n", "x" }));
+  EXPECT_FALSE(cache.hit());
+  EXPECT_FALSE(fs::exists(dir / "cache"));
+}
+
+TEST_F(ParseCacheTests, DifferentParser) {
+  cmdline::ParseCache cache((dir / "cache").string());
+  ASSERT_TRUE(parse(cache, { "-n", "1" }));
+  cmdline::ArgumentParser other;
+  int n = 0;
+  other.add_option(n, "", 'n', "number");
+  const char *argv[] = { "program_name", "-n", "1" };
+  ASSERT_TRUE(cache.parse_args(other, size(argv), argv, false));
+  EXPECT_FALSE(cache.hit());
+  EXPECT_EQ(n, 1);
+}
+
+TEST_F(ParseCacheTests, CorruptFile) {
+  cmdline::ParseCache cache((dir / "cache").string());
+  ASSERT_TRUE(parse(cache, { "--name", "value", "file" }));
+  const fs::path file = fs::directory_iterator(dir / "cache")->path();
+  const auto full_size = fs::file_size(file);
+
+  for (const auto truncated : { full_size - 1, std::uintmax_t(10), std::uintmax_t(0) }) {
+    fs::resize_file(file, truncated);
+    ASSERT_TRUE(parse(cache, { "--name", "value", "file" }));
+    EXPECT_FALSE(cache.hit());
+    EXPECT_EQ(name, "value");
+    EXPECT_EQ(fs::file_size(file), full_size);
+  }
+}
@@ -0,0 +1,114 @@
+#include "gtest/gtest.h"
+#include "cmdline.h"
+
+template<typename T, std::size_t N>
+auto size(T (&)[N]) { return N; }
+
+using namespace std::chrono_literals;
+
+TEST(QuantityTests, Bytes) {
+  cmdline::Bytes b;
+  EXPECT_TRUE(cmdline::parse_value("512", b));
+  EXPECT_EQ(b.value, 512);
+  EXPECT_TRUE(cmdline::parse_value("4k", b));
+  EXPECT_EQ(b.value, 4000);
+  EXPECT_TRUE(cmdline::parse_value("4KB", b));
+  EXPECT_EQ(b.value, 4000);
+  EXPECT_TRUE(cmdline::parse_value("4GiB", b));
+  EXPECT_EQ(b.value, 4ull << 30);
+  EXPECT_TRUE(cmdline::parse_value("1.5MiB", b));
+  EXPECT_EQ(b.value, 1572864);
+  EXPECT_TRUE(cmdline::parse_value("15EiB", b));
+  EXPECT_EQ(b.value, 15ull << 60);
+
+  EXPECT_FALSE(cmdline::parse_value("16EiB", b));
+  EXPECT_FALSE(cmdline::parse_value("99999999999999999999", b));
+  EXPECT_FALSE(cmdline::parse_value("1.5B", b));
+  EXPECT_FALSE(cmdline::parse_value("-1k", b));
+  EXPECT_FALSE(cmdline::parse_value("4GiBs", b));
+  EXPECT_FALSE(cmdline::parse_value("GiB", b));
+  EXPECT_FALSE(cmdline::parse_value("", b));
+}
+
+TEST(QuantityTests, Count) {
+  cmdline::Count c;
+  EXPECT_TRUE(cmdline::parse_value("10k", c));
+  EXPECT_EQ(c.value, 10000);
+  EXPECT_TRUE(cmdline::parse_value("2.5M", c));
+  EXPECT_EQ(c.value, 2500000);
+  EXPECT_TRUE(cmdline::parse_value("1Ki", c));
+  EXPECT_EQ(c.value, 1024);
+  EXPECT_FALSE(cmdline::parse_value("10kB", c));
+  EXPECT_FALSE(cmdline::parse_value("0.5", c));
+}
+
+TEST(QuantityTests, Rate) {
+  cmdline::Rate r;
+  EXPECT_TRUE(cmdline::parse_value("10k/s", r));
+  EXPECT_DOUBLE_EQ(r.per_second, 10000.0);
+  EXPECT_TRUE(cmdline::parse_value("5/ms", r));
+  EXPECT_DOUBLE_EQ(r.per_second, 5000.0);
+  EXPECT_TRUE(cmdline::parse_value("3.6k/h", r));
+  EXPECT_DOUBLE_EQ(r.per_second, 1.0);
+  EXPECT_FALSE(cmdline::parse_value("10k", r));
+  EXPECT_FALSE(cmdline::parse_value("10k/", r));
+  EXPECT_FALSE(cmdline::parse_value("10k/year", r));
+}
+
+TEST(QuantityTests, Duration) {
+  std::chrono::milliseconds ms;
+  EXPECT_TRUE(cmdline::parse_value("250ms", ms));
+  EXPECT_EQ(ms, 250ms);
+  EXPECT_TRUE(cmdline::parse_value("1.5s", ms));
+  EXPECT_EQ(ms, 1500ms);
+  EXPECT_TRUE(cmdline::parse_value("2", ms));
+  EXPECT_EQ(ms, 2s);
+  EXPECT_TRUE(cmdline::parse_value("3min", ms));
+  EXPECT_EQ(ms, 3min);
+  EXPECT_TRUE(cmdline::parse_value("-1d", ms));
+  EXPECT_EQ(ms, -24h);
+  EXPECT_FALSE(cmdline::parse_value("1us", ms));
+  EXPECT_FALSE(cmdline::parse_value("1y", ms));
+
+  std::chrono::duration<std::int8_t> small;
+  EXPECT_TRUE(cmdline::parse_value("-128s", small));
+  EXPECT_EQ(small.count(), -128);
+  EXPECT_TRUE(cmdline::parse_value("2m", small));
+  EXPECT_EQ(small.count(), 120);
+  EXPECT_FALSE(cmdline::parse_value("128s", small));
+  EXPECT_FALSE(cmdline::parse_value("3m", small));
+
+  std::chrono::nanoseconds ns;
+  EXPECT_FALSE(cmdline::parse_value("1000000d", ns));
+
+  std::chrono::duration<double> seconds;
+  EXPECT_TRUE(cmdline::parse_value("1.25ms", seconds));
+  EXPECT_DOUBLE_EQ(seconds.count(), 0.00125);
+}
+
+TEST(QuantityTests, AddOption) {
+  cmdline::ArgumentParser p;
+  cmdline::Bytes cache;
+  std::chrono::milliseconds timeout {};
+  cmdline::Rate rate;
+  std::vector<cmdline::Count> counts;
+
+  p.add_option(cache, "", 0, "cache");
+  p.add_option(timeout, "", 't', "timeout");
+  p.add_option(rate, "", 0, "rate");
+  p.add_option(counts, "", 'n', "");
+
+  const char *argv[] = {"program_name", "--cache=4GiB", "-t", "250ms", "--rate=10k/s", "-n1k", "-n", "2M"};
+  const int argc = size(argv);
+
+  EXPECT_TRUE(p.parse_args(argc, argv, false));
+  EXPECT_EQ(cache.value, 4ull << 30);
+  EXPECT_EQ(timeout, 250ms);
+  EXPECT_DOUBLE_EQ(rate.per_second, 10000.0);
+  ASSERT_EQ(counts.size(), 2);
+  EXPECT_EQ(counts[0].value, 1000);
+  EXPECT_EQ(counts[1].value, 2000000);
+
+  const char *bad[] = {"program_name", "--cache=4QiB"};
+  EXPECT_FALSE(p.parse_args(size(bad), bad, false));
+}
@@ -0,0 +1,136 @@
+#include "gtest/gtest.h"
+#include "cmdline.h"
+
+template<typename T, std::size_t N>
+auto size(T (&)[N]) { return N; }
+
+namespace {
+
+struct Config {
+  bool verbose = false;
+  int threads = 1;
+  std::string_view name;
+  std::vector<std::string> include;
+  std::array<int, 2> size { 0, 0 };
+  std::string input;
+  std::vector<const char *> rest;
+};
+
+struct RecordParserTests : ::testing::Test {
+  cmdline::RecordParser<Config> p;
+
+  void SetUp() override {
+    p.error_messages = false;
+    ASSERT_TRUE(p.add_option(&Config::verbose, "", 'v', "verbose"));
+    ASSERT_TRUE(p.add_option(&Config::threads, "", 'j', "threads"));
+    ASSERT_TRUE(p.add_option(&Config::name, "", 0, "name"));
+    ASSERT_TRUE(p.add_option(&Config::include, "", 'I', "include"));
+    ASSERT_TRUE(p.add_option(&Config::size, "", 's', "size"));
+    ASSERT_TRUE(p.add_argument(&Config::input, "", "input"));
+    p.add_argument(&Config::rest, "rest");
+  }
+};
+
+}
+
+TEST_F(RecordParserTests, Parse) {
+  Config a, b;
+  const char *argv_a[] = { "program_name", "-v", "-j4", "--name=x", "-Ia", "-Ib", "-s", "1", "2", "in", "r" };
+  const char *argv_b[] = { "program_name", "--threads", "8", "other" };
+  ASSERT_TRUE(p.parse_args(a, size(argv_a), argv_a, false));
+  ASSERT_TRUE(p.parse_args(b, size(argv_b), argv_b, false));
+
+  EXPECT_TRUE(a.verbose);
+  EXPECT_EQ(a.threads, 4);
+  EXPECT_EQ(a.name, "x");
+  EXPECT_EQ(a.include, (std::vector<std::string> { "a", "b" }));
+  EXPECT_EQ(a.size, (std::array<int, 2> { 1, 2 }));
+  EXPECT_EQ(a.input, "in");
+  ASSERT_EQ(a.rest.size(), 1);
+  EXPECT_STREQ(a.rest[0], "r");
+
+  EXPECT_FALSE(b.verbose);
+  EXPECT_EQ(b.threads, 8);
+  EXPECT_TRUE(b.include.empty());
+  EXPECT_EQ(b.input, "other");
+  EXPECT_TRUE(b.rest.empty());
+}
+
+TEST_F(RecordParserTests, SharedVariable) {
+  bool dry_run = false;
+  ASSERT_TRUE(p.add_option(dry_run, "", 'n', "dry-run"));
+  EXPECT_FALSE(p.add_option(&Config::threads, "", 'n', ""));
+  Config c;
+  const char *argv[] = { "program_name", "-n", "-j2", "in" };
+  ASSERT_TRUE(p.parse_args(c, size(argv), argv, false));
+  EXPECT_TRUE(dry_run);
+  EXPECT_EQ(c.threads, 2);
+}
+
+TEST_F(RecordParserTests, Batch) {
+  std::vector<std::vector<const char *>> lines {
+    { "program_name", "-j", "2", "a" },
+    { "program_name", "-j", "x", "b" },
+    { "program_name", "c", "-v", "d", "e" },
+    { "program_name" },
+  };
+  std::vector<Config> records(1);
+  std::vector<std::size_t> failed;
+  EXPECT_EQ(p.parse_batch(lines, records, &failed), 2);
+  EXPECT_EQ(failed, (std::vector<std::size_t> { 1, 3 }));
+  ASSERT_EQ(records.size(), 5);
+  EXPECT_EQ(records[1].threads, 2);
+  EXPECT_EQ(records[1].input, "a");
+  EXPECT_EQ(records[2].threads, 1);
+  EXPECT_TRUE(records[2].input.empty());
+  EXPECT_TRUE(records[3].verbose);
+  EXPECT_EQ(records[3].rest.size(), 2);
+  EXPECT_EQ(p.selected(), nullptr);
+}
+
+TEST_F(RecordParserTests, NoRecordSelected) {
+  cmdline::Diagnostic diagnostics[4];
+  p.set_diagnostic_buffer(diagnostics, size(diagnostics));
+  const char *argv[] = { "program_name", "-v", "-j4", "in", "r" };
+  EXPECT_FALSE(p.parse_args(size(argv), argv, false));
+  ASSERT_GE(p.diagnostic_count(), 1);
+  EXPECT_EQ(diagnostics[0].code, cmdline::ErrorCode::option_invalid_argument);
+  std::vector<char> blob;
+  EXPECT_FALSE(p.save_result(blob));
+
+  Config c;
+  ASSERT_TRUE(p.parse_args(c, size(argv), argv, false));
+  ASSERT_TRUE(p.save_result(blob));
+  std::vector<std::vector<const char *>> lines { { "program_name", "in" } };
+  std::vector<Config> records;
+  EXPECT_EQ(p.parse_batch(lines, records), 1);
+  std::vector<std::string> args;
+  EXPECT_FALSE(p.canonical_args(args));
+  EXPECT_FALSE(p.load_result(blob.data(), blob.size()));
+  EXPECT_FALSE(p.parse_args(size(argv), argv, false));
+  char dump[1024];
+  EXPECT_LT(p.dump_config(dump, sizeof(dump), cmdline::DumpFormat::json), sizeof(dump));
+}
+
+TEST_F(RecordParserTests, SaveAndLoad) {
+  Config a;
+  const char *argv[] = { "program_name", "-v", "-j4", "-Ia", "-s", "1", "2", "in", "r" };
+  ASSERT_TRUE(p.parse_args(a, size(argv), argv, false));
+  std::vector<char> blob;
+  ASSERT_TRUE(p.save_result(blob));
+
+  Config b;
+  p.select(b);
+  ASSERT_TRUE(p.load_result(blob.data(), blob.size()));
+  EXPECT_TRUE(b.verbose);
+  EXPECT_EQ(b.threads, 4);
+  EXPECT_EQ(b.include, a.include);
+  EXPECT_EQ(b.size, a.size);
+  EXPECT_EQ(b.input, "in");
+  ASSERT_EQ(b.rest.size(), 1);
+  EXPECT_STREQ(b.rest[0], "r");
+
+  std::vector<std::string> args;
+  ASSERT_TRUE(p.canonical_args(args));
+  EXPECT_EQ(args, (std::vector<std::string> { "--verbose", "--threads=4", "--include=a", "--size", "1", "2", "in", "r" }));
+}
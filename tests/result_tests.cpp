@@ -0,0 +1,230 @@
+#include "gtest/gtest.h"
+#include "cmdline.h"
+
+template<typename T, std::size_t N>
+auto size(T (&)[N]) { return N; }
+
+namespace {
+
+struct Point {
+  int x = 0, y = 0;
+};
+
+std::istream & operator>>(std::istream &is, Point &p) {
+  char comma;
+  return is >> p.x >> comma >> p.y;
+}
+
+std::ostream & operator<<(std::ostream &os, const Point &p) {
+  return os << p.x << ',' << p.y;
+}
+
+struct Values {
+  bool verbose = false;
+  bool quiet = false;
+  int level = 0;
+  double ratio = 0.0;
+  std::string name;
+  std::string mode;
+  std::vector<int> numbers;
+  std::vector<std::string> tags;
+  std::array<double, 2> pair {};
+  cmdline::Bytes bytes;
+  cmdline::Rate rate;
+  std::chrono::milliseconds timeout {};
+  Point point;
+  std::string input;
+  int count = 0;
+  std::vector<const char *> rest;
+
+  void bind(cmdline::ArgumentParser &p) {
+    p.error_messages = false;
+    p.add_option(verbose, "", 'v', "verbose");
+    p.add_option(quiet, "", 'q', "");
+    p.add_option(level, "", 'l', "level");
+    p.add_option(ratio, "", 0, "ratio");
+    p.add_option(name, "", 'n', "name");
+    p.add_option(mode, "", 'm', "");
+    p.add_option(numbers, "", 'i', "int");
+    p.add_option(tags, "", 't', "tag");
+    p.add_option(pair, "", 'p', "pair");
+    p.add_option(bytes, "", 0, "size");
+    p.add_option(rate, "", 0, "rate");
+    p.add_option(timeout, "", 0, "timeout");
+    p.add_option(point, "", 0, "point");
+    p.add_argument(input, "", "input");
+    p.add_argument(count, "", "count", false);
+    p.add_argument(rest, "rest");
+  }
+
+  void expect_eq(const Values &other) const {
+    EXPECT_EQ(verbose, other.verbose);
+    EXPECT_EQ(quiet, other.quiet);
+    EXPECT_EQ(level, other.level);
+    EXPECT_EQ(ratio, other.ratio);
+    EXPECT_EQ(name, other.name);
+    EXPECT_EQ(mode, other.mode);
+    EXPECT_EQ(numbers, other.numbers);
+    EXPECT_EQ(tags, other.tags);
+    EXPECT_EQ(pair, other.pair);
+    EXPECT_EQ(bytes.value, other.bytes.value);
+    EXPECT_EQ(rate.per_second, other.rate.per_second);
+    EXPECT_EQ(timeout, other.timeout);
+    EXPECT_EQ(point.x, other.point.x);
+    EXPECT_EQ(point.y, other.point.y);
+    EXPECT_EQ(input, other.input);
+    EXPECT_EQ(count, other.count);
+    ASSERT_EQ(rest.size(), other.rest.size());
+    for (std::size_t i = 0; i < rest.size(); ++i) {
+      EXPECT_STREQ(rest[i], other.rest[i]);
+    }
+  }
+};
+
+const char *argv[] = {
+  "program_name", "-v", "-l-3", "--ratio=0.1", "--name", "", "-mfast", "-i1", "--int=-2",
+  "--tag=a", "-t", "", "--pair", "1.5", "2.25", "--size=4KiB", "--rate=2.5k/s", "--timeout=1.5s",
+  "--point=3,4", "in", "7", "--", "-x", "y",
+};
+
+}
+
+TEST(ResultTests, SaveAndLoad) {
+  cmdline::ArgumentParser p;
+  Values a;
+  a.bind(p);
+  ASSERT_TRUE(p.parse_args(size(argv), argv, false));
+  EXPECT_EQ(a.input, "in");
+  EXPECT_EQ(a.rest.size(), 2);
+
+  std::vector<char> blob;
+  ASSERT_TRUE(p.save_result(blob));
+  // Moved to a different address, as it would be in another process
+  std::vector<char> copy(blob);
+  blob.assign(blob.size(), '\0');
+
+  cmdline::ArgumentParser q;
+  Values b;
+  b.bind(q);
+  ASSERT_TRUE(q.load_result(copy.data(), copy.size()));
+  a.expect_eq(b);
+  EXPECT_GE(b.rest[0], copy.data());
+  EXPECT_LT(b.rest[0], copy.data() + copy.size());
+
+  std::vector<std::string> args_a, args_b;
+  ASSERT_TRUE(p.canonical_args(args_a));
+  ASSERT_TRUE(q.canonical_args(args_b));
+  EXPECT_EQ(args_a, args_b);
+}
+
+TEST(ResultTests, Rejects) {
+  cmdline::ArgumentParser p;
+  Values a;
+  a.bind(p);
+  ASSERT_TRUE(p.parse_args(size(argv), argv, false));
+  std::vector<char> blob;
+  ASSERT_TRUE(p.save_result(blob));
+
+  // Different options
+  cmdline::ArgumentParser q;
+  Values b;
+  b.bind(q);
+  int extra;
+  q.add_option(extra, "", 'x', "");
+  EXPECT_FALSE(q.load_result(blob.data(), blob.size()));
+
+  // Same names, different type
+  cmdline::ArgumentParser r;
+  long level;
+  r.error_messages = false;
+  r.add_option(level, "", 'l', "level");
+  cmdline::ArgumentParser s;
+  int level2;
+  s.add_option(level2, "", 'l', "level");
+  const char *args[] = { "program_name", "-l5" };
+  ASSERT_TRUE(s.parse_args(size(args), args, false));
+  ASSERT_TRUE(s.save_result(blob));
+  EXPECT_FALSE(r.load_result(blob.data(), blob.size()));
+  ASSERT_TRUE(s.load_result(blob.data(), blob.size()));
+
+  // Truncated or corrupted
+  for (std::size_t n = 0; n < blob.size(); ++n) {
+    EXPECT_FALSE(s.load_result(blob.data(), n)) << n;
+  }
+  for (std::size_t n = 0; n < blob.size(); ++n) {
+    std::vector<char> corrupt(blob);
+    corrupt[n] ^= 0x40;
+    s.load_result(corrupt.data(), corrupt.size());
+  }
+}
+
+TEST(ResultTests, RejectedLoadKeepsValues) {
+  cmdline::ArgumentParser p;
+  Values a;
+  a.bind(p);
+  ASSERT_TRUE(p.parse_args(size(argv), argv, false));
+  std::vector<char> blob;
+  ASSERT_TRUE(p.save_result(blob));
+
+  cmdline::ArgumentParser q;
+  Values b;
+  b.bind(q);
+  const char *args[] = { "program_name", "-l7", "--name=kept", "-i5", "out", "3", "--", "z" };
+  ASSERT_TRUE(q.parse_args(size(args), args, false));
+  const Values before = b;
+  for (std::size_t n = 0; n < blob.size(); ++n) {
+    std::vector<char> corrupt(blob);
+    corrupt[n] ^= 0x40;
+    if (q.load_result(corrupt.data(), corrupt.size())) {
+      b = before;
+      continue;
+    }
+    b.expect_eq(before);
+  }
+  for (std::size_t n = 0; n < blob.size(); ++n) {
+    EXPECT_FALSE(q.load_result(blob.data(), n));
+    b.expect_eq(before);
+  }
+
+  // Loading replaces the values of the catch-all argument
+  ASSERT_TRUE(q.load_result(blob.data(), blob.size()));
+  ASSERT_TRUE(q.load_result(blob.data(), blob.size()));
+  a.expect_eq(b);
+}
+
+TEST(ResultTests, CanonicalArgs) {
+  cmdline::ArgumentParser p;
+  Values a;
+  a.bind(p);
+  ASSERT_TRUE(p.parse_args(size(argv), argv, false));
+  std::vector<std::string> args;
+  ASSERT_TRUE(p.canonical_args(args));
+  const std::vector<std::string> expected {
+    "--verbose", "--level=-3", "--ratio=0.1", "--name", "", "-mfast", "--int=1", "--int=-2",
+    "--tag=a", "--tag", "", "--pair", "1.5", "2.25", "--size=4096", "--rate=2500/s", "--timeout=1500ms",
+    "--point=3,4", "in", "7", "--", "-x", "y",
+  };
+  EXPECT_EQ(args, expected);
+
+  // Parsing the canonical form gives the same values
+  std::vector<const char *> canonical { "program_name" };
+  for (const std::string &arg : args) {
+    canonical.push_back(arg.c_str());
+  }
+  cmdline::ArgumentParser q;
+  Values b;
+  b.bind(q);
+  ASSERT_TRUE(q.parse_args(canonical.size(), canonical.data(), false));
+  a.expect_eq(b);
+}
+
+TEST(ResultTests, CanonicalArgsUnrepresentable) {
+  cmdline::ArgumentParser p;
+  std::array<int, 2> pair;
+  p.add_option(pair, "", 'p', "");
+  const char *args[] = { "program_name", "-p", "1", "2" };
+  ASSERT_TRUE(p.parse_args(size(args), args, false));
+  pair[1] = -2;
+  std::vector<std::string> canonical;
+  EXPECT_FALSE(p.canonical_args(canonical));
+}
@@ -0,0 +1,146 @@
+#include "gtest/gtest.h"
+#include "cmdline.h"
+
+#include <random>
+
+template<typename T, std::size_t N>
+auto size(T (&)[N]) { return N; }
+
+namespace {
+
+struct Counted {
+  int value;
+};
+
+std::size_t g_conversions = 0;
+
+bool parse_value(const char *str, Counted &c) {
+  ++g_conversions;
+  char *end;
+  c.value = static_cast<int>(std::strtol(str, &end, 10));
+  return *str and !*end;
+}
+
+struct SessionTests : ::testing::Test {
+  cmdline::ArgumentParser p;
+  bool a = false, b = false, c = false;
+  int number = 0;
+  std::vector<Counted> counted;
+  std::vector<std::string> names;
+  std::array<int, 2> pair;
+  int first = 0;
+  std::string second;
+
+  void SetUp() override {
+    p.error_messages = false;
+    p.add_option(a, "", 'a', "alpha");
+    p.add_option(b, "", 'b', "");
+    p.add_option(c, "", 'c', "");
+    p.add_option(number, "", 'n', "number");
+    p.add_option(counted, "", 'k', "counted");
+    p.add_option(names, "", 's', "name");
+    p.add_option(pair, "", 'p', "pair");
+    p.add_argument(first, "", "first");
+    p.add_argument(second, "", "second", false);
+    p.add_exclusive_group({ "alpha", "-b" });
+  }
+};
+
+}
+
+TEST_F(SessionTests, Basic) {
+  cmdline::ParseSession s(p, "program_name");
+  EXPECT_FALSE(s.valid());
+  ASSERT_EQ(s.diagnostics().size(), 1);
+  EXPECT_EQ(s.diagnostics()[0].code, cmdline::ErrorCode::argument_required);
+
+  s.edit(0, 0, { "-n", "5", "7" });
+  EXPECT_TRUE(s.valid());
+  EXPECT_EQ(number, 0);
+  EXPECT_TRUE(s.apply());
+  EXPECT_EQ(number, 5);
+  EXPECT_EQ(first, 7);
+
+  // `-n' loses its value to the new token
+  s.edit(1, 1, { "x" });
+  ASSERT_EQ(s.diagnostics().size(), 1);
+  EXPECT_EQ(s.diagnostics()[0].code, cmdline::ErrorCode::option_invalid_argument);
+  EXPECT_EQ(s.diagnostics()[0].argv_index, 2);
+
+  s.edit(1, 1, { "6", "-a", "-b" });
+  ASSERT_EQ(s.diagnostics().size(), 1);
+  EXPECT_EQ(s.diagnostics()[0].code, cmdline::ErrorCode::constraint_violated);
+  s.edit(3, 1, {});
+  EXPECT_TRUE(s.valid());
+  EXPECT_EQ(s.size(), 4);
+  EXPECT_STREQ(s.argv()[4], "7");
+}
+
+TEST_F(SessionTests, ReusesConversions) {
+  cmdline::ParseSession s(p, "program_name");
+  std::vector<std::string> tokens;
+  for (int i = 0; i < 200; ++i) {
+    tokens.push_back("--counted=" + std::to_string(i));
+  }
+  tokens.push_back("1");
+  std::vector<const char *> argv;
+  for (const std::string &t : tokens) {
+    argv.push_back(t.c_str());
+  }
+  g_conversions = 0;
+  s.assign(argv.size(), argv.data());
+  EXPECT_EQ(g_conversions, 200);
+  EXPECT_TRUE(s.valid());
+
+  g_conversions = 0;
+  s.edit(100, 1, { "--counted=x" });
+  EXPECT_EQ(g_conversions, 1);
+  EXPECT_LE(s.reparsed(), 3);
+  EXPECT_FALSE(s.valid());
+
+  g_conversions = 0;
+  s.edit(100, 1, { "-k", "100" });
+  EXPECT_EQ(g_conversions, 1);
+  EXPECT_TRUE(s.valid());
+}
+
+TEST_F(SessionTests, MatchesFullParse) {
+  static const char *const pool[] = {
+    "-a", "-b", "-abc", "-c", "-n", "5", "-n7", "--number=3", "--number", "x", "-k", "9", "--counted=2",
+    "-s", "foo", "--name=bar", "-p", "1", "2", "--pair", "3", "--", "--zzz", "-q", "42", "text", "",
+  };
+  std::mt19937 rng(7);
+  std::vector<std::string> tokens;
+  cmdline::ParseSession incremental(p, "program_name");
+  for (int step = 0; step < 2000; ++step) {
+    const std::size_t first = rng() % (tokens.size() + 1);
+    const std::size_t count = std::min<std::size_t>(rng() % 3, tokens.size() - first);
+    std::vector<const char *> replacement;
+    for (std::size_t n = rng() % 3; n > 0; --n) {
+      replacement.push_back(pool[rng() % size(pool)]);
+    }
+    tokens.erase(tokens.begin() + first, tokens.begin() + first + count);
+    tokens.insert(tokens.begin() + first, replacement.begin(), replacement.end());
+    incremental.edit(first, count, replacement.data(), replacement.size());
+
+    std::vector<const char *> argv;
+    for (const std::string &t : tokens) {
+      argv.push_back(t.c_str());
+    }
+    cmdline::ParseSession full(p, "program_name");
+    full.assign(argv.size(), argv.data());
+    ASSERT_EQ(incremental.diagnostics(), full.diagnostics()) << "step " << step;
+
+    cmdline::Diagnostic d;
+    p.set_diagnostic_buffer(&d, 1);
+    counted.clear();
+    names.clear();
+    argv.insert(argv.begin(), "program_name");
+    const bool ok = p.parse_args(argv.size(), argv.data(), false);
+    ASSERT_EQ(ok, full.valid()) << "step " << step;
+    if (!ok) {
+      ASSERT_EQ(d, full.diagnostics()[0]) << "step " << step;
+    }
+    p.set_diagnostic_buffer(nullptr, 0);
+  }
+}
@@ -0,0 +1,7 @@
+# Options of the spec image tests, see `cmdline::parse_spec_schema'
+#short long      nargs argument  help
+-      color     1     WHEN      "Colorize output"
+x      extract   0     -         "Extract files"
+-      exclude   1     -         "Skip files matching PATTERN"
+j      jobs      1     N         "Parallel jobs"
+-      size      2     -         'Width and height'
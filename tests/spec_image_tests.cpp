@@ -0,0 +1,183 @@
+#include "gtest/gtest.h"
+#include "cmdline.h"
+
+template<typename T, std::size_t N>
+auto size(T (&)[N]) { return N; }
+
+namespace {
+
+const char *const SCHEMA = R"(
+# comment
+-  color    1  WHEN  "Colorize output"
+x  extract  0  -     "Extract files"
+-  exclude  1  -     'Skip files matching PATTERN'
+j  jobs     1  N     "Parallel jobs"
+-  size     2  -     "Width and height"
+)";
+
+struct SpecImageTests : ::testing::Test {
+  std::vector<char> buffer;
+  cmdline::SpecImage image;
+
+  void SetUp() override {
+    std::vector<cmdline::SpecSchemaOption> options;
+    std::size_t line;
+    ASSERT_TRUE(cmdline::parse_spec_schema(SCHEMA, options, line));
+    ASSERT_TRUE(cmdline::build_spec_image(options, buffer));
+    ASSERT_TRUE(image.load(buffer.data(), buffer.size()));
+  }
+};
+
+}
+
+TEST_F(SpecImageTests, Lookup) {
+  ASSERT_EQ(image.option_count(), 5);
+  const cmdline::SpecImage::Option color = image.option(0);
+  EXPECT_EQ(color.short_name, 0);
+  EXPECT_EQ(color.long_name, "color");
+  EXPECT_EQ(color.argument_name, "WHEN");
+  EXPECT_EQ(color.help, "Colorize output");
+  EXPECT_EQ(color.nargs, 1);
+  EXPECT_EQ(image.option(2).argument_name, "EXCLUDE");
+  EXPECT_EQ(image.option(1).argument_name, "");
+
+  EXPECT_EQ(image.find("jobs"), 3);
+  EXPECT_EQ(image.find("job"), cmdline::SpecImage::npos);
+  EXPECT_EQ(image.find('x'), 1);
+  EXPECT_EQ(image.find('y'), cmdline::SpecImage::npos);
+
+  bool ambiguous;
+  EXPECT_EQ(image.find_prefix("col", ambiguous), 0);
+  EXPECT_EQ(image.find_prefix("ex", ambiguous), cmdline::SpecImage::npos);
+  EXPECT_TRUE(ambiguous);
+  EXPECT_EQ(image.find_prefix("exc", ambiguous), 2);
+  EXPECT_EQ(image.find_prefix("size", ambiguous), 4);
+  EXPECT_EQ(image.find_prefix("z", ambiguous), cmdline::SpecImage::npos);
+  EXPECT_FALSE(ambiguous);
+
+  EXPECT_NE(image.usage().find("  -j, --jobs  N         Parallel jobs\n"), std::string_view::npos);
+}
+
+TEST_F(SpecImageTests, Parse) {
+  cmdline::ArgumentParser p;
+  p.error_messages = false;
+  bool verbose = false;
+  int jobs = 0;
+  std::vector<std::string> excludes;
+  std::string file;
+  p.add_option(verbose, "", 'v', "verbose");
+  p.add_argument(file, "", "file");
+  p.use_spec(&image);
+  EXPECT_TRUE(p.bind("jobs", jobs));
+  EXPECT_TRUE(p.bind("exclude", excludes));
+  EXPECT_FALSE(p.bind("extract", jobs));
+  EXPECT_FALSE(p.bind("missing", jobs));
+
+  const char *argv[] = {
+    "program_name", "-vx", "--color=auto", "-j4", "--exclude", "a", "--exclude=b", "--size", "3", "4", "f",
+  };
+  ASSERT_TRUE(p.parse_args(size(argv), argv, false));
+  EXPECT_TRUE(verbose);
+  EXPECT_EQ(jobs, 4);
+  EXPECT_EQ(excludes, (std::vector<std::string> { "a", "b" }));
+  EXPECT_EQ(file, "f");
+
+  std::vector<const char *> values;
+  EXPECT_EQ(p.spec_values("extract", values), 1);
+  EXPECT_TRUE(values.empty());
+  EXPECT_EQ(p.spec_values("size", values), 1);
+  ASSERT_EQ(values.size(), 2);
+  EXPECT_STREQ(values[0], "3");
+  EXPECT_STREQ(values[1], "4");
+  values.clear();
+  EXPECT_EQ(p.spec_values("color", values), 1);
+  EXPECT_STREQ(values[0], "auto");
+  EXPECT_EQ(p.spec_values("jobs", values), 1);
+
+  cmdline::Diagnostic d;
+  char message[128];
+  p.set_diagnostic_buffer(&d, 1);
+  const char *bad_value[] = { "program_name", "--jobs=many", "f" };
+  EXPECT_FALSE(p.parse_args(size(bad_value), bad_value, false));
+  EXPECT_EQ(d.code, cmdline::ErrorCode::option_invalid_argument);
+  p.format_diagnostic(d, bad_value, message, sizeof(message));
+  EXPECT_STREQ(message, "program_name: invalid argument `many' for option `--jobs'");
+
+  const char *missing[] = { "program_name", "f", "--size", "1" };
+  EXPECT_FALSE(p.parse_args(size(missing), missing, false));
+  p.format_diagnostic(d, missing, message, sizeof(message));
+  EXPECT_STREQ(message, "program_name: option `--size' requires 2 arguments");
+
+  const char *unknown[] = { "program_name", "f", "--colour" };
+  EXPECT_FALSE(p.parse_args(size(unknown), unknown, false));
+  EXPECT_EQ(d.code, cmdline::ErrorCode::unrecognized_option);
+}
+
+TEST_F(SpecImageTests, Abbreviations) {
+  cmdline::ArgumentParser p;
+  p.error_messages = false;
+  p.abbreviations = true;
+  bool exclusive = false;
+  p.add_option(exclusive, "", 0, "exclusive");
+  p.use_spec(&image);
+
+  const char *exact[] = { "program_name", "--extract" };
+  EXPECT_TRUE(p.parse_args(size(exact), exact, false));
+  EXPECT_FALSE(exclusive);
+
+  // `exclusive' from the parser and `exclude' from the image
+  const char *ambiguous[] = { "program_name", "--exclu" };
+  EXPECT_FALSE(p.parse_args(size(ambiguous), ambiguous, false));
+
+  const char *own[] = { "program_name", "--exclus" };
+  EXPECT_TRUE(p.parse_args(size(own), own, false));
+  EXPECT_TRUE(exclusive);
+
+  const char *image_option[] = { "program_name", "--col", "never" };
+  EXPECT_TRUE(p.parse_args(size(image_option), image_option, false));
+  std::vector<const char *> values;
+  EXPECT_EQ(p.spec_values("color", values), 1);
+}
+
+TEST_F(SpecImageTests, Rejects) {
+  std::vector<cmdline::SpecSchemaOption> options;
+  std::size_t line = 0;
+  EXPECT_FALSE(cmdline::parse_spec_schema("x a 0 - ok\n\nxy b 0 - bad\n", options, line));
+  EXPECT_EQ(line, 3);
+  options.clear();
+  EXPECT_FALSE(cmdline::parse_spec_schema("- - 0 - \"no name\"\n", options, line));
+  options.clear();
+  EXPECT_FALSE(cmdline::parse_spec_schema("a b 1x - help\n", options, line));
+  options.clear();
+  EXPECT_FALSE(cmdline::parse_spec_schema("a b 1 - \"unterminated\n", options, line));
+  options.clear();
+  EXPECT_FALSE(cmdline::parse_spec_schema("a b 1 -\n", options, line));
+
+  options.clear();
+  ASSERT_TRUE(cmdline::parse_spec_schema("a b 0 - x\na c 0 - y\n", options, line));
+  std::vector<char> image;
+  EXPECT_FALSE(cmdline::build_spec_image(options, image));
+
+  cmdline::SpecImage bad;
+  for (std::size_t n = 0; n < buffer.size(); n += 4) {
+    EXPECT_FALSE(bad.load(buffer.data(), n));
+  }
+  std::vector<char> corrupt(buffer);
+  corrupt[0] = 'X';
+  EXPECT_FALSE(bad.load(corrupt.data(), corrupt.size()));
+  // A sorted entry past the options
+  corrupt = buffer;
+  const cmdline::detail::SpecImageHeader &header = *reinterpret_cast<const cmdline::detail::SpecImageHeader *>(buffer.data());
+  const std::uint32_t out_of_range = header.option_count;
+  std::memcpy(corrupt.data() + header.sorted, &out_of_range, sizeof(out_of_range));
+  EXPECT_FALSE(bad.load(corrupt.data(), corrupt.size()));
+  EXPECT_FALSE(bad.map("/nonexistent"));
+}
+
+TEST(SpecImageFileTests, Map) {
+  cmdline::SpecImage image;
+  ASSERT_TRUE(image.map(CMDLINE_TEST_SPEC_IMAGE));
+  EXPECT_EQ(image.option_count(), 5);
+  EXPECT_EQ(image.find("exclude"), 2);
+  EXPECT_EQ(image.option(image.find('j')).argument_name, "N");
+}
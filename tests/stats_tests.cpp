@@ -0,0 +1,55 @@
+#include "gtest/gtest.h"
+#include "cmdline.h"
+
+template<typename T, std::size_t N>
+auto size(T (&)[N]) { return N; }
+
+namespace {
+
+std::string write_stats(const cmdline::ArgumentParser &p, cmdline::StatsFormat format) {
+  char *data = nullptr;
+  std::size_t length = 0;
+  FILE *f = open_memstream(&data, &length);
+  p.write_stats(f, format);
+  std::fclose(f);
+  std::string s(data, length);
+  std::free(data);
+  return s;
+}
+
+}
+
+TEST(StatsTests, Counters) {
+  cmdline::ArgumentParser p;
+  p.error_messages = false;
+  p.stats().trace = true;
+  std::vector<int> numbers;
+  bool flag = false;
+  std::string name;
+  p.add_option(numbers, "", 'n', "number");
+  p.add_option(flag, "", 'f', "");
+  p.add_argument(name, "", "name");
+
+  const char *argv[] = {"program_name", "-n", "1", "--number=2", "-f", "x", "-nz"};
+  EXPECT_FALSE(p.parse_args(size(argv), argv, false));
+
+  const cmdline::ParseStats &s = p.stats();
+#ifdef CMDLINE_INSTRUMENTATION
+  ASSERT_EQ(s.option_hits.size(), 3);
+  EXPECT_EQ(s.option_hits[1], 3);
+  EXPECT_EQ(s.option_conversion_failures[1], 1);
+  EXPECT_EQ(s.option_hits[2], 1);
+  EXPECT_EQ(s.argument_hits[0], 1);
+  EXPECT_EQ(s.phase_calls[static_cast<std::size_t>(cmdline::Phase::tokenization)], 1);
+  EXPECT_EQ(s.phase_calls[static_cast<std::size_t>(cmdline::Phase::conversion)], 5);
+  EXPECT_FALSE(s.events.empty());
+#else
+  EXPECT_TRUE(s.option_hits.empty());
+  EXPECT_TRUE(s.events.empty());
+#endif
+
+  const std::string json = write_stats(p, cmdline::StatsFormat::json);
+  EXPECT_EQ(json.rfind("{\"phases\":{\"tokenization\":{", 0), 0);
+  const std::string trace = write_stats(p, cmdline::StatsFormat::chrome_trace);
+  EXPECT_EQ(trace.rfind("{\"traceEvents\":[", 0), 0);
+}
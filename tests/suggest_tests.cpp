@@ -0,0 +1,85 @@
+#include "gtest/gtest.h"
+#include "cmdline.h"
+
+#include <random>
+
+namespace {
+
+std::size_t naive_distance(std::string_view a, std::string_view b) {
+  std::vector<std::size_t> row(b.size() + 1);
+  for (std::size_t j = 0; j <= b.size(); ++j) {
+    row[j] = j;
+  }
+  for (std::size_t i = 1; i <= a.size(); ++i) {
+    std::size_t diag = row[0];
+    row[0] = i;
+    for (std::size_t j = 1; j <= b.size(); ++j) {
+      const std::size_t up = row[j];
+      row[j] = std::min({ up + 1, row[j - 1] + 1, diag + (a[i - 1] != b[j - 1]) });
+      diag = up;
+    }
+  }
+  return row[b.size()];
+}
+
+}
+
+TEST(SuggestTests, EditDistance) {
+  using cmdline::detail::EditDistancePattern;
+  EXPECT_EQ(EditDistancePattern("kitten").distance("sitting", 10), 3);
+  EXPECT_EQ(EditDistancePattern("verbose").distance("verbose", 10), 0);
+  EXPECT_EQ(EditDistancePattern("verbose").distance("vebrose", 10), 2);
+  EXPECT_EQ(EditDistancePattern("").distance("abc", 10), 3);
+  EXPECT_GT(EditDistancePattern("abc").distance("xyzxyz", 2), 2);
+
+  std::mt19937 rng(42);
+  auto random_string = [&](std::size_t max_length) {
+    std::string s(rng() % (max_length + 1), ' ');
+    for (char &ch : s) {
+      ch = "abcd"[rng() % 4];
+    }
+    return s;
+  };
+  for (int i = 0; i < 2000; ++i) {
+    const std::string a = random_string(i < 1000 ? 12 : 70);
+    const std::string b = random_string(i < 1000 ? 12 : 70);
+    const std::size_t expected = naive_distance(a, b);
+    const EditDistancePattern pattern(a);
+    ASSERT_EQ(pattern.distance(b, 100), expected) << a << " / " << b;
+    const std::size_t bounded = pattern.distance(b, 3);
+    if (expected <= 3) {
+      ASSERT_EQ(bounded, expected) << a << " / " << b;
+    }
+    else {
+      ASSERT_GT(bounded, 3) << a << " / " << b;
+    }
+  }
+}
+
+TEST(SuggestTests, Suggest) {
+  cmdline::ArgumentParser p;
+  bool b;
+  p.add_option(b, "", 0, "verbose");
+  p.add_option(b, "", 0, "version");
+  p.add_option(b, "", 0, "recursive");
+  p.add_option(b, "", 0, "color");
+  p.add_option(b, "", 0, "colour");
+  p.add_option(b, "", 'x', "");
+
+  auto s = p.suggest("verbsoe");
+  ASSERT_FALSE(s.empty());
+  EXPECT_EQ(s[0], "verbose");
+
+  s = p.suggest("colou");
+  ASSERT_EQ(s.size(), 2);
+  EXPECT_EQ(s[0], "color");
+  EXPECT_EQ(s[1], "colour");
+
+  EXPECT_TRUE(p.suggest("completely-different").empty());
+
+  p.add_option(b, "", 0, "hepl");
+  s = p.suggest("hepl");
+  ASSERT_EQ(s.size(), 2);
+  EXPECT_EQ(s[0], "hepl");
+  EXPECT_EQ(s[1], "help");
+}
@@ -0,0 +1,78 @@
+#include "gtest/gtest.h"
+#include "cmdline.h"
+
+template<typename T, std::size_t N>
+auto size(T (&)[N]) { return N; }
+
+namespace {
+
+std::vector<std::string> split(const char *command) {
+  std::string buffer = command;
+  const char *tokens[16];
+  const cmdline::TokenizeResult r = cmdline::tokenize(buffer.data(), tokens, size(tokens));
+  EXPECT_TRUE(r);
+  EXPECT_EQ(tokens[r.count], nullptr);
+  return std::vector<std::string>(tokens, tokens + r.count);
+}
+
+}
+
+TEST(TokenizeTests, Words) {
+  using V = std::vector<std::string>;
+  EXPECT_EQ(split(""), V {});
+  EXPECT_EQ(split(" \t\n "), V {});
+  EXPECT_EQ(split("a"), V { "a" });
+  EXPECT_EQ(split("  ls -l\t--color=auto \n"), (V { "ls", "-l", "--color=auto" }));
+  EXPECT_EQ(split("a\\ b c\\\\d"), (V { "a b", "c\\d" }));
+  EXPECT_EQ(split("a\\\nb"), V { "ab" });
+  EXPECT_EQ(split("'a b' 'it'\\''s' '' x'$y'z"), (V { "a b", "it's", "", "x$yz" }));
+  EXPECT_EQ(split("'\\n\"'"), V { "\\n\"" });
+  EXPECT_EQ(split("\"a b\" \"\\$x \\` \\\" \\\\ \\n\" \"a\\\nb\""), (V { "a b", "$x ` \" \\ \\n", "ab" }));
+  EXPECT_EQ(split("a\"b c\"'d e'f"), V { "ab cd ef" });
+}
+
+TEST(TokenizeTests, Errors) {
+  const char *tokens[3];
+  auto check = [&](const char *command, cmdline::TokenizeStatus status, std::size_t offset) {
+    std::string buffer = command;
+    const cmdline::TokenizeResult r = cmdline::tokenize(buffer.data(), tokens, size(tokens));
+    EXPECT_EQ(r.status, status) << command;
+    EXPECT_EQ(r.offset, offset) << command;
+  };
+  check("a 'b c", cmdline::TokenizeStatus::unterminated_single_quote, 2);
+  check("a \"b\\\" c", cmdline::TokenizeStatus::unterminated_double_quote, 2);
+  check("a b\\", cmdline::TokenizeStatus::trailing_backslash, 3);
+  check("a b c", cmdline::TokenizeStatus::too_many_tokens, 4);
+  check("a b ", cmdline::TokenizeStatus::ok, 0);
+}
+
+TEST(TokenizeTests, ParseCommandLine) {
+  cmdline::ArgumentParser p;
+  p.error_messages = false;
+  cmdline::Diagnostic d;
+  p.set_diagnostic_buffer(&d, 1);
+  std::string name;
+  std::vector<const char *> files;
+  bool verbose = false;
+  p.add_option(name, "", 'n', "name");
+  p.add_option(verbose, "", 'v', "");
+  p.add_argument(files, "files");
+
+  const char *arena[8];
+  char command[] = "-v --name='it'\\''s' a\\ b \"c d\"";
+  EXPECT_TRUE(p.parse_command_line("program_name", command, arena, size(arena), false));
+  EXPECT_TRUE(verbose);
+  EXPECT_EQ(name, "it's");
+  ASSERT_EQ(files.size(), 2);
+  EXPECT_STREQ(files[0], "a b");
+  EXPECT_STREQ(files[1], "c d");
+
+  char bad[] = "-v 'x";
+  EXPECT_FALSE(p.parse_command_line("program_name", bad, arena, size(arena), false));
+  ASSERT_EQ(p.diagnostic_count(), 1);
+  EXPECT_EQ(d.code, cmdline::ErrorCode::invalid_command_line);
+  EXPECT_EQ(d.offset, 3);
+  char buffer[128];
+  p.format_diagnostic(d, arena, buffer, sizeof(buffer));
+  EXPECT_STREQ(buffer, "program_name: unterminated single quote at offset 3 of the command line");
+}
@@ -0,0 +1,164 @@
+#include "gtest/gtest.h"
+#include "cmdline.h"
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <filesystem>
+#include <fstream>
+
+template<typename T, std::size_t N>
+auto size(T (&)[N]) { return N; }
+
+namespace fs = std::filesystem;
+
+namespace {
+
+struct UsageTests : ::testing::Test {
+  fs::path dir;
+  cmdline::ArgumentParser p;
+  bool verbose = false;
+  int number = 0;
+  std::vector<std::string> names;
+
+  void SetUp() override {
+    dir = fs::temp_directory_path() / ("cmdline_usage_tests_" + std::to_string(::getpid()));
+    fs::remove_all(dir);
+    p.error_messages = false;
+    p.add_option(verbose, "", 'v', "verbose");
+    p.add_option(number, "", 'n', "number");
+    p.add_option(names, "", 's', "");
+  }
+
+  void TearDown() override {
+    fs::remove_all(dir);
+  }
+
+  bool parse(std::initializer_list<const char *> args) {
+    names.clear();
+    std::vector<const char *> argv { "program_name" };
+    argv.insert(argv.end(), args);
+    return p.parse_args(static_cast<int>(argv.size()), argv.data(), false);
+  }
+
+  std::uint64_t count(const cmdline::UsageReport &report, const char *name) {
+    for (const cmdline::OptionUsage &option : report.options) {
+      if (option.name == name) {
+        return option.count;
+      }
+    }
+    ADD_FAILURE() << "no option " << name;
+    return 0;
+  }
+};
+
+}
+
+TEST_F(UsageTests, CountsParsesUsingEachOption) {
+  cmdline::UsageCounters counters;
+  ASSERT_TRUE(counters.open(dir.c_str(), p));
+  p.set_usage_counters(&counters);
+  EXPECT_TRUE(parse({ "-v", "-s", "a", "-s", "b" }));
+  EXPECT_TRUE(parse({ "--number=3", "-sc" }));
+  EXPECT_TRUE(parse({}));
+  EXPECT_FALSE(parse({ "-v", "--number=x" }));
+
+  cmdline::UsageReport report;
+  ASSERT_TRUE(cmdline::read_usage(counters.path().c_str(), report));
+  EXPECT_EQ(report.parses, 4u);
+  ASSERT_EQ(report.options.size(), 4u);
+  EXPECT_EQ(count(report, "--help"), 0u);
+  EXPECT_EQ(count(report, "--verbose"), 2u);
+  EXPECT_EQ(count(report, "--number"), 2u);
+  EXPECT_EQ(count(report, "-s"), 2u);
+}
+
+TEST_F(UsageTests, CountsCacheHits) {
+  cmdline::UsageCounters counters;
+  ASSERT_TRUE(counters.open(dir.c_str(), p));
+  p.set_usage_counters(&counters);
+  cmdline::ParseCache cache((dir / "cache").string());
+  const char *args[] = { "program_name", "-v", "-s", "a" };
+  ASSERT_TRUE(cache.parse_args(p, size(args), args, false));
+  EXPECT_FALSE(cache.hit());
+  ASSERT_TRUE(cache.parse_args(p, size(args), args, false));
+  EXPECT_TRUE(cache.hit());
+
+  cmdline::UsageReport report;
+  ASSERT_TRUE(cmdline::read_usage(counters.path().c_str(), report));
+  EXPECT_EQ(report.parses, 2u);
+  EXPECT_EQ(count(report, "--verbose"), 2u);
+  EXPECT_EQ(count(report, "--number"), 0u);
+  EXPECT_EQ(count(report, "-s"), 2u);
+}
+
+TEST_F(UsageTests, SharedBetweenProcesses) {
+  cmdline::UsageCounters counters;
+  ASSERT_TRUE(counters.open(dir.c_str(), p));
+  p.set_usage_counters(&counters);
+  const pid_t child = ::fork();
+  ASSERT_GE(child, 0);
+  if (child == 0) {
+    cmdline::UsageCounters own;
+    p.set_usage_counters(own.open(dir.c_str(), p) ? &own : nullptr);
+    for (int i = 0; i < 100; ++i) {
+      parse({ "-v" });
+    }
+    ::_exit(0);
+  }
+  for (int i = 0; i < 100; ++i) {
+    parse({ "-v" });
+  }
+  int status;
+  ASSERT_EQ(::waitpid(child, &status, 0), child);
+
+  cmdline::UsageReport report;
+  ASSERT_TRUE(cmdline::read_usage(counters.path().c_str(), report));
+  EXPECT_EQ(report.parses, 200u);
+  EXPECT_EQ(count(report, "--verbose"), 200u);
+}
+
+TEST_F(UsageTests, KeyedByOptions) {
+  cmdline::UsageCounters counters;
+  ASSERT_TRUE(counters.open(dir.c_str(), p));
+  cmdline::ArgumentParser other;
+  bool quiet = false;
+  other.add_option(quiet, "", 'q', "quiet");
+  cmdline::UsageCounters other_counters;
+  ASSERT_TRUE(other_counters.open(dir.c_str(), other));
+  EXPECT_NE(counters.path(), other_counters.path());
+  cmdline::UsageReport report;
+  ASSERT_TRUE(cmdline::read_usage(other_counters.path().c_str(), report));
+  EXPECT_EQ(report.options.size(), 2u);
+  EXPECT_EQ(count(report, "--quiet"), 0u);
+}
+
+TEST_F(UsageTests, OptionsAddedLaterAreNotCounted) {
+  cmdline::UsageCounters counters;
+  ASSERT_TRUE(counters.open(dir.c_str(), p));
+  p.set_usage_counters(&counters);
+  bool late = false;
+  p.add_option(late, "", 'l', "late");
+  EXPECT_TRUE(parse({ "-l", "-v" }));
+  cmdline::UsageReport report;
+  ASSERT_TRUE(cmdline::read_usage(counters.path().c_str(), report));
+  EXPECT_EQ(report.options.size(), 4u);
+  EXPECT_EQ(count(report, "--verbose"), 1u);
+}
+
+TEST_F(UsageTests, RejectsMalformedFiles) {
+  fs::create_directories(dir);
+  const fs::path path = dir / "bad";
+  std::ofstream(path) << "not a usage file, but long enough to hold a header";
+  cmdline::UsageReport report;
+  EXPECT_FALSE(cmdline::read_usage(path.c_str(), report));
+  EXPECT_FALSE(cmdline::read_usage((dir / "missing").c_str(), report));
+
+  cmdline::UsageCounters counters;
+  ASSERT_TRUE(counters.open(dir.c_str(), p));
+  const std::string path_of_p = counters.path();
+  counters.close();
+  fs::resize_file(path_of_p, fs::file_size(path_of_p) - 1);
+  EXPECT_FALSE(counters.open(dir.c_str(), p));
+  EXPECT_FALSE(cmdline::read_usage(path_of_p.c_str(), report));
+}
@@ -0,0 +1,130 @@
+#include "gtest/gtest.h"
+#include "cmdline.h"
+
+#include <filesystem>
+#include <fstream>
+
+template<typename T, std::size_t N>
+auto size(T (&)[N]) { return N; }
+
+namespace fs = std::filesystem;
+
+struct ValidatorTests : public ::testing::Test {
+  fs::path dir;
+  std::string file;
+
+  void SetUp() override {
+    dir = fs::temp_directory_path() / ("cmdline_validator_tests_" + std::to_string(::getpid()));
+    fs::create_directories(dir);
+    file = (dir / "file").string();
+    std::ofstream(file) << "x";
+  }
+
+  void TearDown() override {
+    fs::remove_all(dir);
+  }
+};
+
+TEST_F(ValidatorTests, Builtin) {
+  cmdline::ArgumentParser p;
+  p.error_messages = false;
+  std::string input, output;
+  p.add_option(input, "", 'i', "input");
+  p.add_argument(output, "", "output");
+  EXPECT_TRUE(p.add_validator("input", cmdline::validators::readable()));
+  EXPECT_TRUE(p.add_validator("output", cmdline::validators::is_directory()));
+  EXPECT_FALSE(p.add_validator("missing", cmdline::validators::exists()));
+  EXPECT_FALSE(p.add_validator('x', cmdline::validators::exists()));
+
+  const std::string d = dir.string();
+  const std::string missing = (dir / "missing").string();
+  {
+    const char *argv[] = {"program_name", "-i", file.c_str(), d.c_str()};
+    EXPECT_TRUE(p.parse_args(size(argv), argv, false));
+  }
+  {
+    const char *argv[] = {"program_name", "-i", missing.c_str(), d.c_str()};
+    EXPECT_FALSE(p.parse_args(size(argv), argv, false));
+  }
+  {
+    const char *argv[] = {"program_name", "--input", file.c_str(), file.c_str()};
+    EXPECT_FALSE(p.parse_args(size(argv), argv, false));
+  }
+}
+
+TEST_F(ValidatorTests, Custom) {
+  cmdline::ArgumentParser p;
+  p.error_messages = false;
+  std::vector<int> values;
+  p.add_option(values, "", 'n', "");
+  p.add_validator('n', cmdline::validators::custom(
+    [](const char *s) { return s[0] != '0'; }, "leading zero"));
+
+  const char *good[] = {"program_name", "-n", "1", "-n10"};
+  EXPECT_TRUE(p.parse_args(size(good), good, false));
+  const char *bad[] = {"program_name", "-n", "1", "-n01"};
+  EXPECT_FALSE(p.parse_args(size(bad), bad, false));
+}
+
+TEST_F(ValidatorTests, Parallel) {
+  constexpr int N = 2000;
+  std::vector<std::string> paths;
+  for (int i = 0; i < N; ++i) {
+    paths.push_back((i % 2) ? file : dir.string());
+  }
+  paths[N / 2] = (dir / "missing").string();
+
+  std::vector<const char *> argv { "program_name" };
+  for (const std::string &s : paths) {
+    argv.push_back(s.c_str());
+  }
+
+  std::vector<const char *> unhandled;
+  cmdline::ArgumentParser p;
+  p.error_messages = false;
+  p.validation_threads = 4;
+  std::string first;
+  p.add_argument(first, "", "first");
+  p.add_validator("first", cmdline::validators::exists());
+  p.add_argument(unhandled);
+  EXPECT_TRUE(p.parse_args(2, argv.data(), false));
+
+  std::vector<std::string> all;
+  cmdline::ArgumentParser q;
+  q.error_messages = false;
+  q.validation_threads = 4;
+  q.add_option(all, "", 'p', "");
+  q.add_validator('p', cmdline::validators::exists());
+  std::vector<const char *> args { "program_name" };
+  for (const std::string &s : paths) {
+    args.push_back("-p");
+    args.push_back(s.c_str());
+  }
+  EXPECT_FALSE(q.parse_args(static_cast<int>(args.size()), args.data(), false));
+  EXPECT_EQ(all.size(), N);
+}
+
+TEST_F(ValidatorTests, ParallelRethrows) {
+  std::vector<std::string> values(500, "ok");
+  values[300] = "throw";
+  std::vector<const char *> args { "program_name" };
+  for (const std::string &s : values) {
+    args.push_back("-v");
+    args.push_back(s.c_str());
+  }
+  for (unsigned threads : { 1u, 4u }) {
+    cmdline::ArgumentParser p;
+    p.error_messages = false;
+    p.validation_threads = threads;
+    std::vector<std::string> all;
+    p.add_option(all, "", 'v', "");
+    p.add_validator('v', cmdline::validators::custom(
+      [](const char *s) {
+        if (std::string_view(s) == "throw") {
+          throw std::runtime_error("validator failed");
+        }
+        return true;
+      }, "", true));
+    EXPECT_THROW(p.parse_args(static_cast<int>(args.size()), args.data(), false), std::runtime_error) << threads;
+  }
+}
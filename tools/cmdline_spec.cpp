@@ -0,0 +1,57 @@
+/*
+ * Compiles an option schema into a spec image for `cmdline::SpecImage', see
+ * `cmdline::parse_spec_schema' for the schema format and
+ * cmake/CmdlineSpec.cmake for running it as part of a build.
+ */
+#include "cmdline.h"
+
+#include <cstdio>
+
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+int main(int argc, const char **argv) {
+  cmdline::ArgumentParser p;
+  std::string schema_path;
+  std::string output_path;
+  p.add_argument(schema_path, "Option schema", "schema");
+  p.add_argument(output_path, "Spec image to write", "output");
+  p.parse_args(argc, argv);
+
+  std::ifstream in(schema_path, std::ios::binary);
+  if (!in) {
+    std::fprintf(stderr, "%s: cannot read `%s'\n", argv[0], schema_path.c_str());
+    return 1;
+  }
+  const std::string schema { std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>() };
+
+  std::vector<cmdline::SpecSchemaOption> options;
+  std::size_t line = 0;
+  if (!cmdline::parse_spec_schema(schema, options, line)) {
+    std::fprintf(stderr, "%s:%zu: malformed option\n", schema_path.c_str(), line);
+    return 1;
+  }
+  std::vector<char> image;
+  if (!cmdline::build_spec_image(options, image)) {
+    std::fprintf(stderr, "%s: duplicate option name\n", schema_path.c_str());
+    return 1;
+  }
+
+  // Written next to the output and renamed, so a running program never maps
+  // a partial image
+  const std::string temporary = output_path + ".tmp";
+  std::FILE *out = std::fopen(temporary.c_str(), "wb");
+  if (out == nullptr) {
+    std::fprintf(stderr, "%s: cannot write `%s'\n", argv[0], temporary.c_str());
+    return 1;
+  }
+  const bool written = std::fwrite(image.data(), 1, image.size(), out) == image.size();
+  if (std::fclose(out) != 0 or !written or std::rename(temporary.c_str(), output_path.c_str()) != 0) {
+    std::fprintf(stderr, "%s: cannot write `%s'\n", argv[0], output_path.c_str());
+    std::remove(temporary.c_str());
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,57 @@
+/*
+ * Prints how often each option was used, from the counter files written
+ * through `cmdline::UsageCounters'. Counts for the same option name are
+ * summed over all files, so the files of several versions of a program can
+ * be read together.
+ */
+#include "cmdline.h"
+
+#include <cinttypes>
+#include <cstdio>
+
+#include <algorithm>
+#include <map>
+#include <string>
+#include <vector>
+
+int main(int argc, const char **argv) {
+  cmdline::ArgumentParser p;
+  bool unused_only = false;
+  std::vector<const char *> paths;
+  p.add_option(unused_only, "Only list options no parse used", 'u', "unused");
+  p.add_argument(paths, "Usage counter files");
+  p.parse_args(argc, argv);
+
+  std::uint64_t parses = 0;
+  std::map<std::string, std::uint64_t> counts;
+  for (const char *path : paths) {
+    cmdline::UsageReport report;
+    if (!cmdline::read_usage(path, report)) {
+      std::fprintf(stderr, "%s: cannot read `%s'\n", argv[0], path);
+      return 1;
+    }
+    parses += report.parses;
+    for (const cmdline::OptionUsage &option : report.options) {
+      counts[option.name] += option.count;
+    }
+  }
+
+  std::vector<std::pair<std::string, std::uint64_t>> sorted(counts.begin(), counts.end());
+  std::stable_sort(sorted.begin(), sorted.end(), [](const auto &a, const auto &b) {
+    return a.second > b.second;
+  });
+  if (unused_only) {
+    for (const auto &[name, count] : sorted) {
+      if (count == 0) {
+        std::printf("%s\n", name.c_str());
+      }
+    }
+    return 0;
+  }
+  std::printf("%" PRIu64 " parses\n", parses);
+  for (const auto &[name, count] : sorted) {
+    const double percent = parses == 0 ? 0.0 : 100.0 * static_cast<double>(count) / static_cast<double>(parses);
+    std::printf("%12" PRIu64 " %6.2f%%  %s\n", count, percent, name.c_str());
+  }
+  return 0;
+}